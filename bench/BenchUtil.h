@@ -0,0 +1,153 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <vector>
+#include "Token.h"
+
+namespace bench {
+
+// Best-of-N wall time in seconds; the minimum filters out scheduler noise.
+inline double bestOf(int runs, const std::function<void()>& body) {
+    double best = 1e300;
+    for (int i = 0; i < runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+// Synthetic FLAST source of roughly `targetBytes` bytes: the same function
+// repeated with a numbered name, each with a block and a line comment,
+// typed parameters, var and let declarations, a while loop over mixed
+// arithmetic, string, underscored and scientific literals, and an `if` on
+// a compound condition. It is for the lexer and parser only; some of it
+// does not lower (see generateProgram).
+inline std::string generateSource(size_t targetBytes) {
+    std::string out;
+    out.reserve(targetBytes + 1024);
+    for (size_t n = 0; out.size() < targetBytes; n++) {
+        std::string id = std::to_string(n);
+        out += "/* Computes a running total for case " + id + ".\n"
+               "   The loop below is intentionally simple. */\n";
+        out += "func compute_value_" + id + "(count: int32, scale: float64) -> int32 {\n";
+        out += "    // accumulate with a bounded loop\n";
+        out += "    var total: int32 = 0;\n";
+        out += "    var index: int32 = 0;\n";
+        out += "    while (index < count) {\n";
+        out += "        total = total + index * 3 - (index / 2) % 7;\n";
+        out += "        index = index + 1;\n";
+        out += "    }\n";
+        out += "    let message = \"total for case " + id + " is ready\";\n";
+        out += "    let big = 1_000_000;\n";
+        out += "    let ratio = 2.5e-3;\n";
+        out += "    println(message);\n";
+        out += "    if (total >= big && scale != 0.0) {\n";
+        out += "        return total;\n";
+        out += "    }\n";
+        out += "    return total + compute_value_" + id + "(count - 1, scale);\n";
+        out += "}\n\n";
+    }
+    return out;
+}
+
+// Synthetic program of roughly `targetBytes` bytes that the parser and code
+// generator accept end to end (generateSource also exercises lexer-only
+// syntax). Each function calls the previous one so every name resolves.
+inline std::string generateProgram(size_t targetBytes) {
+    std::string out;
+    out.reserve(targetBytes + 1024);
+    out += "func compute_value_0(count: i32, scale: f64) -> i32 {\n    return count;\n}\n\n";
+    for (size_t n = 1; out.size() < targetBytes; n++) {
+        std::string id = std::to_string(n);
+        std::string prev = std::to_string(n - 1);
+        out += "// Computes a running total for case " + id + ".\n";
+        out += "func compute_value_" + id + "(count: i32, scale: f64) -> i32 {\n";
+        out += "    let total: i32 = 0;\n";
+        out += "    let index: i32 = 0;\n";
+        out += "    while index < count {\n";
+        out += "        total = total + index * 3 - (index / 2) % 7;\n";
+        out += "        index = index + 1;\n";
+        out += "    }\n";
+        out += "    let message: string = \"total for case " + id + " is ready\";\n";
+        out += "    println(message, scale, 2.5e-3);\n";
+        out += "    for let j: i32 in 4 {\n";
+        out += "        total = total + compute_value_" + prev + "(j, scale);\n";
+        out += "    }\n";
+        out += "    return total;\n";
+        out += "}\n\n";
+    }
+    return out;
+}
+
+// Balanced binary expression of the given depth over `a`, `b` and small
+// literals; the operators rotate so no level folds to a constant.
+inline std::string generateExpression(int depth, size_t& leaf) {
+    static const char* const ops[] = {" + ", " * ", " - ", " / "};
+    if (depth == 0) {
+        size_t n = leaf++;
+        if (n % 3 == 2) return std::to_string(n % 9 + 1);
+        return n % 3 == 0 ? "a" : "b";
+    }
+    std::string lhs = generateExpression(depth - 1, leaf);
+    std::string rhs = generateExpression(depth - 1, leaf);
+    return "(" + lhs + ops[depth % 4] + rhs + ")";
+}
+
+// `functions` functions, each returning one expression tree of `depth` levels.
+inline std::string generateExpressionProgram(size_t functions, int depth) {
+    std::string out;
+    for (size_t n = 0; n < functions; n++) {
+        size_t leaf = n;
+        out += "func deep_expr_" + std::to_string(n) + "(a: i32, b: i32) -> i32 {\n";
+        out += "    let value: i32 = " + generateExpression(depth, leaf) + ";\n";
+        out += "    return value;\n";
+        out += "}\n\n";
+    }
+    return out;
+}
+
+// Expression-heavy program of roughly `targetBytes` bytes: each function
+// returns a depth-8 tree, so most tokens are operators and operands.
+inline std::string generateExpressionSource(size_t targetBytes) {
+    std::string out;
+    out.reserve(targetBytes + 4096);
+    for (size_t n = 0; out.size() < targetBytes; n += 64) {
+        out += generateExpressionProgram(64, 8);
+    }
+    return out;
+}
+
+// One function whose body is a single flat chain of `terms` operands. By
+// default the operators cycle through every binary precedence level, the
+// shape generated code tends to produce; `op` repeats one operator instead
+// (" ** " gives a right-associative chain).
+inline std::string generateOperatorChain(size_t terms, const char* op = nullptr) {
+    static const char* const ops[] = {" + ", " * ", " - ", " ** ", " / ", " << ", " & ",
+                                      " ^ ", " % ", " >> ", " == ", " < "};
+    std::string out = "func operator_chain(a: i32, b: i32) -> i32 {\n    let value: i32 = a";
+    out.reserve(terms * 6 + 128);
+    for (size_t i = 1; i < terms; i++) {
+        out += op ? op : ops[i % (sizeof(ops) / sizeof(ops[0]))];
+        out += (i & 1) ? "b" : "a";
+    }
+    out += ";\n    return value;\n}\n";
+    return out;
+}
+
+// Token streams are equal when type, text and position all match.
+inline bool sameTokens(const std::vector<Token>& a, const std::vector<Token>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].type != b[i].type || a[i].value != b[i].value ||
+            a[i].line != b[i].line || a[i].column != b[i].column) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace bench
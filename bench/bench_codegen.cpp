@@ -0,0 +1,94 @@
+// Code generation throughput on deep expression trees, in AST nodes/sec.
+//
+//   bench_codegen [--functions N] [--depth D] [--runs N]
+//
+// Each of N functions returns one balanced binary expression of depth D, so
+// nearly all of the work is expression dispatch and IR building. The
+// generator's console chatter is discarded while timing.
+
+#include "BenchUtil.h"
+#include "ASTContext.h"
+#include "CodeGen.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SourceBuffer.h"
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+static size_t countNodes(const ASTNode* node) {
+    if (!node) return 0;
+    size_t count = 1;
+    switch (node->kind) {
+        case NodeKind::Program:
+            for (auto* decl : static_cast<const ProgramAST*>(node)->declarations) count += countNodes(decl);
+            break;
+        case NodeKind::FunctionDecl:
+            count += countNodes(static_cast<const FunctionDeclAST*>(node)->body);
+            break;
+        case NodeKind::BlockStmt:
+            for (auto* stmt : static_cast<const BlockStmtAST*>(node)->statements) count += countNodes(stmt);
+            break;
+        case NodeKind::VarDeclStmt:
+            count += countNodes(static_cast<const VarDeclStmtAST*>(node)->initializer);
+            break;
+        case NodeKind::ReturnStmt:
+            count += countNodes(static_cast<const ReturnStmtAST*>(node)->value);
+            break;
+        case NodeKind::BinaryExpr: {
+            auto* binary = static_cast<const BinaryExprAST*>(node);
+            count += countNodes(binary->left) + countNodes(binary->right);
+            break;
+        }
+        default:
+            break;
+    }
+    return count;
+}
+
+int main(int argc, char* argv[]) {
+    size_t functions = 2000;
+    int depth = 8;
+    int runs = 3;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--functions" && i + 1 < argc) {
+            functions = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--depth" && i + 1 < argc) {
+            depth = std::atoi(argv[++i]);
+        } else if (arg == "--runs" && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        }
+    }
+
+    auto source = SourceBuffer::fromString(bench::generateExpressionProgram(functions, depth), "<synthetic>");
+    Lexer lexer(*source);
+    ASTContext context;
+    Parser parser(lexer.tokenize(), context, source->getName());
+    ProgramAST* program = parser.parseProgram();
+    size_t nodes = countNodes(program);
+
+    // generateCode sets up a .build directory next to the source file
+    auto workDir = std::filesystem::temp_directory_path() / "flast_bench_codegen";
+    std::filesystem::create_directories(workDir);
+    std::string sourcePath = (workDir / "bench.fls").string();
+
+    std::ostringstream discard;
+    std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+    double seconds = bench::bestOf(runs, [&] {
+        CodeGenerator codegen;
+        codegen.generateCode(program, sourcePath);
+        discard.str(std::string());
+    });
+    std::cout.rdbuf(console);
+    std::filesystem::remove_all(workDir);
+
+    std::cout << "Codegen: " << functions << " functions, depth " << depth << ", "
+              << nodes << " AST nodes (best of " << runs << ")\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  generate time  " << seconds * 1000 << " ms\n";
+    std::cout << "  throughput     " << nodes / seconds / 1e6 << " M nodes/sec\n";
+    return program->declarations.size() == functions ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+// Cost of fetching source lines for diagnostics.
+//
+//   bench_diagnostics [--mb N] [--errors N] [--runs N]
+//
+// Compares the old per-diagnostic walk from the top of the file with the
+// SourceManager's line-offset table (build time included) for N lookups
+// spread across a synthetic file. Both must return the same text.
+
+#include "BenchUtil.h"
+#include "SourceManager.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+// Previous Lexer::getCurrentLineContent strategy
+static std::string_view lineByScanning(std::string_view input, int line) {
+    size_t lineStart = 0;
+    for (int currentLine = 1; currentLine < line; currentLine++) {
+        size_t newline = input.find('\n', lineStart);
+        if (newline == std::string_view::npos) return std::string_view();
+        lineStart = newline + 1;
+    }
+    size_t lineEnd = input.find('\n', lineStart);
+    if (lineEnd == std::string_view::npos) lineEnd = input.size();
+    return input.substr(lineStart, lineEnd - lineStart);
+}
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = 8;
+    int errors = 2000;
+    int runs = 3;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--mb" && i + 1 < argc) {
+            megabytes = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--errors" && i + 1 < argc) {
+            errors = std::atoi(argv[++i]);
+        } else if (arg == "--runs" && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        }
+    }
+
+    SourceManager manager;
+    FileId file = manager.addBuffer(
+        SourceBuffer::fromString(bench::generateSource(megabytes << 20), "<synthetic>"));
+    std::string_view text = manager.getBuffer(file).text();
+    int lineCount = static_cast<int>(manager.getLineCount(file));
+
+    std::vector<int> lines;
+    for (int i = 0; i < errors; i++) {
+        lines.push_back(1 + static_cast<int>((static_cast<long long>(i) * 7919) % lineCount));
+    }
+
+    size_t checksum = 0;
+    double scanning = bench::bestOf(runs, [&] {
+        for (int line : lines) checksum += lineByScanning(text, line).size();
+    });
+    double indexed = bench::bestOf(runs, [&] {
+        SourceManager fresh;
+        FileId id = fresh.addBuffer(SourceBuffer::fromString(std::string(text), "<copy>"));
+        for (int line : lines) checksum += fresh.getLineText(id, line).size();
+    });
+
+    bool same = true;
+    for (int line : lines) {
+        if (lineByScanning(text, line) != manager.getLineText(file, line)) {
+            same = false;
+            break;
+        }
+    }
+
+    std::cout << "Diagnostic line lookup: " << megabytes << " MB, " << lineCount << " lines, "
+              << errors << " diagnostics (best of " << runs << ")\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  scan from start  " << std::setw(10) << scanning * 1000 << " ms\n";
+    std::cout << "  line table       " << std::setw(10) << indexed * 1000 << " ms  ("
+              << std::setprecision(1) << scanning / indexed << "x)\n";
+    std::cout << "  results " << (same ? "match" : "DIFFER") << " (checksum " << checksum << ")\n";
+    return same ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+// Small scripts end to end: `flast run --interp` against the JIT and an
+// executable.
+//
+//   bench_interp [--runs N]
+//
+// Each script returns a checksum as its exit status and prints nothing.
+// For each this reports, from source on disk:
+//   interp start  lex, parse and compile to bytecode (main's first instruction)
+//   interp        the same, then interpret main to completion
+//   jit           lower the program, compile it in memory and run it
+//   aot warm      build with the partition cache populated, link and exec
+// All three must agree on the exit status.
+
+#include "BenchUtil.h"
+#include "ASTContext.h"
+#include "Bytecode.h"
+#include "CodeGen.h"
+#include "Interpreter.h"
+#include "JIT.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SourceBuffer.h"
+#include <sys/wait.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+struct Script {
+    const char* name;
+    const char* source;
+};
+
+static const Script scripts[] = {
+    {"trivial",
+     "func main() -> i32 {\n"
+     "    return 42;\n"
+     "}\n"},
+    {"fib 20",
+     "func fib(n: i32) -> i32 {\n"
+     "    while n < 2 {\n"
+     "        return n;\n"
+     "    }\n"
+     "    return fib(n - 1) + fib(n - 2);\n"
+     "}\n"
+     "\n"
+     "func main() -> i32 {\n"
+     "    return fib(20) % 256;\n"
+     "}\n"},
+    {"loop 100k",
+     "func main() -> i32 {\n"
+     "    let total: i32 = 0;\n"
+     "    for let k: i32 = 0; k < 100000; k = k + 1 {\n"
+     "        total = total + k * 3 % 7;\n"
+     "    }\n"
+     "    return total % 256;\n"
+     "}\n"},
+    {"collatz",
+     "func steps(n: i32) -> i32 {\n"
+     "    let count: i32 = 0;\n"
+     "    while n != 1 {\n"
+     "        let half: i32 = n / 2;\n"
+     "        while half * 2 == n {\n"
+     "            n = half;\n"
+     "            half = n / 2;\n"
+     "            count = count + 1;\n"
+     "        }\n"
+     "        while n != 1 && half * 2 != n {\n"
+     "            n = 3 * n + 1;\n"
+     "            half = n / 2;\n"
+     "            count = count + 1;\n"
+     "        }\n"
+     "    }\n"
+     "    return count;\n"
+     "}\n"
+     "\n"
+     "func main() -> i32 {\n"
+     "    let longest: i32 = 0;\n"
+     "    for let i: i32 in 2000 {\n"
+     "        longest = longest + steps(i + 1);\n"
+     "    }\n"
+     "    return longest % 256;\n"
+     "}\n"},
+};
+
+static ProgramAST* parse(const std::string& sourcePath, ASTContext& context) {
+    static std::vector<std::unique_ptr<SourceBuffer>> sources;  // tokens borrow from these
+    sources.push_back(SourceBuffer::fromFile(sourcePath));
+    Lexer lexer(*sources.back());
+    Parser parser(lexer.tokenize(), context, sourcePath);
+    return parser.parseProgram();
+}
+
+static int buildAndExec(const std::string& sourcePath, const CodeGenerator::BuildOptions& options) {
+    ASTContext context;
+    ProgramAST* program = parse(sourcePath, context);
+    CodeGenerator codegen;
+    codegen.setBuildOptions(options);
+    codegen.generateCodeIncremental(program, sourcePath);
+    std::string exePath = codegen.writeExecutable(sourcePath, false, options.optimized());
+    int status = std::system(("\"" + exePath + "\"").c_str());
+    return WEXITSTATUS(status);
+}
+
+static int compileAndRun(const std::string& sourcePath, const CodeGenerator::BuildOptions& options) {
+    ASTContext context;
+    ProgramAST* program = parse(sourcePath, context);
+    JITSession session(options, false);
+    CodeGenerator codegen;
+    codegen.setBuildOptions(options);
+    codegen.setJITMode(true);
+    codegen.generateCode(program, sourcePath);
+    session.addModule(codegen.takeModule());
+    return session.runMain(sourcePath, {});
+}
+
+static int interpret(const std::string& sourcePath, bool run) {
+    ASTContext context;
+    bytecode::Program program = bytecode::compile(parse(sourcePath, context));
+    return run ? Interpreter(program).runMain() & 0xff : 0;
+}
+
+int main(int argc, char* argv[]) {
+    int runs = 10;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        }
+    }
+
+    auto workDir = std::filesystem::temp_directory_path() / "flast_bench_interp";
+    std::filesystem::remove_all(workDir);
+    std::filesystem::create_directories(workDir);
+
+    CodeGenerator::BuildOptions options;
+    options.debugMode = false;
+    options.targetCPU = "native";
+    CodeGenerator::resolveTarget(options.targetCPU, options.targetFeatures);
+
+    std::cout << "Small scripts end to end (best of " << runs << ", us)\n";
+    std::cout << std::left << std::setw(14) << "script" << std::setw(15) << "interp start" << std::setw(12)
+              << "interp" << std::setw(12) << "jit" << std::setw(12) << "aot warm" << "\n";
+    std::cout << std::fixed << std::setprecision(0);
+
+    bool same = true;
+    for (const Script& script : scripts) {
+        std::string sourcePath = (workDir / "script.fls").string();
+        std::ofstream(sourcePath) << script.source;
+        std::filesystem::remove_all(workDir / ".build");
+
+        std::ostringstream discard;
+        std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+        int interpreted = 0, jitted = 0, built = 0;
+        double startTime = bench::bestOf(runs, [&] { interpret(sourcePath, false); });
+        double interpTime = bench::bestOf(runs, [&] { interpreted = interpret(sourcePath, true); });
+        double jitTime = bench::bestOf(runs, [&] { jitted = compileAndRun(sourcePath, options) & 0xff; });
+        built = buildAndExec(sourcePath, options);
+        double aotTime = bench::bestOf(runs, [&] { built = buildAndExec(sourcePath, options); });
+        std::cout.rdbuf(console);
+        same = same && interpreted == jitted && interpreted == built;
+
+        std::cout << std::setw(14) << script.name << std::setw(15) << startTime * 1e6 << std::setw(12)
+                  << interpTime * 1e6 << std::setw(12) << jitTime * 1e6 << std::setw(12) << aotTime * 1e6 << "\n";
+    }
+
+    std::filesystem::remove_all(workDir);
+    std::cout << "  exit status " << (same ? "identical on every path" : "MISMATCH") << "\n";
+    return same ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+// Time to first instruction: `flast run` against building an executable.
+//
+//   bench_jit [--runs N] [--functions 10,300]
+//
+// Each script has one main that calls a few of its functions and returns
+// at once, so the time until main returns is the time until its first
+// instruction. For each script size and level this reports:
+//   aot cold   lower every partition, write objects, link, exec
+//   aot warm   same with the partition cache populated (link and exec only)
+//   jit        lower the whole program and compile it in memory
+//   jit lazy   the same, compiling only the functions main reaches
+// All four must agree on main's exit status.
+
+#include "BenchUtil.h"
+#include "ASTContext.h"
+#include "CodeGen.h"
+#include "JIT.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SourceBuffer.h"
+#include <sys/wait.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// `functions` small functions with loops and arithmetic; main calls three
+static std::string generateScript(size_t functions) {
+    std::string out;
+    for (size_t n = 0; n < functions; n++) {
+        std::string id = std::to_string(n);
+        out += "func f" + id + "(x: i32) -> i32 {\n";
+        out += "    let y: i32 = x * " + std::to_string(n % 17 + 3) + ";\n";
+        out += "    while y > 1000 {\n";
+        out += "        y = y / 2 + " + id + " % 5;\n";
+        out += "    }\n";
+        out += "    return y + " + id + ";\n";
+        out += "}\n\n";
+    }
+    out += "func main() -> i32 {\n";
+    out += "    return (f0(7) + f" + std::to_string(functions / 2) + "(11) + f" +
+           std::to_string(functions - 1) + "(13)) % 100;\n";
+    out += "}\n";
+    return out;
+}
+
+static ProgramAST* parse(const std::string& sourcePath, ASTContext& context) {
+    static std::vector<std::unique_ptr<SourceBuffer>> sources;  // tokens borrow from these
+    sources.push_back(SourceBuffer::fromFile(sourcePath));
+    Lexer lexer(*sources.back());
+    Parser parser(lexer.tokenize(), context, sourcePath);
+    return parser.parseProgram();
+}
+
+static int buildAndExec(const std::string& sourcePath, const CodeGenerator::BuildOptions& options) {
+    ASTContext context;
+    ProgramAST* program = parse(sourcePath, context);
+    CodeGenerator codegen;
+    codegen.setBuildOptions(options);
+    codegen.generateCodeIncremental(program, sourcePath);
+    std::string exePath = codegen.writeExecutable(sourcePath, false, options.optimized());
+    int status = std::system(("\"" + exePath + "\"").c_str());
+    return WEXITSTATUS(status);
+}
+
+static int compileAndRun(const std::string& sourcePath, const CodeGenerator::BuildOptions& options, bool lazy) {
+    ASTContext context;
+    ProgramAST* program = parse(sourcePath, context);
+    JITSession session(options, lazy);
+    CodeGenerator codegen;
+    codegen.setBuildOptions(options);
+    codegen.setJITMode(true);
+    codegen.generateCode(program, sourcePath);
+    session.addModule(codegen.takeModule());
+    return session.runMain(sourcePath, {});
+}
+
+int main(int argc, char* argv[]) {
+    int runs = 5;
+    std::vector<size_t> sizes = {10, 300};
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        } else if (arg == "--functions" && i + 1 < argc) {
+            sizes.clear();
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ',')) sizes.push_back(std::stoul(item));
+        }
+    }
+
+    auto workDir = std::filesystem::temp_directory_path() / "flast_bench_jit";
+    std::filesystem::remove_all(workDir);
+    std::filesystem::create_directories(workDir);
+
+    std::cout << "Time to first instruction (best of " << runs << ", ms)\n";
+    std::cout << std::left << std::setw(18) << "script" << std::setw(12) << "aot cold" << std::setw(12)
+              << "aot warm" << std::setw(12) << "jit" << std::setw(12) << "jit lazy" << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+
+    bool same = true;
+    for (size_t functions : sizes) {
+        for (auto level : {CodeGenerator::OptLevel::O0, CodeGenerator::OptLevel::O2}) {
+            std::string name = "f" + std::to_string(functions) + "_" + CodeGenerator::optLevelName(level);
+            std::string sourcePath = (workDir / (name + ".fls")).string();
+            std::ofstream(sourcePath) << generateScript(functions);
+
+            CodeGenerator::BuildOptions options;
+            options.debugMode = false;
+            options.optLevel = level;
+            options.targetCPU = "native";
+            CodeGenerator::resolveTarget(options.targetCPU, options.targetFeatures);
+
+            std::ostringstream discard;
+            std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+            int cold = 0, warm = 0, eager = 0, lazy = 0;
+            double coldTime = bench::bestOf(runs, [&] {
+                std::filesystem::remove_all(workDir / ".build");
+                cold = buildAndExec(sourcePath, options);
+            });
+            double warmTime = bench::bestOf(runs, [&] { warm = buildAndExec(sourcePath, options); });
+            double eagerTime = bench::bestOf(runs, [&] { eager = compileAndRun(sourcePath, options, false); });
+            double lazyTime = bench::bestOf(runs, [&] { lazy = compileAndRun(sourcePath, options, true); });
+            std::cout.rdbuf(console);
+            same = same && cold == warm && cold == eager && cold == lazy;
+
+            std::cout << std::setw(18) << name << std::setw(12) << coldTime * 1000 << std::setw(12)
+                      << warmTime * 1000 << std::setw(12) << eagerTime * 1000 << std::setw(12)
+                      << lazyTime * 1000 << "\n";
+        }
+    }
+
+    std::filesystem::remove_all(workDir);
+    std::cout << "  exit status " << (same ? "identical on every path" : "MISMATCH") << "\n";
+    return same ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+// Lexer throughput in MB/s for each scanning-kernel level.
+//
+//   bench_lexer [file.fls] [--mb N] [--runs N]
+//
+// Without a file a synthetic program of N MB (default 16) is lexed. The
+// scalar row is the byte-at-a-time baseline; every level must produce the
+// same token stream.
+
+#include "BenchUtil.h"
+#include "Lexer.h"
+#include "LexerScan.h"
+#include "SourceBuffer.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    std::string file;
+    size_t megabytes = 16;
+    int runs = 5;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--mb" && i + 1 < argc) {
+            megabytes = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--runs" && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        } else {
+            file = arg;
+        }
+    }
+    
+    auto source = file.empty()
+        ? SourceBuffer::fromString(bench::generateSource(megabytes << 20), "<synthetic>")
+        : SourceBuffer::fromFile(file);
+    double sizeMB = source->getSize() / (1024.0 * 1024.0);
+    
+    std::cout << "Lexer throughput: " << source->getName() << " (" << std::fixed
+              << std::setprecision(2) << sizeMB << " MB, best of " << runs << ")\n";
+    std::cout << "  host best level: " << LexerScan::levelName(LexerScan::bestLevel()) << "\n\n";
+    
+    std::vector<Token> reference;
+    double baseline = 0.0;
+    const LexerScan::Level levels[] = {
+        LexerScan::Level::Scalar, LexerScan::Level::SSE2, LexerScan::Level::AVX2
+    };
+    
+    for (LexerScan::Level requested : levels) {
+        LexerScan::Level level = LexerScan::setLevel(requested);
+        if (level != requested) {
+            std::cout << "  " << std::left << std::setw(8) << LexerScan::levelName(requested)
+                      << "not supported on this CPU\n";
+            continue;
+        }
+        
+        size_t tokenCount = 0;
+        std::vector<Token> tokens;
+        double seconds = bench::bestOf(runs, [&] {
+            Lexer lexer(*source);
+            tokens = lexer.tokenize();
+            tokenCount = tokens.size();
+        });
+        
+        if (reference.empty()) {
+            reference = std::move(tokens);
+        } else if (!bench::sameTokens(reference, tokens)) {
+            std::cerr << "token stream mismatch at level " << LexerScan::levelName(level) << "\n";
+            return 1;
+        }
+        
+        double throughput = sizeMB / seconds;
+        if (baseline == 0.0) baseline = throughput;
+        std::cout << "  " << std::left << std::setw(8) << LexerScan::levelName(level)
+                  << std::right << std::setw(10) << throughput << " MB/s  "
+                  << std::setw(6) << throughput / baseline << "x  ("
+                  << tokenCount << " tokens)\n";
+    }
+    
+    LexerScan::setLevel(LexerScan::bestLevel());
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Parallel lexing: differential check against the serial lexer, then
+// throughput scaling from 1 to 32 threads.
+//
+//   bench_lexer_parallel [file.fls] [--mb N] [--runs N]
+//
+// The differential pass lexes generated inputs that put multi-line strings,
+// raw strings, template strings, escapes and block comments around every
+// possible split point, using tiny chunks so each construct straddles many
+// boundaries. Any difference from Lexer::tokenize() fails the run.
+
+#include "BenchUtil.h"
+#include "Lexer.h"
+#include "SourceBuffer.h"
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <cstdlib>
+
+// Source dense in constructs that make a newline unsafe to split at
+static std::string generateTrickySource(unsigned seed, size_t pieces) {
+    std::mt19937 rng(seed);
+    auto pick = [&](int n) { return static_cast<int>(rng() % n); };
+    std::string out;
+    for (size_t i = 0; i < pieces; i++) {
+        switch (pick(16)) {
+            case 0: out += "\"line one\nline two // not a comment\n\""; break;
+            case 1: out += "\"escaped \\\" quote\n and \\\\\"\n"; break;
+            case 2: out += "r\"raw ends at backslash \\\"\n"; break;
+            case 3: out += "var\"not raw \\\" still string\n\"\n"; break;
+            case 4: out += "12r\"raw after number\n\"\n1.5e3r\"raw\"\nx1r\"plain \\\"\n\"\n"; break;
+            case 5: out += "`template\n${x}\n\\` still template\n`\n"; break;
+            case 6: out += "'single\n\\' quoted'\n"; break;
+            case 7: out += "/* block\n \"quote\" `tick` // slash\n*/\n"; break;
+            case 8: out += "/*/ still open\n*/\n"; break;
+            case 9: out += "// comment with \" quote and /* opener\n"; break;
+            case 10: out += "a / b /= c * d\n"; break;
+            case 11: out += std::string(pick(40), ' ') + "\n\n"; break;
+            case 12: out += "func f" + std::to_string(i) + "(x: int32) -> int32 { return x ** 2; }\n"; break;
+            case 13: out += "let n = 1_000_000; let m = 2.5e-3;\n"; break;
+            case 14: out += "\"\\n\"\n"; break;
+            default: out += "ident_" + std::to_string(pick(1000)) + " += 1;\n"; break;
+        }
+    }
+    return out;
+}
+
+static bool checkEquivalent(SourceBuffer& source, const char* label) {
+    Lexer serialLexer(source);
+    std::vector<Token> serial = serialLexer.tokenize();
+    
+    const unsigned threadCounts[] = {2, 3, 4, 7, 8, 16, 32};
+    const size_t chunkSizes[] = {16, 64, 1024, 64 * 1024};
+    for (unsigned threads : threadCounts) {
+        for (size_t chunkBytes : chunkSizes) {
+            Lexer parallelLexer(source);
+            std::vector<Token> parallel = parallelLexer.tokenizeParallel(threads, chunkBytes);
+            if (!bench::sameTokens(serial, parallel)) {
+                std::cerr << "MISMATCH: " << label << " threads=" << threads
+                          << " chunk=" << chunkBytes << "\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string file;
+    size_t megabytes = 32;
+    int runs = 3;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--mb" && i + 1 < argc) {
+            megabytes = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--runs" && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        } else {
+            file = arg;
+        }
+    }
+    
+    // Differential check
+    size_t checked = 0;
+    for (unsigned seed = 1; seed <= 20; seed++) {
+        auto tricky = SourceBuffer::fromString(generateTrickySource(seed, 400), "<tricky>");
+        if (!checkEquivalent(*tricky, "tricky")) return 1;
+        checked++;
+    }
+    auto regular = SourceBuffer::fromString(bench::generateSource(256 * 1024), "<synthetic>");
+    if (!checkEquivalent(*regular, "synthetic")) return 1;
+    checked++;
+    std::cout << "Differential check: parallel == serial on " << checked << " inputs\n\n";
+    
+    // Scaling
+    auto source = file.empty()
+        ? SourceBuffer::fromString(bench::generateSource(megabytes << 20), "<synthetic>")
+        : SourceBuffer::fromFile(file);
+    double sizeMB = source->getSize() / (1024.0 * 1024.0);
+    std::cout << "Parallel lexing: " << source->getName() << " (" << std::fixed
+              << std::setprecision(2) << sizeMB << " MB, best of " << runs << ")\n";
+    
+    double baseline = 0.0;
+    const unsigned threadCounts[] = {1, 2, 4, 8, 16, 32};
+    for (unsigned threads : threadCounts) {
+        double seconds = bench::bestOf(runs, [&] {
+            Lexer lexer(*source);
+            auto tokens = threads == 1 ? lexer.tokenize() : lexer.tokenizeParallel(threads);
+        });
+        double throughput = sizeMB / seconds;
+        if (baseline == 0.0) baseline = throughput;
+        std::cout << "  " << std::setw(2) << threads << " threads  " << std::setw(9)
+                  << throughput << " MB/s  " << std::setw(6) << throughput / baseline << "x\n";
+    }
+    return 0;
+}
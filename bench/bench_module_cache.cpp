@@ -0,0 +1,96 @@
+// Imported-module cost with and without the binary AST cache.
+//
+//   bench_module_cache [file.fls] [--mb N] [--runs N]
+//
+// Cold: lex + parse the module and write its cache file (what the first
+// build pays). Warm: map the cache and rebuild the declarations with bodies
+// still deferred (what every later build pays), and the same again with
+// every body decoded, the worst case for an importer that calls everything.
+// Without a file a synthetic module of N MB (default 4) is used. The warm
+// AST is checked against the parsed one before anything is reported.
+
+#include "BenchUtil.h"
+#include "ASTContext.h"
+#include "Lexer.h"
+#include "ModuleCache.h"
+#include "Parser.h"
+#include "SourceBuffer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+static void loadAllBodies(ProgramAST* program) {
+    for (auto* decl : program->declarations) {
+        if (auto* func = llvm::dyn_cast<FunctionDeclAST>(decl)) {
+            func->ensureBody();
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string file;
+    size_t megabytes = 4;
+    int runs = 5;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--mb" && i + 1 < argc) {
+            megabytes = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--runs" && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        } else {
+            file = arg;
+        }
+    }
+
+    std::unique_ptr<SourceBuffer> source = file.empty()
+        ? SourceBuffer::fromString(bench::generateProgram(megabytes << 20), "<synthetic>")
+        : SourceBuffer::fromFile(file);
+    std::string cachePath = (std::filesystem::temp_directory_path() / "bench_module_cache.ast").string();
+
+    double cold = bench::bestOf(runs, [&] {
+        ASTContext context;
+        Lexer lexer(*source);
+        Parser parser(lexer.tokenize(), context, source->getName());
+        parser.setLazyFunctionBodies(true);
+        ModuleCache::write(parser.parseProgram(), cachePath);
+    });
+
+    size_t nodes = 0;
+    double warm = bench::bestOf(runs, [&] {
+        ASTContext context;
+        auto reader = ModuleCacheReader::open(cachePath);
+        reader->load(context);
+        nodes = reader->getNodeCount();
+    });
+
+    double warmAll = bench::bestOf(runs, [&] {
+        ASTContext context;
+        auto reader = ModuleCacheReader::open(cachePath);
+        loadAllBodies(reader->load(context));
+    });
+
+    // The cached tree must print exactly like the parsed one
+    ASTContext parsedContext, cachedContext;
+    Lexer lexer(*source);
+    Parser parser(lexer.tokenize(), parsedContext, source->getName());
+    ProgramAST* parsed = parser.parseProgram();
+    auto reader = ModuleCacheReader::open(cachePath);
+    ProgramAST* cached = reader->load(cachedContext);
+    loadAllBodies(cached);
+    bool same = parsed->toString() == cached->toString();
+    size_t cacheBytes = std::filesystem::file_size(cachePath);
+    reader.reset();
+    std::remove(cachePath.c_str());
+
+    std::cout << "Module cache: " << source->getName() << " (" << std::fixed << std::setprecision(2)
+              << source->getSize() / (1024.0 * 1024.0) << " MB source, "
+              << cacheBytes / (1024.0 * 1024.0) << " MB cache, " << nodes << " nodes)\n";
+    std::cout << std::setprecision(1);
+    std::cout << "  cold (lex + parse + write)   " << cold * 1000 << " ms\n";
+    std::cout << "  warm (map + declarations)    " << warm * 1000 << " ms  (" << cold / warm << "x)\n";
+    std::cout << "  warm + every body            " << warmAll * 1000 << " ms  (" << cold / warmAll << "x)\n";
+    std::cout << "  round trip                   " << (same ? "identical" : "MISMATCH") << "\n";
+    return same ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+// Parser cost: heap allocations, parse time, teardown time and peak RSS.
+//
+//   bench_parser [file.fls] [--mb N] [--expressions] [--chain N [--op OP]]
+//                [--lazy [--use N]]
+//
+// Without a file a synthetic program of N MB (default 16) is parsed.
+// --expressions makes it expression-heavy (deep operator trees); --chain
+// parses one flat chain of N operands, mixing every precedence level or
+// repeating OP (e.g. '**'). --lazy skips function bodies the way imported
+// modules are parsed, then parses the first N of them on demand (--use,
+// default 0) to show what an importer of a few functions pays.
+//
+// Heap allocations are counted by replacing the global operator new for
+// this binary only; arena slabs show up in that count like any other
+// allocation.
+
+#include "BenchUtil.h"
+#include "ASTContext.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SourceBuffer.h"
+#include <sys/resource.h>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+static std::atomic<size_t> heapAllocations{0};
+
+void* operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    std::string file;
+    size_t megabytes = 16;
+    bool expressions = false;
+    size_t chainTerms = 0;
+    std::string chainOp;
+    bool lazy = false;
+    size_t useBodies = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--mb" && i + 1 < argc) {
+            megabytes = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--expressions") {
+            expressions = true;
+        } else if (arg == "--chain" && i + 1 < argc) {
+            chainTerms = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--op" && i + 1 < argc) {
+            chainOp = " " + std::string(argv[++i]) + " ";
+        } else if (arg == "--lazy") {
+            lazy = true;
+        } else if (arg == "--use" && i + 1 < argc) {
+            useBodies = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            file = arg;
+        }
+    }
+
+    std::unique_ptr<SourceBuffer> source;
+    if (!file.empty()) {
+        source = SourceBuffer::fromFile(file);
+    } else if (chainTerms > 0) {
+        source = SourceBuffer::fromString(
+            bench::generateOperatorChain(chainTerms, chainOp.empty() ? nullptr : chainOp.c_str()), "<chain>");
+    } else if (expressions) {
+        source = SourceBuffer::fromString(bench::generateExpressionSource(megabytes << 20), "<expressions>");
+    } else {
+        source = SourceBuffer::fromString(bench::generateProgram(megabytes << 20), "<synthetic>");
+    }
+    Lexer lexer(*source);
+    auto tokens = lexer.tokenize();
+    size_t tokenCount = tokens.size();
+
+    auto context = std::make_unique<ASTContext>();
+    size_t allocationsBefore = heapAllocations.load();
+    auto start = std::chrono::steady_clock::now();
+    Parser parser(std::move(tokens), *context, source->getName());
+    parser.setLazyFunctionBodies(lazy);
+    ProgramAST* program = parser.parseProgram();
+    double parseMs = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    size_t bodiesParsed = 0;
+    for (auto* decl : program->declarations) {
+        if (bodiesParsed == useBodies) break;
+        if (auto* func = llvm::dyn_cast<FunctionDeclAST>(decl); func && func->hasDeferredBody()) {
+            func->ensureBody();
+            bodiesParsed++;
+        }
+    }
+    double bodiesMs = millisecondsSince(start);
+    size_t parseAllocations = heapAllocations.load() - allocationsBefore;
+    size_t declarations = program->declarations.size();
+    ASTContext::Stats arena = context->getStats();
+
+    start = std::chrono::steady_clock::now();
+    context.reset();
+    double freeMs = millisecondsSince(start);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    std::cout << "Parser: " << source->getName() << " (" << std::fixed << std::setprecision(2)
+              << source->getSize() / (1024.0 * 1024.0) << " MB, " << tokenCount << " tokens, "
+              << declarations << " declarations)\n";
+    std::cout << "  heap allocations  " << parseAllocations << "\n";
+    std::cout << "  arena objects     " << arena.allocations << " in " << arena.slabs << " slabs ("
+              << arena.bytesUsed / 1024 << " KB used)\n";
+    std::cout << std::setprecision(1);
+    std::cout << "  parse time        " << parseMs << " ms\n";
+    if (lazy) {
+        std::cout << "  deferred bodies   " << parser.getDeferredBodyCount() << "\n";
+        std::cout << "  on-demand parse   " << bodiesMs << " ms (" << bodiesParsed << " bodies)\n";
+    }
+    std::cout << "  free time         " << freeMs << " ms\n";
+    std::cout << "  peak RSS          " << usage.ru_maxrss / 1024 << " MB\n";
+    return declarations > 0 ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+// Profile-guided optimisation on branchy code.
+//
+//   bench_pgo [--runs N] [--opt-level 2]
+//
+// Each kernel is built three ways at the same level: plain, instrumented
+// with --profile-generate (then run once to write the profile), and again
+// with --profile-use. The best of N runs of the plain and profile-guided
+// programs is reported together with the instrumented run. Output must match
+// across all three.
+
+#include "BenchUtil.h"
+#include "ASTContext.h"
+#include "CodeGen.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SourceBuffer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+struct Kernel {
+    const char* name;
+    const char* source;
+};
+
+// A chain of early returns that are each rarely taken (block layout: the
+// fall-through path should be the hot one), a dispatch whose common case is
+// tested last, and a cold repair loop next to a hot loop body
+static const Kernel kernels[] = {
+    {"layout", R"(func mix(x: i32) -> i32 {
+    while x % 3 == 2 {
+        return x * 3 + 9;
+    }
+    while x % 5 == 4 {
+        return x * 5 + 15;
+    }
+    while x % 7 == 6 {
+        return x * 7 + 21;
+    }
+    while x % 11 == 10 {
+        return x * 11 + 33;
+    }
+    while x % 13 == 12 {
+        return x * 13 + 39;
+    }
+    while x % 17 == 16 {
+        return x * 17 + 51;
+    }
+    while x % 19 == 18 {
+        return x * 19 + 57;
+    }
+    while x % 23 == 22 {
+        return x * 23 + 69;
+    }
+    return x + 1;
+}
+
+func main() -> i32 {
+    let acc: i32 = 0;
+    let i: i32 = 0;
+    while i < 100000000 {
+        acc = acc + mix(i);
+        i = i + 1;
+    }
+    println(acc);
+    return 0;
+}
+)"},
+    {"dispatch", R"(func step(op: i32, x: i32) -> i32 {
+    while op == 0 {
+        return x * 3 + 1;
+    }
+    while op == 1 {
+        return x / 3 + 7;
+    }
+    while op == 2 {
+        return x * x + 9;
+    }
+    while op == 3 {
+        return (x + 11) * 5;
+    }
+    return x + 1;
+}
+
+func main() -> i32 {
+    let acc: i32 = 0;
+    let i: i32 = 0;
+    while i < 300000000 {
+        let op: i32 = 4;
+        let probe: i32 = i % 1024;
+        while probe == 0 {
+            op = i / 1024 % 4;
+            probe = 1;
+        }
+        acc = step(op, acc);
+        i = i + 1;
+    }
+    println(acc);
+    return 0;
+}
+)"},
+    {"cold_path", R"(func check(x: i32, total: i32) -> i32 {
+    while x % 65521 == 65520 {
+        let repair: i32 = total;
+        let k: i32 = 0;
+        while k < 64 {
+            repair = repair * 31 + k;
+            k = k + 1;
+        }
+        return repair;
+    }
+    return total + x % 13;
+}
+
+func main() -> i32 {
+    let total: i32 = 0;
+    let i: i32 = 0;
+    while i < 200000000 {
+        total = check(i, total);
+        i = i + 1;
+    }
+    println(total);
+    return 0;
+}
+)"},
+};
+
+static std::string runProgram(const std::string& path) {
+    std::string output;
+    FILE* pipe = popen(("\"" + path + "\"").c_str(), "r");
+    if (!pipe) return output;
+    char buffer[256];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        output.append(buffer, read);
+    }
+    pclose(pipe);
+    return output;
+}
+
+static std::string build(const std::string& sourcePath, const CodeGenerator::BuildOptions& options) {
+    std::ostringstream discard;
+    std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+    auto source = SourceBuffer::fromFile(sourcePath);
+    Lexer lexer(*source);
+    ASTContext context;
+    Parser parser(lexer.tokenize(), context, sourcePath);
+    ProgramAST* program = parser.parseProgram();
+    CodeGenerator codegen;
+    codegen.setBuildOptions(options);
+    codegen.generateCodeIncremental(program, sourcePath);
+    std::string exePath = codegen.writeExecutable(sourcePath, false, options.optimized());
+    std::cout.rdbuf(console);
+    return exePath;
+}
+
+int main(int argc, char* argv[]) {
+    int runs = 3;
+    std::string levelName = "2";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        } else if (arg == "--opt-level" && i + 1 < argc) {
+            levelName = argv[++i];
+        }
+    }
+    CodeGenerator::OptLevel level;
+    if (!CodeGenerator::parseOptLevel(levelName, level)) {
+        std::cerr << "unknown level " << levelName << "\n";
+        return 1;
+    }
+
+    auto workDir = std::filesystem::temp_directory_path() / "flast_bench_pgo";
+    std::filesystem::remove_all(workDir);
+    std::filesystem::create_directories(workDir);
+
+    std::cout << "Profile-guided optimisation at -O" << levelName << " (best of " << runs << ", ms)\n";
+    std::cout << std::left << std::setw(12) << "kernel" << std::setw(12) << "plain"
+              << std::setw(16) << "instrumented" << std::setw(12) << "pgo" << "speedup\n";
+    std::cout << std::fixed << std::setprecision(1);
+
+    bool same = true;
+    for (const auto& kernel : kernels) {
+        std::string sourcePath = (workDir / (std::string(kernel.name) + ".fls")).string();
+        std::ofstream(sourcePath) << kernel.source;
+        std::string profilePath = (workDir / (std::string(kernel.name) + ".profraw")).string();
+
+        CodeGenerator::BuildOptions options;
+        options.debugMode = false;
+        options.optLevel = level;
+
+        std::string output;
+        std::string exePath = build(sourcePath, options);
+        double plain = bench::bestOf(runs, [&] { output = runProgram(exePath); });
+        std::string expected = output;
+
+        CodeGenerator::BuildOptions instrumented = options;
+        instrumented.profileGenerate = profilePath;
+        exePath = build(sourcePath, instrumented);
+        double training = bench::bestOf(1, [&] { output = runProgram(exePath); });
+        same = same && output == expected;
+
+        CodeGenerator::BuildOptions guided = options;
+        guided.profileUse = profilePath;
+        {
+            std::ostringstream discard;
+            std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+            guided.profileDigest = CodeGenerator::loadProfile(guided.profileUse, workDir);
+            std::cout.rdbuf(console);
+        }
+        exePath = build(sourcePath, guided);
+        double pgo = bench::bestOf(runs, [&] { output = runProgram(exePath); });
+        same = same && output == expected;
+
+        std::cout << std::setw(12) << kernel.name << std::setw(12) << plain * 1000
+                  << std::setw(16) << training * 1000 << std::setw(12) << pgo * 1000
+                  << std::setprecision(2) << plain / pgo << "x" << std::setprecision(1) << "\n";
+    }
+
+    std::filesystem::remove_all(workDir);
+    std::cout << "  output " << (same ? "identical with and without profile" : "MISMATCH") << "\n";
+    return same ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+// Per-line latency of `flast repl` as the session grows.
+//
+//   bench_repl [--definitions N] [--window W]
+//
+// Feeds N function definitions, each calling an earlier one (f<n> calls
+// f<n/2>, so calls stay shallow), and after every tenth one an expression
+// that calls the newest. Reports the median and 99th percentile latency of
+// both kinds of line over the first and the last W of them; with nothing
+// recompiled, late lines should cost about as much as early ones.
+
+#include "BenchUtil.h"
+#include "Repl.h"
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+static double percentile(std::vector<double> samples, double fraction) {
+    std::sort(samples.begin(), samples.end());
+    return samples[std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()))];
+}
+
+static double timeLine(Repl& repl, const std::string& line, bool& ok) {
+    auto start = std::chrono::steady_clock::now();
+    ok = repl.evaluate(line) && ok;
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static void report(const std::string& name, const std::vector<double>& samples, size_t window) {
+    std::vector<double> first(samples.begin(), samples.begin() + std::min(window, samples.size()));
+    std::vector<double> last(samples.end() - std::min(window, samples.size()), samples.end());
+    std::cout << std::setw(14) << name << std::setw(12) << percentile(first, 0.5) << std::setw(12)
+              << percentile(first, 0.99) << std::setw(12) << percentile(last, 0.5) << std::setw(12)
+              << percentile(last, 0.99) << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = 3000;
+    size_t window = 200;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--definitions" && i + 1 < argc) {
+            count = std::stoul(argv[++i]);
+        } else if (arg == "--window" && i + 1 < argc) {
+            window = std::stoul(argv[++i]);
+        }
+    }
+
+    CodeGenerator::BuildOptions options;
+    options.debugMode = false;
+    options.targetCPU = "native";
+    CodeGenerator::resolveTarget(options.targetCPU, options.targetFeatures);
+
+    auto workDir = std::filesystem::temp_directory_path() / "flast_bench_repl";
+    std::filesystem::remove_all(workDir);
+    std::filesystem::create_directories(workDir);
+
+    std::vector<double> definitions, expressions;
+    bool ok = true;
+    {
+        std::ostringstream discard;
+        std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+        Repl repl(options, workDir.string());
+        ok = repl.evaluate("func f0(x: i32) -> i32 { return x; }");
+        for (size_t n = 1; n <= count; n++) {
+            std::string id = std::to_string(n);
+            std::string line = "func f" + id + "(x: i32) -> i32 {\n"
+                               "    let y: i32 = x * " + std::to_string(n % 13 + 2) + ";\n"
+                               "    while y > 1000 {\n"
+                               "        y = y / 3;\n"
+                               "    }\n"
+                               "    return f" + std::to_string(n / 2) + "(y) + 1;\n"
+                               "}";
+            definitions.push_back(timeLine(repl, line, ok));
+            if (n % 10 == 0) {
+                expressions.push_back(timeLine(repl, "f" + id + "(7) % 1000;", ok));
+            }
+        }
+        ok = ok && repl.definitionCount() == count + 1;
+        std::cout.rdbuf(console);
+    }
+    std::filesystem::remove_all(workDir);
+
+    std::cout << "REPL latency over " << count << " definitions (ms)\n";
+    std::cout << std::left << std::setw(14) << "line" << std::setw(12) << "first p50" << std::setw(12)
+              << "first p99" << std::setw(12) << "last p50" << std::setw(12) << "last p99" << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    report("definition", definitions, window);
+    report("expression", expressions, window / 10);
+    std::cout << "  " << (ok ? "every line evaluated" : "SOME LINES FAILED") << "\n";
+    return ok ? 0 : 1;
+}
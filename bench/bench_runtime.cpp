@@ -0,0 +1,190 @@
+// Run time of compiled programs at each optimisation level.
+//
+//   bench_runtime [--runs N] [--levels 0123sz]
+//
+// Each kernel is a small FLAST program built the way `flast --opt-level`
+// builds it (incremental codegen, then the default linker) and then run as
+// a child process; the best of N runs is reported next to the build time.
+// A level whose output differs from -O0's fails the run.
+
+#include "BenchUtil.h"
+#include "ASTContext.h"
+#include "CodeGen.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SourceBuffer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+struct Kernel {
+    const char* name;
+    const char* source;
+};
+
+// Calls (inlining, tail recursion), a division-heavy reduction (mem2reg,
+// strength reduction), a nested data-dependent loop, and a reduction the
+// loop vectorizer can take
+static const Kernel kernels[] = {
+    {"fib", R"(func fib(n: i32) -> i32 {
+    while n < 2 {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+
+func main() -> i32 {
+    println(fib(35));
+    return 0;
+}
+)"},
+    {"sum_mod", R"(func sum_mod(n: i32) -> i32 {
+    let total: i32 = 0;
+    let i: i32 = 0;
+    while i < n {
+        total = (total + (i * i) % 7 + i / 3) % 1000003;
+        i = i + 1;
+    }
+    return total;
+}
+
+func main() -> i32 {
+    println(sum_mod(100000000));
+    return 0;
+}
+)"},
+    {"collatz", R"(func collatz(limit: i32) -> i32 {
+    let total: i32 = 0;
+    let start: i32 = 1;
+    while start < limit {
+        let x: i32 = start;
+        while x != 1 {
+            let odd: i32 = x % 2;
+            x = odd * (3 * x + 1) + (1 - odd) * (x / 2);
+            total = total + 1;
+        }
+        start = start + 1;
+    }
+    return total;
+}
+
+func main() -> i32 {
+    println(collatz(100000));
+    return 0;
+}
+)"},
+    {"mix", R"(func mix(n: i32) -> i32 {
+    let total: i32 = 0;
+    let round: i32 = 0;
+    while round < 100 {
+        let i: i32 = 0;
+        while i < n {
+            total = total + (i % 8) * (i % 5) + (i % 3);
+            i = i + 1;
+        }
+        round = round + 1;
+    }
+    return total;
+}
+
+func main() -> i32 {
+    println(mix(1000000));
+    return 0;
+}
+)"},
+};
+
+static std::string runProgram(const std::string& path) {
+    std::string output;
+    FILE* pipe = popen(("\"" + path + "\"").c_str(), "r");
+    if (!pipe) return output;
+    char buffer[256];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        output.append(buffer, read);
+    }
+    pclose(pipe);
+    return output;
+}
+
+int main(int argc, char* argv[]) {
+    int runs = 3;
+    std::string levels = "0123sz";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        } else if (arg == "--levels" && i + 1 < argc) {
+            levels = argv[++i];
+        }
+    }
+
+    auto workDir = std::filesystem::temp_directory_path() / "flast_bench_runtime";
+    std::filesystem::remove_all(workDir);
+    std::filesystem::create_directories(workDir);
+
+    std::cout << "Runtime by optimisation level (best of " << runs << ", ms; build ms in brackets)\n";
+    std::cout << std::left << std::setw(10) << "kernel";
+    for (char level : levels) std::cout << std::setw(18) << (std::string("-O") + level);
+    std::cout << "\n" << std::fixed << std::setprecision(1);
+
+    bool same = true;
+    for (const auto& kernel : kernels) {
+        std::string sourcePath = (workDir / (std::string(kernel.name) + ".fls")).string();
+        std::ofstream(sourcePath) << kernel.source;
+
+        std::cout << std::setw(10) << kernel.name;
+        std::string expected;
+        double baseline = 0;
+        for (char levelName : levels) {
+            CodeGenerator::OptLevel level;
+            if (!CodeGenerator::parseOptLevel(std::string(1, levelName), level)) {
+                std::cerr << "unknown level " << levelName << "\n";
+                return 1;
+            }
+
+            std::ostringstream discard;
+            std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+            std::string exePath;
+            double build = bench::bestOf(1, [&] {
+                auto source = SourceBuffer::fromFile(sourcePath);
+                Lexer lexer(*source);
+                ASTContext context;
+                Parser parser(lexer.tokenize(), context, sourcePath);
+                ProgramAST* program = parser.parseProgram();
+                CodeGenerator::BuildOptions options;
+                options.debugMode = false;
+                options.optLevel = level;
+                CodeGenerator codegen;
+                codegen.setBuildOptions(options);
+                codegen.generateCodeIncremental(program, sourcePath);
+                exePath = codegen.writeExecutable(sourcePath, false, level != CodeGenerator::OptLevel::O0);
+            });
+            std::cout.rdbuf(console);
+
+            std::string output;
+            double run = bench::bestOf(runs, [&] { output = runProgram(exePath); });
+            if (expected.empty()) {
+                expected = output;
+                baseline = run;
+            } else if (output != expected) {
+                same = false;
+            }
+
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(1) << run * 1000;
+            if (run != baseline) cell << " " << std::setprecision(2) << baseline / run << "x";
+            cell << " [" << std::setprecision(0) << build * 1000 << "]";
+            std::cout << std::setw(18) << cell.str();
+        }
+        std::cout << "\n";
+    }
+
+    std::filesystem::remove_all(workDir);
+    std::cout << "  output " << (same ? "identical at every level" : "MISMATCH") << "\n";
+    return same ? 0 : 1;
+}
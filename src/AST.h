@@ -6,6 +6,9 @@
 #include <optional>
 #include <unordered_map>
 #include <iostream>
+#include "StringInterner.h"
+#include "ASTContext.h"
+#include <llvm/Support/Casting.h>
 
 // Forward declarations
 struct ExprAST;
@@ -55,6 +58,62 @@ struct ImportDeclAST;
 struct ModuleDeclAST;
 struct ProgramAST;
 
+// Discriminator stored in every node. Expression, statement and declaration
+// kinds are kept in contiguous ranges so the category checks in classof are
+// two compares; llvm::isa / dyn_cast / cast work on any node through them.
+enum class NodeKind : uint8_t {
+    // Expressions
+    NumberExpr,
+    ScientificExpr,
+    StringExpr,
+    BoolExpr,
+    NullExpr,
+    VariableExpr,
+    BinaryExpr,
+    UnaryExpr,
+    CallExpr,
+    MemberAccessExpr,
+    IndexExpr,
+    NewExpr,
+    ListExpr,
+    MapExpr,
+    TupleExpr,
+    LambdaExpr,
+    BuiltinMethodExpr,
+    MethodCallExpr,
+    TypeCast,
+    ArrayExpr,
+    // Statements
+    VarDeclStmt,
+    AssignStmt,
+    ExprStmt,
+    ReturnStmt,
+    BlockStmt,
+    IfStmt,
+    WhileStmt,
+    ForStmt,
+    ForInStmt,
+    MatchStmt,
+    BreakStmt,
+    ContinueStmt,
+    TryCatchStmt,
+    ThrowStmt,
+    // Declarations
+    StructDecl,
+    EnumDecl,
+    TraitDecl,
+    ImplDecl,
+    FunctionDecl,
+    ImportDecl,
+    ModuleDecl,
+    // Top level
+    Program,
+
+    FirstExpr = NumberExpr, LastExpr = ArrayExpr,
+    FirstStmt = VarDeclStmt, LastStmt = ThrowStmt,
+    FirstDecl = StructDecl, LastDecl = ModuleDecl
+};
+
 // ==================== AST VISITOR INTERFACE ====================
 // Visitor interface
 class ASTVisitor {
@@ -109,6 +168,52 @@ public:
     virtual void visit(ProgramAST& node) = 0;
 };
 
+// Operator opcodes. The parser maps tokens to these once; later passes
+// switch on or index tables by them instead of comparing operator text.
+enum class BinaryOp : uint8_t {
+    Add, Sub, Mul, Div, Mod, Pow,
+    Shl, Shr, UShr,
+    BitAnd, BitOr, BitXor,
+    LogicalAnd, LogicalOr,
+    Eq, Ne, StrictEq, StrictNe,
+    Lt, Gt, Le, Ge, Spaceship,
+    Ternary,
+    Assign, AddAssign, SubAssign, MulAssign, DivAssign, ModAssign, PowAssign,
+    BitAndAssign, BitOrAssign, BitXorAssign, ShlAssign, ShrAssign,
+    Count
+};
+
+enum class UnaryOp : uint8_t {
+    Neg, Plus, Not, BitNot,
+    PreIncrement, PreDecrement,
+    AddressOf, Dereference,
+    Count
+};
+
+inline const char* getOperatorSpelling(BinaryOp op) {
+    static const char* const spellings[] = {
+        "+", "-", "*", "/", "%", "**",
+        "<<", ">>", ">>>",
+        "&", "|", "^",
+        "&&", "||",
+        "==", "!=", "===", "!==",
+        "<", ">", "<=", ">=", "<=>",
+        "?:",
+        "=", "+=", "-=", "*=", "/=", "%=", "**=",
+        "&=", "|=", "^=", "<<=", ">>="
+    };
+    static_assert(sizeof(spellings) / sizeof(spellings[0]) == static_cast<size_t>(BinaryOp::Count),
+                  "one spelling per binary opcode");
+    return spellings[static_cast<size_t>(op)];
+}
+
+inline const char* getOperatorSpelling(UnaryOp op) {
+    static const char* const spellings[] = {"-", "+", "!", "~", "++", "--", "&", "*"};
+    static_assert(sizeof(spellings) / sizeof(spellings[0]) == static_cast<size_t>(UnaryOp::Count),
+                  "one spelling per unary opcode");
+    return spellings[static_cast<size_t>(op)];
+}
+
 // Enhanced Rust-like type system
 enum class FlastType {
     VOID,
@@ -130,15 +235,38 @@ enum class FlastType {
 
 struct TypeInfo {
     FlastType type;
-    std::string className;
-    std::vector<std::shared_ptr<TypeInfo>> parameters;
+    Identifier className;
+    ASTList<const TypeInfo*> parameters;
     bool isPointer = false;
     bool isReference = false;
     bool isConst = false;
     bool isOptional = false;
     
     TypeInfo(FlastType t = FlastType::UNKNOWN) : type(t) {}
-    TypeInfo(FlastType t, const std::string& className) : type(t), className(className) {}
+    TypeInfo(FlastType t, Identifier className) : type(t), className(className) {}
+    
+    // Shared, immutable annotation for a plain builtin type. TypeContext hands
+    // these out as the canonical instances, so they compare by address too.
+    static const TypeInfo* builtin(FlastType t) {
+        static const auto table = [] {
+            std::vector<TypeInfo> types;
+            for (int i = 0; i <= static_cast<int>(FlastType::UNKNOWN); i++) {
+                types.emplace_back(static_cast<FlastType>(i));
+            }
+            return types;
+        }();
+        return &table[static_cast<int>(t)];
+    }
+    
+    // Type of the `null` literal
+    static const TypeInfo* optionalUnknown() {
+        static const TypeInfo info = [] {
+            TypeInfo unknown(FlastType::UNKNOWN);
+            unknown.isOptional = true;
+            return unknown;
+        }();
+        return &info;
+    }
     
     std::string toString() const {
         switch (type) {
@@ -167,7 +295,7 @@ struct TypeInfo {
             case FlastType::TUPLE: return "tuple";
             case FlastType::OPTION: return "option";
             case FlastType::RESULT: return "result";
-            case FlastType::STRUCT: return className.empty() ? "struct" : className;
+            case FlastType::STRUCT: return className.empty() ? "struct" : className.str();
 
             case FlastType::TRAIT: return "trait";
             case FlastType::ENUM: return "enum";
@@ -185,22 +313,44 @@ struct TypeInfo {
     }
 };
 
-// Base AST classes
+// Base AST classes. Nodes live in an ASTContext and are never deleted one
+// by one, so the destructor is protected and non-virtual (keeping every
+// node trivially destructible).
 struct ASTNode {
-    virtual ~ASTNode() = default;
+    const NodeKind kind;
+
+protected:
+    explicit ASTNode(NodeKind kind) : kind(kind) {}
+    ~ASTNode() = default;
+    
+public:
     virtual void accept(ASTVisitor& visitor) = 0;
     virtual std::string toString() const = 0;
     virtual std::string getNodeType() const = 0;
 };
 
 struct ExprAST : ASTNode {
-    std::shared_ptr<TypeInfo> type;
-    ExprAST() : type(std::make_shared<TypeInfo>()) {}
+    const TypeInfo* type = TypeInfo::builtin(FlastType::UNKNOWN);
+
+    explicit ExprAST(NodeKind kind) : ASTNode(kind) {}
+    static bool classof(const ASTNode* node) {
+        return node->kind >= NodeKind::FirstExpr && node->kind <= NodeKind::LastExpr;
+    }
 };
 
-struct StmtAST : ASTNode {};
+struct StmtAST : ASTNode {
+    explicit StmtAST(NodeKind kind) : ASTNode(kind) {}
+    static bool classof(const ASTNode* node) {
+        return node->kind >= NodeKind::FirstStmt && node->kind <= NodeKind::LastStmt;
+    }
+};
 
-struct DeclAST : ASTNode {};
+struct DeclAST : ASTNode {
+    explicit DeclAST(NodeKind kind) : ASTNode(kind) {}
+    static bool classof(const ASTNode* node) {
+        return node->kind >= NodeKind::FirstDecl && node->kind <= NodeKind::LastDecl;
+    }
+};
 
 // ==================== EXPRESSIONS ====================
 
@@ -208,114 +358,122 @@ struct DeclAST : ASTNode {};
 struct NumberExprAST : ExprAST {
     double value;
     bool isScientific;
-    std::string originalText; 
+    std::string_view originalText; 
     
-    NumberExprAST(double val, bool scientific = false, const std::string& original = "") 
-        : value(val), isScientific(scientific), originalText(original) {
-        type = std::make_shared<TypeInfo>(FlastType::F64);
+    NumberExprAST(double val, bool scientific = false, std::string_view original = {}) 
+        : ExprAST(NodeKind::NumberExpr), value(val), isScientific(scientific), originalText(original) {
+        type = TypeInfo::builtin(FlastType::F64);
     }
     std::string toString() const override { 
-        return originalText.empty() ? std::to_string(value) : originalText; 
+        return originalText.empty() ? std::to_string(value) : std::string(originalText); 
     }
     std::string getNodeType() const override { return "NumberExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::NumberExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Scientific notation numbers (e.g., 10e1, 1.5e-3)
 struct ScientificExprAST : ExprAST {
     double value;
-    std::string originalText;
+    std::string_view originalText;
     
-    ScientificExprAST(double val, const std::string& original) 
-        : value(val), originalText(original) {
-        type = std::make_shared<TypeInfo>(FlastType::F64);
+    ScientificExprAST(double val, std::string_view original) 
+        : ExprAST(NodeKind::ScientificExpr), value(val), originalText(original) {
+        type = TypeInfo::builtin(FlastType::F64);
     }
-    std::string toString() const override { return originalText; }
+    std::string toString() const override { return std::string(originalText); }
     std::string getNodeType() const override { return "ScientificExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ScientificExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 struct StringExprAST : ExprAST {
-    std::string value;
-    StringExprAST(const std::string& val) : value(val) {
-        type = std::make_shared<TypeInfo>(FlastType::STRING);
+    std::string_view value;
+    StringExprAST(std::string_view val) : ExprAST(NodeKind::StringExpr), value(val) {
+        type = TypeInfo::builtin(FlastType::STRING);
     }
-    std::string toString() const override { return "\"" + value + "\""; }
+    std::string toString() const override { return "\"" + std::string(value) + "\""; }
     std::string getNodeType() const override { return "StringExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::StringExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 struct BoolExprAST : ExprAST {
     bool value;
-    BoolExprAST(bool val) : value(val) {
-        type = std::make_shared<TypeInfo>(FlastType::BOOL);
+    BoolExprAST(bool val) : ExprAST(NodeKind::BoolExpr), value(val) {
+        type = TypeInfo::builtin(FlastType::BOOL);
     }
     std::string toString() const override { return value ? "true" : "false"; }
     std::string getNodeType() const override { return "BoolExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::BoolExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 struct NullExprAST : ExprAST {
-    NullExprAST() {
-        type = std::make_shared<TypeInfo>(FlastType::UNKNOWN);
-        type->isOptional = true;
+    NullExprAST() : ExprAST(NodeKind::NullExpr) {
+        type = TypeInfo::optionalUnknown();
     }
     std::string toString() const override { return "null"; }
     std::string getNodeType() const override { return "NullExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::NullExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Variable and identifiers
 struct VariableExprAST : ExprAST {
-    std::string name;
-    VariableExprAST(const std::string& name) : name(name) {}
-    std::string toString() const override { return name; }
+    Identifier name;
+    VariableExprAST(Identifier name) : ExprAST(NodeKind::VariableExpr), name(name) {}
+    std::string toString() const override { return name.str(); }
     std::string getNodeType() const override { return "VariableExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::VariableExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Binary operations
 struct BinaryExprAST : ExprAST {
-    std::string op;
-    std::shared_ptr<ExprAST> left, right;
+    BinaryOp op;
+    ExprAST* left;
+    ExprAST* right;
     
-    BinaryExprAST(const std::string& op, std::shared_ptr<ExprAST> left, std::shared_ptr<ExprAST> right)
-        : op(op), left(left), right(right) {}
+    BinaryExprAST(BinaryOp op, ExprAST* left, ExprAST* right)
+        : ExprAST(NodeKind::BinaryExpr), op(op), left(left), right(right) {}
     
     std::string toString() const override {
-        return "(" + left->toString() + " " + op + " " + right->toString() + ")";
+        return "(" + left->toString() + " " + getOperatorSpelling(op) + " " + right->toString() + ")";
     }
     std::string getNodeType() const override { return "BinaryExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::BinaryExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Unary operations
 struct UnaryExprAST : ExprAST {
-    std::string op;
-    std::shared_ptr<ExprAST> operand;
+    UnaryOp op;
+    ExprAST* operand;
     bool isPrefix;
     
-    UnaryExprAST(const std::string& op, std::shared_ptr<ExprAST> operand, bool isPrefix = true)
-        : op(op), operand(operand), isPrefix(isPrefix) {}
+    UnaryExprAST(UnaryOp op, ExprAST* operand, bool isPrefix = true)
+        : ExprAST(NodeKind::UnaryExpr), op(op), operand(operand), isPrefix(isPrefix) {}
     
     std::string toString() const override {
         if (isPrefix) {
-            return op + operand->toString();
+            return getOperatorSpelling(op) + operand->toString();
         } else {
-            return operand->toString() + op;
+            return operand->toString() + getOperatorSpelling(op);
         }
     }
     std::string getNodeType() const override { return "UnaryExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::UnaryExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Function calls
 struct CallExprAST : ExprAST {
-    std::string callee;
-    std::vector<std::shared_ptr<ExprAST>> args;
+    Identifier callee;
+    ASTList<ExprAST*> args;
     
-    CallExprAST(const std::string& callee, std::vector<std::shared_ptr<ExprAST>> args)
-        : callee(callee), args(args) {}
+    CallExprAST(Identifier callee, ASTList<ExprAST*> args)
+        : ExprAST(NodeKind::CallExpr), callee(callee), args(args) {}
     
     std::string toString() const override {
         std::string result = callee + "(";
@@ -327,47 +485,50 @@ struct CallExprAST : ExprAST {
         return result;
     }
     std::string getNodeType() const override { return "CallExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::CallExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Member access (obj.member)
 struct MemberAccessExprAST : ExprAST {
-    std::shared_ptr<ExprAST> object;
-    std::string member;
+    ExprAST* object;
+    Identifier member;
     bool isSafeAccess = false;  
     
-    MemberAccessExprAST(std::shared_ptr<ExprAST> object, const std::string& member, bool isSafeAccess = false)
-        : object(object), member(member), isSafeAccess(isSafeAccess) {}
+    MemberAccessExprAST(ExprAST* object, Identifier member, bool isSafeAccess = false)
+        : ExprAST(NodeKind::MemberAccessExpr), object(object), member(member), isSafeAccess(isSafeAccess) {}
     
     std::string toString() const override {
         return object->toString() + (isSafeAccess ? "?." : ".") + member;
     }
     std::string getNodeType() const override { return "MemberAccessExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::MemberAccessExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Array/List access (arr[index])
 struct IndexExprAST : ExprAST {
-    std::shared_ptr<ExprAST> object;
-    std::shared_ptr<ExprAST> index;
+    ExprAST* object;
+    ExprAST* index;
     
-    IndexExprAST(std::shared_ptr<ExprAST> object, std::shared_ptr<ExprAST> index)
-        : object(object), index(index) {}
+    IndexExprAST(ExprAST* object, ExprAST* index)
+        : ExprAST(NodeKind::IndexExpr), object(object), index(index) {}
     
     std::string toString() const override {
         return object->toString() + "[" + index->toString() + "]";
     }
     std::string getNodeType() const override { return "IndexExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::IndexExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Object creation (new Class())
 struct NewExprAST : ExprAST {
-    std::string className;
-    std::vector<std::shared_ptr<ExprAST>> args;
+    Identifier className;
+    ASTList<ExprAST*> args;
     
-    NewExprAST(const std::string& className, std::vector<std::shared_ptr<ExprAST>> args)
-        : className(className), args(args) {}
+    NewExprAST(Identifier className, ASTList<ExprAST*> args)
+        : ExprAST(NodeKind::NewExpr), className(className), args(args) {}
     
     std::string toString() const override {
         std::string result = "new " + className + "(";
@@ -379,15 +540,16 @@ struct NewExprAST : ExprAST {
         return result;
     }
     std::string getNodeType() const override { return "NewExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::NewExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // List literals [1, 2, 3]
 struct ListExprAST : ExprAST {
-    std::vector<std::shared_ptr<ExprAST>> elements;
+    ASTList<ExprAST*> elements;
     
-    ListExprAST(std::vector<std::shared_ptr<ExprAST>> elements) : elements(elements) {
-        type = std::make_shared<TypeInfo>(FlastType::VEC);
+    ListExprAST(ASTList<ExprAST*> elements) : ExprAST(NodeKind::ListExpr), elements(elements) {
+        type = TypeInfo::builtin(FlastType::VEC);
     }
     
     std::string toString() const override {
@@ -400,16 +562,17 @@ struct ListExprAST : ExprAST {
         return result;
     }
     std::string getNodeType() const override { return "ListExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ListExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Map literals {key: value, ...}
 struct MapExprAST : ExprAST {
-    std::vector<std::pair<std::shared_ptr<ExprAST>, std::shared_ptr<ExprAST>>> pairs;
+    ASTList<std::pair<ExprAST*, ExprAST*>> pairs;
     
-    MapExprAST(std::vector<std::pair<std::shared_ptr<ExprAST>, std::shared_ptr<ExprAST>>> pairs) 
-        : pairs(pairs) {
-        type = std::make_shared<TypeInfo>(FlastType::MAP);
+    MapExprAST(ASTList<std::pair<ExprAST*, ExprAST*>> pairs) 
+        : ExprAST(NodeKind::MapExpr), pairs(pairs) {
+        type = TypeInfo::builtin(FlastType::MAP);
     }
     
     std::string toString() const override {
@@ -422,15 +585,16 @@ struct MapExprAST : ExprAST {
         return result;
     }
     std::string getNodeType() const override { return "MapExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::MapExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Tuple literals (a, b, c)
 struct TupleExprAST : ExprAST {
-    std::vector<std::shared_ptr<ExprAST>> elements;
+    ASTList<ExprAST*> elements;
     
-    TupleExprAST(std::vector<std::shared_ptr<ExprAST>> elements) : elements(elements) {
-        type = std::make_shared<TypeInfo>(FlastType::TUPLE);
+    TupleExprAST(ASTList<ExprAST*> elements) : ExprAST(NodeKind::TupleExpr), elements(elements) {
+        type = TypeInfo::builtin(FlastType::TUPLE);
     }
     
     std::string toString() const override {
@@ -443,47 +607,49 @@ struct TupleExprAST : ExprAST {
         return result;
     }
     std::string getNodeType() const override { return "TupleExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::TupleExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Lambda expressions
 struct LambdaExprAST : ExprAST {
-    std::vector<std::pair<std::string, std::shared_ptr<TypeInfo>>> parameters;
-    std::shared_ptr<TypeInfo> returnType;
-    std::vector<std::shared_ptr<StmtAST>> body;
-    
-    LambdaExprAST(std::vector<std::pair<std::string, std::shared_ptr<TypeInfo>>> parameters,
-                  std::shared_ptr<TypeInfo> returnType,
-                  std::vector<std::shared_ptr<StmtAST>> body)
-        : parameters(parameters), returnType(returnType), body(body) {
-        type = std::make_shared<TypeInfo>(FlastType::FUNCTION);
+    ASTList<std::pair<std::string_view, const TypeInfo*>> parameters;
+    const TypeInfo* returnType;
+    ASTList<StmtAST*> body;
+    
+    LambdaExprAST(ASTList<std::pair<std::string_view, const TypeInfo*>> parameters,
+                  const TypeInfo* returnType,
+                  ASTList<StmtAST*> body)
+        : ExprAST(NodeKind::LambdaExpr), parameters(parameters), returnType(returnType), body(body) {
+        type = TypeInfo::builtin(FlastType::FUNCTION);
     }
     
     std::string toString() const override {
         std::string result = "lambda(";
         for (size_t i = 0; i < parameters.size(); ++i) {
             if (i > 0) result += ", ";
-            result += parameters[i].first + ": " + parameters[i].second->toString();
+            result += std::string(parameters[i].first) + ": " + parameters[i].second->toString();
         }
         result += ") -> " + returnType->toString() + " { ... }";
         return result;
     }
     std::string getNodeType() const override { return "LambdaExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::LambdaExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Built-in method calls (obj.type(), value.tostring())
 struct BuiltinMethodExprAST : ExprAST {
-    std::shared_ptr<ExprAST> object;
-    std::string methodName;
-    std::vector<std::shared_ptr<ExprAST>> args;
+    ExprAST* object;
+    std::string_view methodName;
+    ASTList<ExprAST*> args;
     
-    BuiltinMethodExprAST(std::shared_ptr<ExprAST> object, const std::string& methodName,
-                         std::vector<std::shared_ptr<ExprAST>> args)
-        : object(object), methodName(methodName), args(args) {}
+    BuiltinMethodExprAST(ExprAST* object, std::string_view methodName,
+                         ASTList<ExprAST*> args)
+        : ExprAST(NodeKind::BuiltinMethodExpr), object(object), methodName(methodName), args(args) {}
     
     std::string toString() const override {
-        std::string result = object->toString() + "." + methodName + "(";
+        std::string result = object->toString() + "." + std::string(methodName) + "(";
         for (size_t i = 0; i < args.size(); ++i) {
             if (i > 0) result += ", ";
             result += args[i]->toString();
@@ -492,18 +658,19 @@ struct BuiltinMethodExprAST : ExprAST {
         return result;
     }
     std::string getNodeType() const override { return "BuiltinMethodExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::BuiltinMethodExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Method call expressions (object.method())
 struct MethodCallExprAST : ExprAST {
-    std::shared_ptr<ExprAST> object;
-    std::string method;
-    std::vector<std::shared_ptr<ExprAST>> args;
+    ExprAST* object;
+    Identifier method;
+    ASTList<ExprAST*> args;
     
-    MethodCallExprAST(std::shared_ptr<ExprAST> object, const std::string& method, 
-                      std::vector<std::shared_ptr<ExprAST>> args)
-        : object(object), method(method), args(args) {}
+    MethodCallExprAST(ExprAST* object, Identifier method, 
+                      ASTList<ExprAST*> args)
+        : ExprAST(NodeKind::MethodCallExpr), object(object), method(method), args(args) {}
     
     std::string toString() const override {
         std::string result = object->toString() + "." + method + "(";
@@ -514,30 +681,32 @@ struct MethodCallExprAST : ExprAST {
         return result + ")";
     }
     std::string getNodeType() const override { return "MethodCallExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::MethodCallExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Type casting
 struct TypeCastAST : ExprAST {
-    std::shared_ptr<ExprAST> expression;
-    std::shared_ptr<TypeInfo> targetType;
+    ExprAST* expression;
+    const TypeInfo* targetType;
     
-    TypeCastAST(std::shared_ptr<ExprAST> expression, std::shared_ptr<TypeInfo> targetType)
-        : expression(expression), targetType(targetType) {}
+    TypeCastAST(ExprAST* expression, const TypeInfo* targetType)
+        : ExprAST(NodeKind::TypeCast), expression(expression), targetType(targetType) {}
     
     std::string toString() const override {
         return expression->toString() + " as " + targetType->toString();
     }
     std::string getNodeType() const override { return "TypeCast"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::TypeCast; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Array expressions (for compatibility with ASTVisitor)
 struct ArrayExprAST : ExprAST {
-    std::vector<std::shared_ptr<ExprAST>> elements;
+    ASTList<ExprAST*> elements;
     
-    ArrayExprAST(std::vector<std::shared_ptr<ExprAST>> elements) : elements(elements) {
-        type = std::make_shared<TypeInfo>(FlastType::ARRAY);
+    ArrayExprAST(ASTList<ExprAST*> elements) : ExprAST(NodeKind::ArrayExpr), elements(elements) {
+        type = TypeInfo::builtin(FlastType::ARRAY);
     }
     
     std::string toString() const override {
@@ -550,6 +719,7 @@ struct ArrayExprAST : ExprAST {
         return result;
     }
     std::string getNodeType() const override { return "ArrayExpr"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ArrayExpr; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
@@ -557,15 +727,15 @@ struct ArrayExprAST : ExprAST {
 
 // Variable declarations
 struct VarDeclStmtAST : StmtAST {
-    std::string name;
-    std::shared_ptr<TypeInfo> type;
-    std::shared_ptr<ExprAST> initializer;
+    Identifier name;
+    const TypeInfo* type;
+    ExprAST* initializer;
     bool isConst = false;
     bool isPublic = false;
     
-    VarDeclStmtAST(const std::string& name, std::shared_ptr<TypeInfo> type, 
-                   std::shared_ptr<ExprAST> initializer = nullptr, bool isConst = false, bool isPublic = false)
-        : name(name), type(type), initializer(initializer), isConst(isConst), isPublic(isPublic) {}
+    VarDeclStmtAST(Identifier name, const TypeInfo* type, 
+                   ExprAST* initializer = nullptr, bool isConst = false, bool isPublic = false)
+        : StmtAST(NodeKind::VarDeclStmt), name(name), type(type), initializer(initializer), isConst(isConst), isPublic(isPublic) {}
     
     std::string toString() const override {
         std::string result = std::string(isPublic ? "pub " : "") + std::string(isConst ? "const " : "let ") + name;
@@ -574,57 +744,61 @@ struct VarDeclStmtAST : StmtAST {
         return result + ";";
     }
     std::string getNodeType() const override { return "VarDeclStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::VarDeclStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Assignment statements
 struct AssignStmtAST : StmtAST {
-    std::shared_ptr<ExprAST> target;
-    std::string op;  // =, +=, -=, etc.
-    std::shared_ptr<ExprAST> value;
+    ExprAST* target;
+    std::string_view op;  // =, +=, -=, etc.
+    ExprAST* value;
     
-    AssignStmtAST(std::shared_ptr<ExprAST> target, const std::string& op, std::shared_ptr<ExprAST> value)
-        : target(target), op(op), value(value) {}
+    AssignStmtAST(ExprAST* target, std::string_view op, ExprAST* value)
+        : StmtAST(NodeKind::AssignStmt), target(target), op(op), value(value) {}
     
     std::string toString() const override {
-        return target->toString() + " " + op + " " + value->toString() + ";";
+        return target->toString() + " " + std::string(op) + " " + value->toString() + ";";
     }
     std::string getNodeType() const override { return "AssignStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::AssignStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Expression statements
 struct ExprStmtAST : StmtAST {
-    std::shared_ptr<ExprAST> expression;
+    ExprAST* expression;
     
-    ExprStmtAST(std::shared_ptr<ExprAST> expression) : expression(expression) {}
+    ExprStmtAST(ExprAST* expression) : StmtAST(NodeKind::ExprStmt), expression(expression) {}
     
     std::string toString() const override {
         return expression->toString() + ";";
     }
     std::string getNodeType() const override { return "ExprStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ExprStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Return statements
 struct ReturnStmtAST : StmtAST {
-    std::shared_ptr<ExprAST> value;
+    ExprAST* value;
     
-    ReturnStmtAST(std::shared_ptr<ExprAST> value = nullptr) : value(value) {}
+    ReturnStmtAST(ExprAST* value = nullptr) : StmtAST(NodeKind::ReturnStmt), value(value) {}
     
     std::string toString() const override {
         if (value) return "return " + value->toString() + ";";
         return "return;";
     }
     std::string getNodeType() const override { return "ReturnStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ReturnStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Block statements
 struct BlockStmtAST : StmtAST {
-    std::vector<std::shared_ptr<StmtAST>> statements;
+    ASTList<StmtAST*> statements;
     
-    BlockStmtAST(std::vector<std::shared_ptr<StmtAST>> statements) : statements(statements) {}
+    BlockStmtAST(ASTList<StmtAST*> statements) : StmtAST(NodeKind::BlockStmt), statements(statements) {}
     
     std::string toString() const override {
         std::string result = "{\n";
@@ -635,18 +809,19 @@ struct BlockStmtAST : StmtAST {
         return result;
     }
     std::string getNodeType() const override { return "BlockStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::BlockStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // If statements
 struct IfStmtAST : StmtAST {
-    std::shared_ptr<ExprAST> condition;
-    std::shared_ptr<StmtAST> thenStmt;
-    std::shared_ptr<StmtAST> elseStmt;
+    ExprAST* condition;
+    StmtAST* thenStmt;
+    StmtAST* elseStmt;
     
-    IfStmtAST(std::shared_ptr<ExprAST> condition, std::shared_ptr<StmtAST> thenStmt, 
-              std::shared_ptr<StmtAST> elseStmt = nullptr)
-        : condition(condition), thenStmt(thenStmt), elseStmt(elseStmt) {}
+    IfStmtAST(ExprAST* condition, StmtAST* thenStmt, 
+              StmtAST* elseStmt = nullptr)
+        : StmtAST(NodeKind::IfStmt), condition(condition), thenStmt(thenStmt), elseStmt(elseStmt) {}
     
     std::string toString() const override {
         std::string result = "if (" + condition->toString() + ") " + thenStmt->toString();
@@ -654,34 +829,36 @@ struct IfStmtAST : StmtAST {
         return result;
     }
     std::string getNodeType() const override { return "IfStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::IfStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // While statements
 struct WhileStmtAST : StmtAST {
-    std::shared_ptr<ExprAST> condition;
-    std::shared_ptr<StmtAST> body;
+    ExprAST* condition;
+    StmtAST* body;
     
-    WhileStmtAST(std::shared_ptr<ExprAST> condition, std::shared_ptr<StmtAST> body)
-        : condition(condition), body(body) {}
+    WhileStmtAST(ExprAST* condition, StmtAST* body)
+        : StmtAST(NodeKind::WhileStmt), condition(condition), body(body) {}
     
     std::string toString() const override {
         return "while (" + condition->toString() + ") " + body->toString();
     }
     std::string getNodeType() const override { return "WhileStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::WhileStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // For statements
 struct ForStmtAST : StmtAST {
-    std::shared_ptr<StmtAST> init;
-    std::shared_ptr<ExprAST> condition;
-    std::shared_ptr<StmtAST> update;
-    std::shared_ptr<StmtAST> body;
+    StmtAST* init;
+    ExprAST* condition;
+    StmtAST* update;
+    StmtAST* body;
     
-    ForStmtAST(std::shared_ptr<StmtAST> init, std::shared_ptr<ExprAST> condition,
-               std::shared_ptr<StmtAST> update, std::shared_ptr<StmtAST> body)
-        : init(init), condition(condition), update(update), body(body) {}
+    ForStmtAST(StmtAST* init, ExprAST* condition,
+               StmtAST* update, StmtAST* body)
+        : StmtAST(NodeKind::ForStmt), init(init), condition(condition), update(update), body(body) {}
     
     std::string toString() const override {
         std::string result = "for (";
@@ -695,46 +872,52 @@ struct ForStmtAST : StmtAST {
         return result;
     }
     std::string getNodeType() const override { return "ForStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ForStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // For-in statements (for item in collection)
 struct ForInStmtAST : StmtAST {
-    std::string variable;
-    std::shared_ptr<ExprAST> iterable;
-    std::shared_ptr<StmtAST> body;
+    Identifier variable;
+    ExprAST* iterable;
+    StmtAST* body;
     
-    ForInStmtAST(const std::string& variable, std::shared_ptr<ExprAST> iterable, std::shared_ptr<StmtAST> body)
-        : variable(variable), iterable(iterable), body(body) {}
+    ForInStmtAST(Identifier variable, ExprAST* iterable, StmtAST* body)
+        : StmtAST(NodeKind::ForInStmt), variable(variable), iterable(iterable), body(body) {}
     
     std::string toString() const override {
         return "for " + variable + " in " + iterable->toString() + " " + body->toString();
     }
     std::string getNodeType() const override { return "ForInStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ForInStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Break/Continue statements
 struct BreakStmtAST : StmtAST {
+    BreakStmtAST() : StmtAST(NodeKind::BreakStmt) {}
     std::string toString() const override { return "break;"; }
     std::string getNodeType() const override { return "BreakStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::BreakStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 struct ContinueStmtAST : StmtAST {
+    ContinueStmtAST() : StmtAST(NodeKind::ContinueStmt) {}
     std::string toString() const override { return "continue;"; }
     std::string getNodeType() const override { return "ContinueStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ContinueStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Match statements (Rust-like pattern matching)
 struct MatchStmtAST : StmtAST {
-    std::shared_ptr<ExprAST> value;
-    std::vector<std::pair<std::shared_ptr<ExprAST>, std::shared_ptr<StmtAST>>> arms; // pattern -> body
+    ExprAST* value;
+    ASTList<std::pair<ExprAST*, StmtAST*>> arms; // pattern -> body
     
-    MatchStmtAST(std::shared_ptr<ExprAST> value, 
-                 std::vector<std::pair<std::shared_ptr<ExprAST>, std::shared_ptr<StmtAST>>> arms)
-        : value(value), arms(arms) {}
+    MatchStmtAST(ExprAST* value, 
+                 ASTList<std::pair<ExprAST*, StmtAST*>> arms)
+        : StmtAST(NodeKind::MatchStmt), value(value), arms(arms) {}
     
     std::string toString() const override {
         std::string result = "match " + value->toString() + " {\n";
@@ -745,6 +928,7 @@ struct MatchStmtAST : StmtAST {
         return result;
     }
     std::string getNodeType() const override { return "MatchStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::MatchStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
@@ -752,16 +936,16 @@ struct MatchStmtAST : StmtAST {
 
 // Struct declarations (Rust-like)
 struct StructDeclAST : DeclAST {
-    std::string name;
-    std::vector<std::pair<std::string, std::shared_ptr<TypeInfo>>> fields;
-    std::vector<std::shared_ptr<TypeInfo>> generics;
+    Identifier name;
+    ASTList<std::pair<Identifier, const TypeInfo*>> fields;
+    ASTList<const TypeInfo*> generics;
     bool isPublic = false;
     
-    StructDeclAST(const std::string& name, 
-                  std::vector<std::pair<std::string, std::shared_ptr<TypeInfo>>> fields,
-                  std::vector<std::shared_ptr<TypeInfo>> generics = {},
+    StructDeclAST(Identifier name, 
+                  ASTList<std::pair<Identifier, const TypeInfo*>> fields,
+                  ASTList<const TypeInfo*> generics = {},
                   bool isPublic = false)
-        : name(name), fields(fields), generics(generics), isPublic(isPublic) {}
+        : DeclAST(NodeKind::StructDecl), name(name), fields(fields), generics(generics), isPublic(isPublic) {}
     
     std::string toString() const override {
         std::string result = std::string(isPublic ? "pub " : "") + "struct " + name;
@@ -781,24 +965,25 @@ struct StructDeclAST : DeclAST {
         return result;
     }
     std::string getNodeType() const override { return "StructDecl"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::StructDecl; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Enum declarations (Rust-like)
 struct EnumDeclAST : DeclAST {
-    std::string name;
-    std::vector<std::pair<std::string, std::vector<std::shared_ptr<TypeInfo>>>> variants; // name -> types
-    std::vector<std::shared_ptr<TypeInfo>> generics;
+    std::string_view name;
+    ASTList<std::pair<std::string_view, ASTList<const TypeInfo*>>> variants; // name -> types
+    ASTList<const TypeInfo*> generics;
     bool isPublic = false;
     
-    EnumDeclAST(const std::string& name,
-                std::vector<std::pair<std::string, std::vector<std::shared_ptr<TypeInfo>>>> variants,
-                std::vector<std::shared_ptr<TypeInfo>> generics = {},
+    EnumDeclAST(std::string_view name,
+                ASTList<std::pair<std::string_view, ASTList<const TypeInfo*>>> variants,
+                ASTList<const TypeInfo*> generics = {},
                 bool isPublic = false)
-        : name(name), variants(variants), generics(generics), isPublic(isPublic) {}
+        : DeclAST(NodeKind::EnumDecl), name(name), variants(variants), generics(generics), isPublic(isPublic) {}
     
     std::string toString() const override {
-        std::string result = std::string(isPublic ? "pub " : "") + "enum " + name;
+        std::string result = std::string(isPublic ? "pub " : "") + "enum " + std::string(name);
         if (!generics.empty()) {
             result += "<";
             for (size_t i = 0; i < generics.size(); ++i) {
@@ -809,7 +994,7 @@ struct EnumDeclAST : DeclAST {
         }
         result += " {\n";
         for (const auto& variant : variants) {
-            result += "  " + variant.first;
+            result += "  " + std::string(variant.first);
             if (!variant.second.empty()) {
                 result += "(";
                 for (size_t i = 0; i < variant.second.size(); ++i) {
@@ -824,24 +1009,25 @@ struct EnumDeclAST : DeclAST {
         return result;
     }
     std::string getNodeType() const override { return "EnumDecl"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::EnumDecl; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Trait declarations (Rust-like interfaces)
 struct TraitDeclAST : DeclAST {
-    std::string name;
-    std::vector<std::shared_ptr<DeclAST>> methods;
-    std::vector<std::shared_ptr<TypeInfo>> generics;
+    std::string_view name;
+    ASTList<DeclAST*> methods;
+    ASTList<const TypeInfo*> generics;
     bool isPublic = false;
     
-    TraitDeclAST(const std::string& name,
-                 std::vector<std::shared_ptr<DeclAST>> methods,
-                 std::vector<std::shared_ptr<TypeInfo>> generics = {},
+    TraitDeclAST(std::string_view name,
+                 ASTList<DeclAST*> methods,
+                 ASTList<const TypeInfo*> generics = {},
                  bool isPublic = false)
-        : name(name), methods(methods), generics(generics), isPublic(isPublic) {}
+        : DeclAST(NodeKind::TraitDecl), name(name), methods(methods), generics(generics), isPublic(isPublic) {}
     
     std::string toString() const override {
-        std::string result = std::string(isPublic ? "pub " : "") + "trait " + name;
+        std::string result = std::string(isPublic ? "pub " : "") + "trait " + std::string(name);
         if (!generics.empty()) {
             result += "<";
             for (size_t i = 0; i < generics.size(); ++i) {
@@ -858,21 +1044,22 @@ struct TraitDeclAST : DeclAST {
         return result;
     }
     std::string getNodeType() const override { return "TraitDecl"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::TraitDecl; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Impl blocks (Rust-like implementations)
 struct ImplDeclAST : DeclAST {
-    std::shared_ptr<TypeInfo> targetType;
-    std::shared_ptr<TypeInfo> traitType; // Optional, for trait implementations
-    std::vector<std::shared_ptr<DeclAST>> methods;
-    std::vector<std::shared_ptr<TypeInfo>> generics;
+    const TypeInfo* targetType;
+    const TypeInfo* traitType; // Optional, for trait implementations
+    ASTList<DeclAST*> methods;
+    ASTList<const TypeInfo*> generics;
     
-    ImplDeclAST(std::shared_ptr<TypeInfo> targetType,
-                std::vector<std::shared_ptr<DeclAST>> methods,
-                std::shared_ptr<TypeInfo> traitType = nullptr,
-                std::vector<std::shared_ptr<TypeInfo>> generics = {})
-        : targetType(targetType), traitType(traitType), methods(methods), generics(generics) {}
+    ImplDeclAST(const TypeInfo* targetType,
+                ASTList<DeclAST*> methods,
+                const TypeInfo* traitType = nullptr,
+                ASTList<const TypeInfo*> generics = {})
+        : DeclAST(NodeKind::ImplDecl), targetType(targetType), traitType(traitType), methods(methods), generics(generics) {}
     
     std::string toString() const override {
         std::string result = "impl";
@@ -895,43 +1082,46 @@ struct ImplDeclAST : DeclAST {
         return result;
     }
     std::string getNodeType() const override { return "ImplDecl"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ImplDecl; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Try-catch statements
 struct TryCatchStmtAST : StmtAST {
-    std::shared_ptr<StmtAST> tryBody;
-    std::string exceptionVar;
-    std::shared_ptr<TypeInfo> exceptionType;
-    std::shared_ptr<StmtAST> catchBody;
-    std::shared_ptr<StmtAST> finallyBody;
-    
-    TryCatchStmtAST(std::shared_ptr<StmtAST> tryBody, const std::string& exceptionVar,
-                    std::shared_ptr<TypeInfo> exceptionType, std::shared_ptr<StmtAST> catchBody,
-                    std::shared_ptr<StmtAST> finallyBody = nullptr)
-        : tryBody(tryBody), exceptionVar(exceptionVar), exceptionType(exceptionType),
+    StmtAST* tryBody;
+    std::string_view exceptionVar;
+    const TypeInfo* exceptionType;
+    StmtAST* catchBody;
+    StmtAST* finallyBody;
+    
+    TryCatchStmtAST(StmtAST* tryBody, std::string_view exceptionVar,
+                    const TypeInfo* exceptionType, StmtAST* catchBody,
+                    StmtAST* finallyBody = nullptr)
+        : StmtAST(NodeKind::TryCatchStmt), tryBody(tryBody), exceptionVar(exceptionVar), exceptionType(exceptionType),
           catchBody(catchBody), finallyBody(finallyBody) {}
     
     std::string toString() const override {
         std::string result = "try " + tryBody->toString();
-        result += " catch (" + exceptionVar + ": " + exceptionType->toString() + ") " + catchBody->toString();
+        result += " catch (" + std::string(exceptionVar) + ": " + exceptionType->toString() + ") " + catchBody->toString();
         if (finallyBody) result += " finally " + finallyBody->toString();
         return result;
     }
     std::string getNodeType() const override { return "TryCatchStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::TryCatchStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Throw statements
 struct ThrowStmtAST : StmtAST {
-    std::shared_ptr<ExprAST> exception;
+    ExprAST* exception;
     
-    ThrowStmtAST(std::shared_ptr<ExprAST> exception) : exception(exception) {}
+    ThrowStmtAST(ExprAST* exception) : StmtAST(NodeKind::ThrowStmt), exception(exception) {}
     
     std::string toString() const override {
         return "throw " + exception->toString() + ";";
     }
     std::string getNodeType() const override { return "ThrowStmt"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ThrowStmt; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
@@ -939,13 +1129,13 @@ struct ThrowStmtAST : StmtAST {
 
 // Function parameters
 struct ParameterAST {
-    std::string name;
-    std::shared_ptr<TypeInfo> type;
-    std::shared_ptr<ExprAST> defaultValue;
+    Identifier name;
+    const TypeInfo* type;
+    ExprAST* defaultValue;
     bool isOptional = false;
     
-    ParameterAST(const std::string& name, std::shared_ptr<TypeInfo> type, 
-                 std::shared_ptr<ExprAST> defaultValue = nullptr, bool isOptional = false)
+    ParameterAST(Identifier name, const TypeInfo* type, 
+                 ExprAST* defaultValue = nullptr, bool isOptional = false)
         : name(name), type(type), defaultValue(defaultValue), isOptional(isOptional) {}
     
     std::string toString() const {
@@ -956,26 +1146,62 @@ struct ParameterAST {
     }
 };
 
+struct DeferredBody;
+
+// Produces function bodies that were skipped when the declaration was
+// built: the parser re-parses a token range, the module cache decodes a
+// node range
+class BodySource {
+public:
+    virtual ~BodySource() = default;
+    virtual BlockStmtAST* loadBody(FunctionDeclAST& func, const DeferredBody& range) = 0;
+};
+
+// Where a function body that has not been built yet can be found; the
+// meaning of the range is up to the source
+struct DeferredBody {
+    BodySource* source = nullptr;
+    uint32_t begin = 0;
+    uint32_t end = 0;
+};
+
 // Function declarations
 struct FunctionDeclAST : DeclAST {
-    std::string name;
-    std::vector<ParameterAST> parameters;
-    std::shared_ptr<TypeInfo> returnType;
-    std::shared_ptr<BlockStmtAST> body;
+    Identifier name;
+    ASTList<ParameterAST> parameters;
+    const TypeInfo* returnType;
+    BlockStmtAST* body;
     bool isPublic = false;
     bool isStatic = false;
     bool isVirtual = false;
     bool isOverride = false;
     bool isAsync = false;
     bool isExtern = false;
-    std::string externLang;  // "C", "C++", etc.
+    std::string_view externLang;  // "C", "C++", etc.
+    DeferredBody deferred;        // set while `body` has not been parsed yet
+    // The declaration as written, `fn` through the closing brace, and how
+    // much of it is the signature. Set by the parser; empty for cached ASTs
+    std::string_view sourceText;
+    uint32_t signatureLength = 0;
+    
+    bool hasDeferredBody() const { return deferred.source != nullptr; }
+    
+    // Body of the function, building it first if it was deferred. A body
+    // that fails to build stays deferred, so every later call throws too
+    BlockStmtAST* ensureBody() {
+        if (hasDeferredBody()) {
+            body = deferred.source->loadBody(*this, deferred);
+            deferred = DeferredBody();
+        }
+        return body;
+    }
     
-    FunctionDeclAST(const std::string& name, std::vector<ParameterAST> parameters,
-                    std::shared_ptr<TypeInfo> returnType, std::shared_ptr<BlockStmtAST> body,
+    FunctionDeclAST(Identifier name, ASTList<ParameterAST> parameters,
+                    const TypeInfo* returnType, BlockStmtAST* body,
                     bool isPublic = false, bool isStatic = false, bool isVirtual = false,
                     bool isOverride = false, bool isAsync = false, bool isExtern = false,
-                    const std::string& externLang = "")
-        : name(name), parameters(parameters), returnType(returnType), body(body),
+                    std::string_view externLang = {})
+        : DeclAST(NodeKind::FunctionDecl), name(name), parameters(parameters), returnType(returnType), body(body),
           isPublic(isPublic), isStatic(isStatic), isVirtual(isVirtual), isOverride(isOverride),
           isAsync(isAsync), isExtern(isExtern), externLang(externLang) {}
     
@@ -986,7 +1212,7 @@ struct FunctionDeclAST : DeclAST {
         if (isVirtual) result += "virtual ";
         if (isOverride) result += "override ";
         if (isAsync) result += "async ";
-        if (isExtern) result += "extern \"" + externLang + "\" ";
+        if (isExtern) result += "extern \"" + std::string(externLang) + "\" ";
         
         result += "fn " + name + "(";
         for (size_t i = 0; i < parameters.size(); ++i) {
@@ -997,6 +1223,8 @@ struct FunctionDeclAST : DeclAST {
         
         if (body && !isExtern) {
             result += " " + body->toString();
+        } else if (hasDeferredBody()) {
+            result += " { ... }";
         } else {
             result += ";";
         }
@@ -1004,20 +1232,21 @@ struct FunctionDeclAST : DeclAST {
         return result;
     }
     std::string getNodeType() const override { return "FunctionDecl"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::FunctionDecl; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Class field
 struct FieldDeclAST {
-    std::string name;
-    std::shared_ptr<TypeInfo> type;
-    std::shared_ptr<ExprAST> initializer;
+    std::string_view name;
+    const TypeInfo* type;
+    ExprAST* initializer;
     bool isPublic = false;
     bool isStatic = false;
     bool isConst = false;
     
-    FieldDeclAST(const std::string& name, std::shared_ptr<TypeInfo> type,
-                 std::shared_ptr<ExprAST> initializer = nullptr, bool isPublic = false,
+    FieldDeclAST(std::string_view name, const TypeInfo* type,
+                 ExprAST* initializer = nullptr, bool isPublic = false,
                  bool isStatic = false, bool isConst = false)
         : name(name), type(type), initializer(initializer), isPublic(isPublic),
           isStatic(isStatic), isConst(isConst) {}
@@ -1028,7 +1257,7 @@ struct FieldDeclAST {
         if (isStatic) result += "static ";
         if (isConst) result += "const ";
         
-        result += name + ": " + type->toString();
+        result += std::string(name) + ": " + type->toString();
         if (initializer) result += " = " + initializer->toString();
         return result + ";";
     }
@@ -1038,14 +1267,14 @@ struct FieldDeclAST {
 
 // Import declarations
 struct ImportDeclAST : DeclAST {
-    std::string moduleName;
-    std::string alias;
-    std::vector<std::string> specificImports;
+    std::string_view moduleName;
+    std::string_view alias;
+    ASTList<std::string_view> specificImports;
     bool isWildcard = false;
     
-    ImportDeclAST(const std::string& moduleName, const std::string& alias = "",
-                  std::vector<std::string> specificImports = {}, bool isWildcard = false)
-        : moduleName(moduleName), alias(alias), specificImports(specificImports), isWildcard(isWildcard) {}
+    ImportDeclAST(std::string_view moduleName, std::string_view alias = {},
+                  ASTList<std::string_view> specificImports = {}, bool isWildcard = false)
+        : DeclAST(NodeKind::ImportDecl), moduleName(moduleName), alias(alias), specificImports(specificImports), isWildcard(isWildcard) {}
     
     std::string toString() const override {
         std::string result = "import ";
@@ -1063,29 +1292,30 @@ struct ImportDeclAST : DeclAST {
         }
         
         if (!alias.empty()) {
-            result += " as " + alias;
+            result += " as " + std::string(alias);
         }
         
         if (!moduleName.empty() && (!specificImports.empty() || isWildcard)) {
-            result += " from " + moduleName;
+            result += " from " + std::string(moduleName);
         }
         
         return result + ";";
     }
     std::string getNodeType() const override { return "ImportDecl"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ImportDecl; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Module declaration
 struct ModuleDeclAST : DeclAST {
-    std::string name;
-    std::vector<std::shared_ptr<DeclAST>> declarations;
+    std::string_view name;
+    ASTList<DeclAST*> declarations;
     
-    ModuleDeclAST(const std::string& name, std::vector<std::shared_ptr<DeclAST>> declarations)
-        : name(name), declarations(declarations) {}
+    ModuleDeclAST(std::string_view name, ASTList<DeclAST*> declarations)
+        : DeclAST(NodeKind::ModuleDecl), name(name), declarations(declarations) {}
     
     std::string toString() const override {
-        std::string result = "module " + name + " {\n";
+        std::string result = "module " + std::string(name) + " {\n";
         for (const auto& decl : declarations) {
             result += "  " + decl->toString() + "\n";
         }
@@ -1093,14 +1323,15 @@ struct ModuleDeclAST : DeclAST {
         return result;
     }
     std::string getNodeType() const override { return "ModuleDecl"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ModuleDecl; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // Program (top-level)
 struct ProgramAST : ASTNode {
-    std::vector<std::shared_ptr<DeclAST>> declarations;
+    ASTList<DeclAST*> declarations;
     
-    ProgramAST(std::vector<std::shared_ptr<DeclAST>> declarations) : declarations(declarations) {}
+    ProgramAST(ASTList<DeclAST*> declarations) : ASTNode(NodeKind::Program), declarations(declarations) {}
     
     std::string toString() const override {
         std::string result = "Program:\n";
@@ -1110,6 +1341,7 @@ struct ProgramAST : ASTNode {
         return result;
     }
     std::string getNodeType() const override { return "Program"; }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Program; }
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
@@ -1118,8 +1350,8 @@ struct ProgramAST : ASTNode {
 // Built-in module definitions
 struct BuiltinModule {
     std::string name;
-    std::unordered_map<std::string, std::shared_ptr<TypeInfo>> functions;
-    std::unordered_map<std::string, std::shared_ptr<TypeInfo>> constants;
+    std::unordered_map<std::string, const TypeInfo*> functions;
+    std::unordered_map<std::string, const TypeInfo*> constants;
     
     BuiltinModule(const std::string& name) : name(name) {}
 };
@@ -1135,17 +1367,17 @@ public:
 // Type checking utilities
 bool isNumericType(FlastType type);
 bool isCompatibleType(const TypeInfo& left, const TypeInfo& right);
-std::shared_ptr<TypeInfo> getCommonType(const TypeInfo& left, const TypeInfo& right);
+const TypeInfo* getCommonType(const TypeInfo& left, const TypeInfo& right);
 
 // Built-in method registry
 struct BuiltinMethod {
     std::string name;
-    std::vector<std::shared_ptr<TypeInfo>> paramTypes;
-    std::shared_ptr<TypeInfo> returnType;
+    std::vector<const TypeInfo*> paramTypes;
+    const TypeInfo* returnType;
     bool isUniversal; // Available on all types (like .type())
     
-    BuiltinMethod(const std::string& name, std::vector<std::shared_ptr<TypeInfo>> paramTypes,
-                  std::shared_ptr<TypeInfo> returnType, bool isUniversal = false)
+    BuiltinMethod(const std::string& name, std::vector<const TypeInfo*> paramTypes,
+                  const TypeInfo* returnType, bool isUniversal = false)
         : name(name), paramTypes(paramTypes), returnType(returnType), isUniversal(isUniversal) {}
 };
 
@@ -1153,7 +1385,7 @@ class BuiltinMethods {
 public:
     static std::vector<BuiltinMethod> methods;
     static void initializeBuiltinMethods();
-    static std::shared_ptr<TypeInfo> getMethodReturnType(const std::string& methodName, 
-                                                          const TypeInfo& objectType);
+    static const TypeInfo* getMethodReturnType(const std::string& methodName,
+                                               const TypeInfo& objectType);
     static bool isBuiltinMethod(const std::string& methodName, const TypeInfo& objectType);
 }; 
\ No newline at end of file
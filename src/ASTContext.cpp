@@ -0,0 +1,30 @@
+#include "ASTContext.h"
+#include <algorithm>
+#include <ostream>
+
+void* ASTContext::allocateSlow(size_t size, size_t align) {
+    // Oversized requests get a slab of their own
+    size_t slabSize = std::max(kSlabSize, size + align);
+    slabs.emplace_back(new char[slabSize]);
+    stats.slabs++;
+    stats.bytesReserved += slabSize;
+
+    char* slab = slabs.back().get();
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(slab) + align - 1) & ~(uintptr_t)(align - 1);
+    cursor = reinterpret_cast<char*>(aligned + size);
+    limit = slab + slabSize;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void ASTContext::reset() {
+    slabs.clear();
+    cursor = nullptr;
+    limit = nullptr;
+    stats = Stats();
+}
+
+void ASTContext::printStats(std::ostream& out) const {
+    out << "📊 AST arena: " << stats.allocations << " allocations, "
+        << stats.bytesUsed << " bytes used in " << stats.slabs << " slabs ("
+        << stats.bytesReserved << " bytes reserved)" << std::endl;
+}
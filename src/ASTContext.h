@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fixed-size view of a child list stored in an ASTContext. Lists are built
+// by the parser and never grow afterwards.
+template<typename T>
+class ASTList {
+private:
+    T* items = nullptr;
+    size_t count = 0;
+
+public:
+    ASTList() = default;
+    ASTList(T* items, size_t count) : items(items), count(count) {}
+
+    T* begin() const { return items; }
+    T* end() const { return items + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T& operator[](size_t index) const { return items[index]; }
+    T& front() const { return items[0]; }
+    T& back() const { return items[count - 1]; }
+};
+
+// Bump-pointer arena owning one program's (or one module's) AST: nodes,
+// child lists, type annotations and literal text. Everything placed here
+// must be trivially destructible, so dropping the context frees the whole
+// tree by releasing its slabs without visiting a single node.
+class ASTContext {
+public:
+    struct Stats {
+        size_t allocations = 0;  // objects, lists and strings placed in the arena
+        size_t bytesUsed = 0;
+        size_t slabs = 0;        // heap allocations made by the arena itself
+        size_t bytesReserved = 0;
+    };
+
+private:
+    static constexpr size_t kSlabSize = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> slabs;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    Stats stats;
+
+    void* allocateSlow(size_t size, size_t align);
+
+public:
+    ASTContext() = default;
+    ASTContext(const ASTContext&) = delete;
+    ASTContext& operator=(const ASTContext&) = delete;
+
+    void* allocate(size_t size, size_t align) {
+        stats.allocations++;
+        stats.bytesUsed += size;
+        uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor) + align - 1) & ~(uintptr_t)(align - 1);
+        if (cursor && aligned + size <= reinterpret_cast<uintptr_t>(limit)) {
+            cursor = reinterpret_cast<char*>(aligned + size);
+            return reinterpret_cast<void*>(aligned);
+        }
+        return allocateSlow(size, align);
+    }
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "AST arena objects are never destroyed individually");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Copy a temporary child list (any container with data()/size()) into the arena
+    template<typename Container>
+    auto list(const Container& items) -> ASTList<std::remove_cv_t<std::remove_reference_t<decltype(*items.data())>>> {
+        using T = std::remove_cv_t<std::remove_reference_t<decltype(*items.data())>>;
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "AST arena objects are never destroyed individually");
+        if (items.size() == 0) return ASTList<T>();
+        T* storage = static_cast<T*>(allocate(sizeof(T) * items.size(), alignof(T)));
+        std::uninitialized_copy(items.data(), items.data() + items.size(), storage);
+        return ASTList<T>(storage, items.size());
+    }
+
+    // Copy text into the arena; the view stays valid for the context's lifetime
+    std::string_view string(std::string_view text) {
+        if (text.empty()) return std::string_view();
+        char* storage = static_cast<char*>(allocate(text.size(), 1));
+        std::memcpy(storage, text.data(), text.size());
+        return std::string_view(storage, text.size());
+    }
+
+    // Drop every node at once and start over, e.g. between the declarations
+    // of a streamed file. Views into the old tree must not be used afterwards.
+    void reset();
+
+    const Stats& getStats() const { return stats; }
+    void printStats(std::ostream& out) const;
+};
@@ -0,0 +1,909 @@
+#include "Bytecode.h"
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace bytecode {
+
+const char* getOpName(Op op) {
+    static const char* const names[] = {
+#define FLAST_BYTECODE_NAME(name) #name,
+        FLAST_BYTECODE_OPS(FLAST_BYTECODE_NAME)
+#undef FLAST_BYTECODE_NAME
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(Op::Count), "one name per opcode");
+    return names[static_cast<size_t>(op)];
+}
+
+std::string Program::disassemble() const {
+    std::ostringstream out;
+    for (const auto& function : functions) {
+        out << "func " << function.name << " (" << function.parameters.size() << " parameters, "
+            << function.frameSize << " registers)\n";
+        for (size_t i = 0; i < function.code.size(); i++) {
+            const Instruction& in = function.code[i];
+            out << "  " << i << "\t" << getOpName(in.op) << "\t";
+            switch (in.op) {
+                case Op::LoadInt:
+                case Op::LoadConst:
+                case Op::Call:
+                    out << "r" << in.a << " " << in.bc();
+                    break;
+                case Op::Jump:
+                case Op::JumpIf:
+                case Op::JumpIfNot:
+                    out << "r" << in.a << " -> " << static_cast<int64_t>(i) + 1 + in.bc();
+                    break;
+                case Op::JumpEq: case Op::JumpNe: case Op::JumpLt:
+                case Op::JumpLe: case Op::JumpGt: case Op::JumpGe:
+                    out << "r" << in.a << " r" << in.b << " -> " << static_cast<int64_t>(i) + 1 + in.sc();
+                    break;
+                case Op::AddImm:
+                case Op::AddImm32:
+                    out << "r" << in.a << " r" << in.b << " " << in.sc();
+                    break;
+                default:
+                    out << "r" << in.a << " r" << in.b << " r" << in.c;
+                    break;
+            }
+            out << "\n";
+        }
+    }
+    return out.str();
+}
+
+namespace {
+
+bool isInteger(Kind kind) { return kind >= Kind::Bool && kind <= Kind::I64; }
+bool isNumeric(Kind kind) { return isInteger(kind) || kind == Kind::F64; }
+
+unsigned bitsOf(Kind kind) {
+    switch (kind) {
+        case Kind::Bool: return 1;
+        case Kind::I8: return 8;
+        case Kind::I16: return 16;
+        case Kind::I32: return 32;
+        default: return 64;
+    }
+}
+
+// The register kind CodeGenerator::lowerType gives a declared type
+Kind classify(const TypeInfo* type) {
+    FlastType kind = type->type;
+    if (kind == FlastType::STRUCT) {
+        static const std::unordered_map<Identifier, FlastType> primitiveNames = {
+            {"i8", FlastType::I8}, {"i16", FlastType::I16}, {"int", FlastType::I32},
+            {"i32", FlastType::I32}, {"i64", FlastType::I64},
+            {"u8", FlastType::U8}, {"u16", FlastType::U16}, {"u32", FlastType::U32}, {"u64", FlastType::U64},
+            {"f32", FlastType::F32}, {"double", FlastType::F64}, {"f64", FlastType::F64},
+            {"bool", FlastType::BOOL}, {"char", FlastType::CHAR},
+            {"string", FlastType::STRING}, {"str", FlastType::STR}, {"void", FlastType::VOID}
+        };
+        auto primitive = primitiveNames.find(type->className);
+        if (primitive != primitiveNames.end()) {
+            kind = primitive->second;
+        }
+    }
+
+    switch (kind) {
+        case FlastType::I8:
+        case FlastType::U8:
+        case FlastType::CHAR:
+            return Kind::I8;
+        case FlastType::I16:
+        case FlastType::U16:
+            return Kind::I16;
+        case FlastType::I32:
+        case FlastType::U32:
+            return Kind::I32;
+        case FlastType::I64:
+        case FlastType::U64:
+            return Kind::I64;
+        case FlastType::F64:
+            return Kind::F64;
+        case FlastType::BOOL:
+            return Kind::Bool;
+        case FlastType::STRING:
+        case FlastType::STR:
+            return Kind::Str;
+        case FlastType::VOID:
+            return Kind::Void;
+        case FlastType::F32:
+        case FlastType::STRUCT:
+        case FlastType::SELF:
+            throw std::runtime_error("The interpreter does not support " + type->toString() + " values");
+        default:
+            return Kind::I32;
+    }
+}
+
+const char* kindName(Kind kind) {
+    switch (kind) {
+        case Kind::Void: return "void";
+        case Kind::Bool: return "bool";
+        case Kind::I8: return "i8";
+        case Kind::I16: return "i16";
+        case Kind::I32: return "i32";
+        case Kind::I64: return "i64";
+        case Kind::F64: return "f64";
+        case Kind::Str: return "string";
+    }
+    return "?";
+}
+
+// CodeGenerator passes arguments, stores with `=` and returns values
+// unconverted, and LLVM's verifier rejects the program when one is not of
+// the declared type; refusing it here hands it to the JIT, which says so
+void requireKind(Kind expected, Kind actual, const std::string& what) {
+    if (expected != actual) {
+        throw std::runtime_error(what + " is " + kindName(expected) + " but gets " + kindName(actual) +
+                                 ", which the compiler does not convert");
+    }
+}
+
+bool isComparison(BinaryOp op) {
+    switch (op) {
+        case BinaryOp::Eq: case BinaryOp::Ne: case BinaryOp::StrictEq: case BinaryOp::StrictNe:
+        case BinaryOp::Lt: case BinaryOp::Gt: case BinaryOp::Le: case BinaryOp::Ge:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The opcode applied before storing, for compound assignments; Count for `=`
+BinaryOp assignmentApplies(BinaryOp op) {
+    switch (op) {
+        case BinaryOp::AddAssign: return BinaryOp::Add;
+        case BinaryOp::SubAssign: return BinaryOp::Sub;
+        case BinaryOp::MulAssign: return BinaryOp::Mul;
+        case BinaryOp::DivAssign: return BinaryOp::Div;
+        case BinaryOp::ModAssign: return BinaryOp::Mod;
+        case BinaryOp::PowAssign: return BinaryOp::Pow;
+        case BinaryOp::BitAndAssign: return BinaryOp::BitAnd;
+        case BinaryOp::BitOrAssign: return BinaryOp::BitOr;
+        case BinaryOp::BitXorAssign: return BinaryOp::BitXor;
+        case BinaryOp::ShlAssign: return BinaryOp::Shl;
+        case BinaryOp::ShrAssign: return BinaryOp::Shr;
+        default: return BinaryOp::Count;
+    }
+}
+
+bool isAssignment(BinaryOp op) { return op >= BinaryOp::Assign && op < BinaryOp::Count; }
+
+// Whether evaluating `expr` may store to a local. Calls cannot: functions
+// see only their own frame.
+bool writesLocals(ExprAST* expr) {
+    if (auto* binary = llvm::dyn_cast<BinaryExprAST>(expr)) {
+        return isAssignment(binary->op) || writesLocals(binary->left) || writesLocals(binary->right);
+    }
+    if (auto* unary = llvm::dyn_cast<UnaryExprAST>(expr)) {
+        return unary->op == UnaryOp::PreIncrement || unary->op == UnaryOp::PreDecrement ||
+               writesLocals(unary->operand);
+    }
+    if (auto* call = llvm::dyn_cast<CallExprAST>(expr)) {
+        for (ExprAST* arg : call->args) {
+            if (writesLocals(arg)) return true;
+        }
+    }
+    return false;
+}
+
+// A value in a register. `local` marks a variable's own register, which a
+// later store may change under an operand that still needs the old value.
+struct Operand {
+    uint16_t reg;
+    Kind kind;
+    bool local = false;
+};
+
+constexpr int kAnyRegister = -1;
+
+class FunctionCompiler {
+public:
+    FunctionCompiler(Program& program, const std::unordered_map<Identifier, uint32_t>& index, Function& function)
+        : program(program), index(index), function(function) {}
+
+    void compile(FunctionDeclAST* decl);
+
+private:
+    // Each of these leaves its result in `dest` when one is given, writing
+    // it only once every operand has been read
+    Operand expression(ExprAST* expr, int dest = kAnyRegister);
+    Operand binary(BinaryExprAST* expr, int dest);
+    Operand arithmetic(BinaryOp op, Operand lhs, Operand rhs, int dest);
+    Operand assignment(BinaryExprAST* expr, int dest);
+    Operand logical(BinaryExprAST* expr, int dest);
+    Operand unary(UnaryExprAST* expr, int dest);
+    Operand call(CallExprAST* expr, int dest);
+    Operand convert(Operand value, Kind kind, int dest = kAnyRegister);
+    Operand toBool(Operand value);
+    Operand place(Operand value, int dest);
+    void promote(Operand& lhs, Operand& rhs);
+    void wrap(uint16_t reg, Kind kind);
+
+    void statement(StmtAST* stmt);
+    void branchIf(ExprAST* condition, size_t target, const char* notInteger);
+    Operand lookup(Identifier name);
+
+    uint16_t allocate();
+    uint16_t result(int dest) { return dest == kAnyRegister ? allocate() : static_cast<uint16_t>(dest); }
+    uint16_t loadConstant(Value value, int dest);
+    size_t emit(Op op, uint16_t a = 0, uint16_t b = 0, uint16_t c = 0);
+    size_t emitWide(Op op, uint16_t a, int32_t bc);
+    void patch(size_t jump, size_t target);
+    bool emitShortJump(Op op, uint16_t a, uint16_t b, size_t target);
+
+    Program& program;
+    const std::unordered_map<Identifier, uint32_t>& index;
+    Function& function;
+    // One flat scope per function, as CodeGenerator's namedValues
+    std::unordered_map<Identifier, Operand> locals;
+    uint32_t top = 0;  // first free register
+};
+
+uint16_t FunctionCompiler::allocate() {
+    if (top >= UINT16_MAX) {
+        throw std::runtime_error("Function " + function.name + " needs too many registers for the interpreter");
+    }
+    function.frameSize = std::max(function.frameSize, top + 1);
+    return static_cast<uint16_t>(top++);
+}
+
+uint16_t FunctionCompiler::loadConstant(Value value, int dest) {
+    if (program.constants.size() >= static_cast<size_t>(INT32_MAX)) {
+        throw std::runtime_error("Too many constants for the interpreter");
+    }
+    program.constants.push_back(value);
+    uint16_t out = result(dest);
+    emitWide(Op::LoadConst, out, static_cast<int32_t>(program.constants.size() - 1));
+    return out;
+}
+
+size_t FunctionCompiler::emit(Op op, uint16_t a, uint16_t b, uint16_t c) {
+    function.code.push_back({op, a, b, c});
+    return function.code.size() - 1;
+}
+
+size_t FunctionCompiler::emitWide(Op op, uint16_t a, int32_t bc) {
+    auto value = static_cast<uint32_t>(bc);
+    return emit(op, a, static_cast<uint16_t>(value & 0xffff), static_cast<uint16_t>(value >> 16));
+}
+
+void FunctionCompiler::patch(size_t jump, size_t target) {
+    auto offset = static_cast<uint32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(jump + 1));
+    function.code[jump].b = static_cast<uint16_t>(offset & 0xffff);
+    function.code[jump].c = static_cast<uint16_t>(offset >> 16);
+}
+
+// Compare-and-jump with its offset in C; false when the target is too far
+bool FunctionCompiler::emitShortJump(Op op, uint16_t a, uint16_t b, size_t target) {
+    int64_t offset = static_cast<int64_t>(target) - static_cast<int64_t>(function.code.size() + 1);
+    if (offset < INT16_MIN || offset > INT16_MAX) return false;
+    emit(op, a, b, static_cast<uint16_t>(static_cast<int16_t>(offset)));
+    return true;
+}
+
+Operand FunctionCompiler::place(Operand value, int dest) {
+    if (dest == kAnyRegister || dest == value.reg) return value;
+    emit(Op::Move, static_cast<uint16_t>(dest), value.reg);
+    return {static_cast<uint16_t>(dest), value.kind};
+}
+
+// Brings an integer that may have left its width back into range
+void FunctionCompiler::wrap(uint16_t reg, Kind kind) {
+    if (kind == Kind::Bool) {
+        emit(Op::ZExt, reg, reg, 1);
+    } else if (kind != Kind::I64) {
+        emit(Op::SExt, reg, reg, static_cast<uint16_t>(bitsOf(kind)));
+    }
+}
+
+// The conversions CodeGenerator inserts on declarations and stores:
+// sign-extend or truncate between integers, and sitofp / fptosi
+Operand FunctionCompiler::convert(Operand value, Kind kind, int dest) {
+    if (value.kind == kind) return place(value, dest);
+    if (value.kind == Kind::Void) {
+        throw std::runtime_error("A call that returns nothing cannot be used as a value");
+    }
+    if (kind == Kind::Str || value.kind == Kind::Str || kind == Kind::Void) {
+        throw std::runtime_error("The interpreter cannot convert between strings and numbers");
+    }
+
+    if (isInteger(value.kind) && isInteger(kind) && value.kind != Kind::Bool && bitsOf(kind) > bitsOf(value.kind)) {
+        // Already sign-extended in the register
+        return place({value.reg, kind}, dest);
+    }
+
+    uint16_t out = result(dest);
+    if (value.kind == Kind::Bool) {
+        // An i1 sign-extends: true becomes -1
+        emit(Op::Neg, out, value.reg);
+        if (kind == Kind::F64) emit(Op::IntToFloat, out, out);
+    } else if (kind == Kind::Bool) {
+        emit(value.kind == Kind::F64 ? Op::FloatToInt : Op::Move, out, value.reg);
+        emit(Op::ZExt, out, out, 1);
+    } else if (kind == Kind::F64) {
+        emit(Op::IntToFloat, out, value.reg);
+    } else if (value.kind == Kind::F64) {
+        emit(Op::FloatToInt, out, value.reg);
+        wrap(out, kind);
+    } else {
+        emit(Op::SExt, out, value.reg, static_cast<uint16_t>(bitsOf(kind)));
+    }
+    return {out, kind};
+}
+
+Operand FunctionCompiler::toBool(Operand value) {
+    switch (value.kind) {
+        case Kind::Bool: return value;
+        case Kind::F64: {
+            uint16_t out = allocate();
+            emit(Op::FloatToBool, out, value.reg);
+            return {out, Kind::Bool};
+        }
+        case Kind::Str: {
+            uint16_t out = allocate();
+            emit(Op::StrToBool, out, value.reg);
+            return {out, Kind::Bool};
+        }
+        case Kind::Void:
+            throw std::runtime_error("Value cannot be used as a condition");
+        default: {
+            uint16_t out = allocate();
+            emit(Op::IntToBool, out, value.reg);
+            return {out, Kind::Bool};
+        }
+    }
+}
+
+// Mixed operands meet at the wider integer, or at f64, as in emitBinary
+void FunctionCompiler::promote(Operand& lhs, Operand& rhs) {
+    if (lhs.kind == rhs.kind) return;
+    if (isInteger(lhs.kind) && isInteger(rhs.kind)) {
+        if (bitsOf(lhs.kind) < bitsOf(rhs.kind)) {
+            lhs = convert(lhs, rhs.kind);
+        } else {
+            rhs = convert(rhs, lhs.kind);
+        }
+    } else if (lhs.kind == Kind::F64) {
+        rhs = convert(rhs, Kind::F64);
+    } else {
+        lhs = convert(lhs, Kind::F64);
+    }
+}
+
+Operand FunctionCompiler::lookup(Identifier name) {
+    auto local = locals.find(name);
+    if (local == locals.end()) {
+        throw std::runtime_error("Unknown variable: " + name);
+    }
+    return local->second;
+}
+
+Operand FunctionCompiler::expression(ExprAST* expr, int dest) {
+    switch (expr->kind) {
+        case NodeKind::NumberExpr: {
+            double value = static_cast<NumberExprAST*>(expr)->value;
+            // Whole numbers are i32 when they fit, else i64; the rest f64
+            if (value == std::floor(value) && value >= INT32_MIN && value <= INT32_MAX) {
+                uint16_t out = result(dest);
+                emitWide(Op::LoadInt, out, static_cast<int32_t>(value));
+                return {out, Kind::I32};
+            }
+            Value literal;
+            if (value == std::floor(value) && std::fabs(value) < 9.2e18) {
+                literal.i = static_cast<int64_t>(value);
+                return {loadConstant(literal, dest), Kind::I64};
+            }
+            literal.f = value;
+            return {loadConstant(literal, dest), Kind::F64};
+        }
+        case NodeKind::ScientificExpr: {
+            Value literal;
+            literal.f = static_cast<ScientificExprAST*>(expr)->value;
+            return {loadConstant(literal, dest), Kind::F64};
+        }
+        case NodeKind::StringExpr: {
+            program.strings.emplace_back(static_cast<StringExprAST*>(expr)->value);
+            Value literal;
+            literal.s = program.strings.back().c_str();
+            return {loadConstant(literal, dest), Kind::Str};
+        }
+        case NodeKind::VariableExpr: {
+            static const Identifier exitSuccess("EXIT_SUCCESS");
+            static const Identifier self("self");
+            auto* variable = static_cast<VariableExprAST*>(expr);
+            if (variable->name == exitSuccess) {
+                uint16_t out = result(dest);
+                emitWide(Op::LoadInt, out, 0);
+                return {out, Kind::I32};
+            }
+            if (variable->name == self) {
+                throw std::runtime_error("The interpreter does not support 'self'");
+            }
+            return place(lookup(variable->name), dest);
+        }
+        case NodeKind::BinaryExpr:
+            return binary(static_cast<BinaryExprAST*>(expr), dest);
+        case NodeKind::UnaryExpr:
+            return unary(static_cast<UnaryExprAST*>(expr), dest);
+        case NodeKind::CallExpr:
+            return call(static_cast<CallExprAST*>(expr), dest);
+        case NodeKind::MemberAccessExpr:
+        case NodeKind::MethodCallExpr:
+        case NodeKind::NewExpr:
+            throw std::runtime_error("The interpreter does not support " + expr->getNodeType());
+        default:
+            break;
+    }
+
+    throw std::runtime_error("Unknown expression type");
+}
+
+Operand FunctionCompiler::binary(BinaryExprAST* expr, int dest) {
+    if (isAssignment(expr->op)) {
+        return assignment(expr, dest);
+    }
+    if (expr->op == BinaryOp::LogicalAnd || expr->op == BinaryOp::LogicalOr) {
+        return logical(expr, dest);
+    }
+
+    // The left operand is read before the right one runs
+    Operand lhs = expression(expr->left);
+    if (lhs.local && writesLocals(expr->right)) {
+        lhs = place(lhs, allocate());
+    }
+
+    // Adding or subtracting a small literal needs no register for it
+    auto* literal = llvm::dyn_cast<NumberExprAST>(expr->right);
+    if (literal && (expr->op == BinaryOp::Add || expr->op == BinaryOp::Sub) &&
+        (lhs.kind == Kind::I32 || lhs.kind == Kind::I64) && literal->value == std::floor(literal->value) &&
+        std::fabs(literal->value) <= INT16_MAX) {
+        auto step = static_cast<int16_t>(expr->op == BinaryOp::Add ? literal->value : -literal->value);
+        uint16_t out = result(dest);
+        emit(lhs.kind == Kind::I32 ? Op::AddImm32 : Op::AddImm, out, lhs.reg, static_cast<uint16_t>(step));
+        return {out, lhs.kind};
+    }
+
+    Operand rhs = expression(expr->right);
+    return arithmetic(expr->op, lhs, rhs, dest);
+}
+
+Operand FunctionCompiler::arithmetic(BinaryOp op, Operand lhs, Operand rhs, int dest) {
+    if (op == BinaryOp::Ternary) {
+        throw std::runtime_error("Unsupported binary operator: ?:");
+    }
+    if (!isNumeric(lhs.kind) || !isNumeric(rhs.kind)) {
+        throw std::runtime_error(std::string("Operator '") + getOperatorSpelling(op) + "' needs numeric operands");
+    }
+    promote(lhs, rhs);
+
+    Kind kind = lhs.kind;
+    bool isFloat = kind == Kind::F64;
+    uint16_t out = result(dest);
+
+    // Integer opcode, float opcode (Count when there is none), and whether
+    // the integer result can leave its width
+    struct Lowering { Op integer; Op floating; bool wraps; };
+    auto lowering = [&]() -> Lowering {
+        bool narrow = kind == Kind::I32;
+        switch (op) {
+            case BinaryOp::Add: return {narrow ? Op::Add32 : Op::Add, Op::FAdd, !narrow};
+            case BinaryOp::Sub: return {narrow ? Op::Sub32 : Op::Sub, Op::FSub, !narrow};
+            case BinaryOp::Mul: return {narrow ? Op::Mul32 : Op::Mul, Op::FMul, !narrow};
+            case BinaryOp::Div: return {Op::Div, Op::FDiv, true};
+            case BinaryOp::Mod: return {Op::Rem, Op::FRem, true};
+            case BinaryOp::Shl: return {Op::Shl, Op::Count, true};
+            case BinaryOp::Shr: return {Op::Shr, Op::Count, false};
+            case BinaryOp::UShr: return {Op::UShr, Op::Count, true};
+            case BinaryOp::BitAnd: return {Op::And, Op::Count, false};
+            case BinaryOp::BitOr: return {Op::Or, Op::Count, false};
+            case BinaryOp::BitXor: return {Op::Xor, Op::Count, false};
+            case BinaryOp::Eq: case BinaryOp::StrictEq: return {Op::Eq, Op::FEq, false};
+            case BinaryOp::Ne: case BinaryOp::StrictNe: return {Op::Ne, Op::FNe, false};
+            case BinaryOp::Lt: return {Op::Lt, Op::FLt, false};
+            case BinaryOp::Gt: return {Op::Gt, Op::FGt, false};
+            case BinaryOp::Le: return {Op::Le, Op::FLe, false};
+            case BinaryOp::Ge: return {Op::Ge, Op::FGe, false};
+            case BinaryOp::Spaceship: return {Op::Cmp3, Op::FCmp3, false};
+            default: return {Op::Count, Op::Count, false};
+        }
+    }();
+
+    if (op == BinaryOp::Pow) {
+        // pow on doubles; integer operands round-trip through f64
+        if (isFloat) {
+            emit(Op::FPow, out, lhs.reg, rhs.reg);
+            return {out, kind};
+        }
+        Operand base = convert({lhs.reg, Kind::I64}, Kind::F64);
+        Operand exponent = convert({rhs.reg, Kind::I64}, Kind::F64);
+        emit(Op::FPow, base.reg, base.reg, exponent.reg);
+        emit(Op::FloatToInt, out, base.reg);
+        wrap(out, kind);
+        return {out, kind};
+    }
+
+    Op instruction = isFloat ? lowering.floating : lowering.integer;
+    if (instruction == Op::Count) {
+        throw std::runtime_error(std::string("Operator '") + getOperatorSpelling(op) + "' needs integer operands");
+    }
+
+    if (op == BinaryOp::UShr && kind != Kind::I64) {
+        // A logical shift sees the operand's own width, not the 64-bit register
+        Operand wide = {allocate(), Kind::I64};
+        emit(Op::ZExt, wide.reg, lhs.reg, static_cast<uint16_t>(bitsOf(kind)));
+        lhs = wide;
+    }
+
+    emit(instruction, out, lhs.reg, rhs.reg);
+    if (isComparison(op)) {
+        return {out, Kind::Bool};
+    }
+    if (op == BinaryOp::Spaceship) {
+        return {out, Kind::I32};
+    }
+    if (!isFloat && lowering.wraps) {
+        wrap(out, kind);
+    }
+    return {out, kind};
+}
+
+Operand FunctionCompiler::assignment(BinaryExprAST* expr, int dest) {
+    auto* variable = llvm::dyn_cast<VariableExprAST>(expr->left);
+    if (!variable) {
+        throw std::runtime_error("Invalid assignment target");
+    }
+
+    BinaryOp applies = assignmentApplies(expr->op);
+    Operand target;
+    if (applies == BinaryOp::Count) {
+        target = lookup(variable->name);
+        Operand value = expression(expr->right, target.reg);
+        requireKind(target.kind, value.kind, "Variable " + variable->name);
+    } else {
+        // The right side runs first, then the variable is read
+        Operand value = expression(expr->right);
+        target = lookup(variable->name);
+        Operand result = arithmetic(applies, target, value, target.reg);
+        // Only integers are brought back to the variable's width
+        if (!isInteger(result.kind) || !isInteger(target.kind)) {
+            requireKind(target.kind, result.kind, "Variable " + variable->name);
+        }
+        convert({target.reg, result.kind}, target.kind, target.reg);
+    }
+    return place(target, dest);
+}
+
+Operand FunctionCompiler::logical(BinaryExprAST* expr, int dest) {
+    // Short-circuit: the right operand only runs when it decides the result
+    bool isAnd = expr->op == BinaryOp::LogicalAnd;
+    uint16_t out = allocate();
+    emit(Op::Move, out, toBool(expression(expr->left)).reg);
+    size_t skip = emitWide(isAnd ? Op::JumpIfNot : Op::JumpIf, out, 0);
+    emit(Op::Move, out, toBool(expression(expr->right)).reg);
+    patch(skip, function.code.size());
+    return place({out, Kind::Bool}, dest);
+}
+
+Operand FunctionCompiler::unary(UnaryExprAST* expr, int dest) {
+    switch (expr->op) {
+        case UnaryOp::Neg: {
+            Operand operand = expression(expr->operand);
+            if (!isNumeric(operand.kind)) {
+                throw std::runtime_error("Operator '-' needs a numeric operand");
+            }
+            uint16_t out = result(dest);
+            if (operand.kind == Kind::F64) {
+                emit(Op::FNeg, out, operand.reg);
+            } else {
+                emit(Op::Neg, out, operand.reg);
+                wrap(out, operand.kind);
+            }
+            return {out, operand.kind};
+        }
+        case UnaryOp::Plus:
+            return expression(expr->operand, dest);
+        case UnaryOp::Not: {
+            Operand operand = toBool(expression(expr->operand));
+            uint16_t out = result(dest);
+            emit(Op::Not, out, operand.reg);
+            return {out, Kind::Bool};
+        }
+        case UnaryOp::BitNot: {
+            Operand operand = expression(expr->operand);
+            if (!isInteger(operand.kind)) {
+                throw std::runtime_error("Operator '~' needs an integer operand");
+            }
+            uint16_t out = result(dest);
+            emit(Op::BitNot, out, operand.reg);
+            if (operand.kind == Kind::Bool) wrap(out, operand.kind);
+            return {out, operand.kind};
+        }
+        case UnaryOp::PreIncrement:
+        case UnaryOp::PreDecrement: {
+            auto* variable = llvm::dyn_cast<VariableExprAST>(expr->operand);
+            if (!variable) {
+                throw std::runtime_error("Invalid increment target");
+            }
+            Operand target = lookup(variable->name);
+            int16_t step = expr->op == UnaryOp::PreIncrement ? 1 : -1;
+            if (target.kind == Kind::F64) {
+                Value one;
+                one.f = step;
+                emit(Op::FAdd, target.reg, target.reg, loadConstant(one, kAnyRegister));
+            } else if (isInteger(target.kind)) {
+                bool narrow = target.kind == Kind::I32;
+                emit(narrow ? Op::AddImm32 : Op::AddImm, target.reg, target.reg, static_cast<uint16_t>(step));
+                if (!narrow) wrap(target.reg, target.kind);
+            } else {
+                throw std::runtime_error("Invalid increment target");
+            }
+            return place(target, dest);
+        }
+        default:
+            break;
+    }
+
+    throw std::runtime_error(std::string("Unsupported unary operator: ") + getOperatorSpelling(expr->op));
+}
+
+Operand FunctionCompiler::call(CallExprAST* expr, int dest) {
+    static const Identifier print("print");
+    static const Identifier println("println");
+    if (expr->callee == print || expr->callee == println) {
+        // The builtins hand every argument to printf with a format for the
+        // first one, so only that one shows
+        std::vector<Operand> args;
+        for (ExprAST* arg : expr->args) {
+            args.push_back(expression(arg));
+        }
+        if (args.empty()) {
+            return {0, Kind::Void};
+        }
+        Op op = isInteger(args[0].kind) ? Op::PrintInt : args[0].kind == Kind::F64 ? Op::PrintFloat : Op::PrintString;
+        if (args[0].kind == Kind::Void) {
+            throw std::runtime_error("A call that returns nothing cannot be printed");
+        }
+        uint16_t out = result(dest);
+        emit(op, out, args[0].reg, expr->callee == println);
+        return {out, Kind::I32};
+    }
+
+    auto callee = index.find(expr->callee);
+    if (callee == index.end()) {
+        throw std::runtime_error("Unknown function: " + expr->callee);
+    }
+    const Function& target = program.functions[callee->second];
+    if (target.parameters.size() != expr->args.size()) {
+        throw std::runtime_error("Wrong number of arguments to " + expr->callee);
+    }
+
+    // Arguments go where the callee's frame will start, so nothing is copied
+    uint16_t base = allocate();
+    for (size_t i = 1; i < expr->args.size(); i++) {
+        allocate();
+    }
+    for (size_t i = 0; i < expr->args.size(); i++) {
+        uint16_t reg = static_cast<uint16_t>(base + i);
+        Operand value = expression(expr->args[i], reg);
+        requireKind(target.parameters[i], value.kind,
+                    "Argument " + std::to_string(i + 1) + " of " + expr->callee.str());
+    }
+    emitWide(Op::Call, base, static_cast<int32_t>(callee->second));
+    return place({base, target.result}, dest);
+}
+
+// Jumps to `target` when `condition` holds. Integer comparisons become one
+// compare-and-jump; conditions must be integers, as CodeGenerator requires.
+void FunctionCompiler::branchIf(ExprAST* condition, size_t target, const char* notInteger) {
+    uint32_t mark = top;
+    auto* compare = llvm::dyn_cast<BinaryExprAST>(condition);
+    if (compare && isComparison(compare->op)) {
+        Operand lhs = expression(compare->left);
+        if (lhs.local && writesLocals(compare->right)) {
+            lhs = place(lhs, allocate());
+        }
+        Operand rhs = expression(compare->right);
+        if (isInteger(lhs.kind) && isInteger(rhs.kind)) {
+            promote(lhs, rhs);
+            Op jump;
+            switch (compare->op) {
+                case BinaryOp::Eq: case BinaryOp::StrictEq: jump = Op::JumpEq; break;
+                case BinaryOp::Ne: case BinaryOp::StrictNe: jump = Op::JumpNe; break;
+                case BinaryOp::Lt: jump = Op::JumpLt; break;
+                case BinaryOp::Le: jump = Op::JumpLe; break;
+                case BinaryOp::Gt: jump = Op::JumpGt; break;
+                default: jump = Op::JumpGe; break;
+            }
+            if (emitShortJump(jump, lhs.reg, rhs.reg, target)) {
+                top = mark;
+                return;
+            }
+        }
+        Operand result = arithmetic(compare->op, lhs, rhs, kAnyRegister);
+        patch(emitWide(Op::JumpIf, result.reg, 0), target);
+        top = mark;
+        return;
+    }
+
+    Operand value = expression(condition);
+    if (!isInteger(value.kind)) {
+        throw std::runtime_error(notInteger);
+    }
+    patch(emitWide(Op::JumpIf, value.reg, 0), target);
+    top = mark;
+}
+
+void FunctionCompiler::statement(StmtAST* stmt) {
+    switch (stmt->kind) {
+        case NodeKind::VarDeclStmt: {
+            auto* decl = static_cast<VarDeclStmtAST*>(stmt);
+            uint16_t reg = allocate();
+            Kind kind = decl->type ? classify(decl->type) : Kind::Void;
+            if (decl->initializer) {
+                Operand value = expression(decl->initializer, reg);
+                kind = decl->type ? convert({reg, value.kind}, kind, reg).kind : value.kind;
+            } else {
+                emitWide(Op::LoadInt, reg, 0);
+                if (!decl->type) kind = Kind::I32;
+            }
+            // Bound after the initializer, which still sees any earlier one
+            locals[decl->name] = {reg, kind, true};
+            top = reg + 1u;
+            break;
+        }
+        case NodeKind::ExprStmt: {
+            uint32_t mark = top;
+            expression(static_cast<ExprStmtAST*>(stmt)->expression);
+            top = mark;
+            break;
+        }
+        case NodeKind::ReturnStmt: {
+            auto* ret = static_cast<ReturnStmtAST*>(stmt);
+            uint32_t mark = top;
+            if (!ret->value) {
+                requireKind(function.result, Kind::Void, "The result of " + function.name.str());
+                emit(Op::ReturnVoid);
+            } else {
+                Operand value = expression(ret->value);
+                requireKind(function.result, value.kind, "The result of " + function.name.str());
+                emit(Op::Return, value.reg);
+            }
+            top = mark;
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            // Condition at the bottom: one jump per iteration
+            auto* loop = static_cast<WhileStmtAST*>(stmt);
+            size_t enter = emitWide(Op::Jump, 0, 0);
+            size_t body = function.code.size();
+            statement(loop->body);
+            patch(enter, function.code.size());
+            branchIf(loop->condition, body, "While condition must be boolean or integer");
+            break;
+        }
+        case NodeKind::ForStmt: {
+            auto* loop = static_cast<ForStmtAST*>(stmt);
+            if (loop->init) statement(loop->init);
+            size_t enter = emitWide(Op::Jump, 0, 0);
+            size_t body = function.code.size();
+            statement(loop->body);
+            if (loop->update) statement(loop->update);
+            patch(enter, function.code.size());
+            if (loop->condition) {
+                branchIf(loop->condition, body, "For condition must be boolean or integer");
+            } else {
+                patch(emitWide(Op::Jump, 0, 0), body);
+            }
+            break;
+        }
+        case NodeKind::ForInStmt: {
+            // for i in n: i runs over 0 .. n-1 as an i32; n is read once
+            auto* loop = static_cast<ForInStmtAST*>(stmt);
+            uint16_t limit = allocate();
+            Operand count = expression(loop->iterable, limit);
+            convert({limit, count.kind}, Kind::I32, limit);
+            uint16_t counter = allocate();
+            emitWide(Op::LoadInt, counter, 0);
+            locals[loop->variable] = {counter, Kind::I32, true};
+
+            size_t enter = emitWide(Op::Jump, 0, 0);
+            size_t body = function.code.size();
+            statement(loop->body);
+            emit(Op::AddImm32, counter, counter, 1);
+            patch(enter, function.code.size());
+            if (!emitShortJump(Op::JumpLt, counter, limit, body)) {
+                uint16_t more = allocate();
+                emit(Op::Lt, more, counter, limit);
+                patch(emitWide(Op::JumpIf, more, 0), body);
+                top = more;
+            }
+            break;
+        }
+        case NodeKind::BlockStmt:
+            for (StmtAST* inner : static_cast<BlockStmtAST*>(stmt)->statements) {
+                statement(inner);
+            }
+            break;
+        default:
+            throw std::runtime_error("Unknown statement type");
+    }
+}
+
+void FunctionCompiler::compile(FunctionDeclAST* decl) {
+    for (size_t i = 0; i < decl->parameters.size(); i++) {
+        locals[decl->parameters[i].name] = {allocate(), function.parameters[i], true};
+    }
+
+    BlockStmtAST* body = decl->ensureBody();
+    if (body) {
+        for (StmtAST* stmt : body->statements) {
+            statement(stmt);
+        }
+    }
+    if (body && !body->statements.empty() && llvm::isa<ReturnStmtAST>(body->statements.back())) {
+        return;
+    }
+
+    // Falling off the end returns nothing, or an i32 zero as CodeGenerator
+    // does whatever the declared result
+    if (function.result == Kind::Void) {
+        emit(Op::ReturnVoid);
+    } else {
+        requireKind(function.result, Kind::I32, "The implicit result of " + function.name.str());
+        uint16_t zero = allocate();
+        emitWide(Op::LoadInt, zero, 0);
+        emit(Op::Return, zero);
+    }
+}
+
+} // namespace
+
+Program compile(ProgramAST* ast) {
+    Program program;
+    std::unordered_map<Identifier, uint32_t> index;
+    std::vector<FunctionDeclAST*> bodies;
+
+    static const Identifier mainName("main");
+    for (DeclAST* decl : ast->declarations) {
+        if (llvm::isa<ImportDeclAST>(decl)) {
+            throw std::runtime_error("The interpreter runs single-file programs; this one imports modules");
+        }
+        auto* funcDecl = llvm::dyn_cast<FunctionDeclAST>(decl);
+        if (!funcDecl) continue;
+
+        Function function;
+        function.name = funcDecl->name;
+        for (const auto& param : funcDecl->parameters) {
+            function.parameters.push_back(classify(param.type));
+        }
+        function.result = classify(funcDecl->returnType);
+        function.frameSize = std::max<uint32_t>(1, static_cast<uint32_t>(function.parameters.size()));
+
+        if (funcDecl->name == mainName) {
+            if (!function.parameters.empty()) {
+                throw std::runtime_error("The interpreter runs a main without parameters");
+            }
+            program.main = static_cast<int>(program.functions.size());
+        }
+        program.functions.push_back(std::move(function));
+        bodies.push_back(funcDecl);
+    }
+    if (program.main < 0) {
+        throw std::runtime_error("The program has no main function");
+    }
+
+    // A call resolves only to the function itself or one declared above
+    // it, as in CodeGenerator, where anything else is an unknown function
+    for (size_t i = 0; i < bodies.size(); i++) {
+        index[bodies[i]->name] = static_cast<uint32_t>(i);
+        FunctionCompiler(program, index, program.functions[i]).compile(bodies[i]);
+    }
+    return program;
+}
+
+} // namespace bytecode
@@ -0,0 +1,145 @@
+#pragma once
+#include "AST.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Register bytecode for `flast run --interp`, compiled straight from the
+// AST so a script starts running without LLVM.
+//
+// Every function runs in a frame of 64-bit registers: its parameters
+// first, then one register per local, then temporaries. Instructions name
+// up to three registers, so `a + b * c` is two instructions. Integers are
+// held sign-extended to 64 bits (bools as 0 or 1) and any operation that
+// can leave its type's width is followed by one that wraps it back, which
+// keeps results identical to the LLVM lowering; f64 values are doubles.
+// The bytecode covers what CodeGenerator lowers for single-file programs,
+// and converts values only where CodeGenerator does (declarations, operands
+// of mixed width, compound assignments of integers). An argument, `=` or
+// return of another type than declared, which LLVM's verifier rejects, is
+// refused at compile time like anything outside that subset.
+namespace bytecode {
+
+union Value {
+    int64_t i;
+    double f;
+    const char* s;
+};
+
+// Every opcode once, with its operands. A, B and C are registers unless
+// noted; BC is B and C read together as a signed 32-bit immediate, and
+// jump offsets count from the instruction after the jump.
+#define FLAST_BYTECODE_OPS(X) \
+    X(Move)         /* A = B */                                   \
+    X(LoadInt)      /* A = BC */                                  \
+    X(LoadConst)    /* A = constants[BC] */                       \
+    X(Add)          /* A = B + C, wrapping at 64 bits */          \
+    X(Sub)                                                        \
+    X(Mul)                                                        \
+    X(Add32)        /* A = B + C, wrapping at 32 bits */          \
+    X(Sub32)                                                      \
+    X(Mul32)                                                      \
+    X(AddImm)       /* A = B + C, C a signed 16-bit immediate */  \
+    X(AddImm32)                                                   \
+    X(Div)          /* signed; throws on a zero divisor */        \
+    X(Rem)                                                        \
+    X(Shl)                                                        \
+    X(Shr)          /* arithmetic */                              \
+    X(UShr)         /* logical; B must be zero-extended first */  \
+    X(And)                                                        \
+    X(Or)                                                         \
+    X(Xor)                                                        \
+    X(Neg)                                                        \
+    X(Not)          /* A = (B == 0) */                            \
+    X(IntToBool)    /* A = (B != 0) */                            \
+    X(BitNot)                                                     \
+    X(SExt)         /* A = B sign-extended from C bits */         \
+    X(ZExt)         /* A = B zero-extended from C bits */         \
+    X(Eq)           /* A = (B == C) as 0 or 1, likewise below */  \
+    X(Ne)                                                         \
+    X(Lt)                                                         \
+    X(Le)                                                         \
+    X(Gt)                                                         \
+    X(Ge)                                                         \
+    X(Cmp3)         /* A = (B > C) - (B < C) */                   \
+    X(FAdd)                                                       \
+    X(FSub)                                                       \
+    X(FMul)                                                       \
+    X(FDiv)                                                       \
+    X(FRem)                                                       \
+    X(FPow)                                                       \
+    X(FNeg)                                                       \
+    X(FEq)          /* ordered comparisons, false on NaN */       \
+    X(FNe)                                                        \
+    X(FLt)                                                        \
+    X(FLe)                                                        \
+    X(FGt)                                                        \
+    X(FGe)                                                        \
+    X(FCmp3)                                                      \
+    X(IntToFloat)                                                 \
+    X(FloatToInt)                                                 \
+    X(FloatToBool)  /* A = (B != 0.0) */                          \
+    X(StrToBool)    /* A = (B != null) */                         \
+    X(Jump)         /* ip += BC */                                \
+    X(JumpIf)       /* if A != 0: ip += BC */                     \
+    X(JumpIfNot)    /* if A == 0: ip += BC */                     \
+    X(JumpEq)       /* if A == B: ip += C, C a signed 16 bits */  \
+    X(JumpNe)                                                     \
+    X(JumpLt)                                                     \
+    X(JumpLe)                                                     \
+    X(JumpGt)                                                     \
+    X(JumpGe)                                                     \
+    X(Call)         /* functions[BC], arguments from A; result in A */ \
+    X(Return)       /* returns A */                               \
+    X(ReturnVoid)                                                 \
+    X(PrintInt)     /* printf B; C != 0 adds a newline; A = printf's result */ \
+    X(PrintFloat)                                                 \
+    X(PrintString)
+
+enum class Op : uint16_t {
+#define FLAST_BYTECODE_ENUM(name) name,
+    FLAST_BYTECODE_OPS(FLAST_BYTECODE_ENUM)
+#undef FLAST_BYTECODE_ENUM
+    Count
+};
+
+const char* getOpName(Op op);
+
+struct Instruction {
+    Op op;
+    uint16_t a = 0;
+    uint16_t b = 0;
+    uint16_t c = 0;
+
+    int32_t bc() const { return static_cast<int32_t>(static_cast<uint32_t>(b) | static_cast<uint32_t>(c) << 16); }
+    int16_t sc() const { return static_cast<int16_t>(c); }
+};
+static_assert(sizeof(Instruction) == 8, "eight bytes per instruction");
+
+// What a register holds, as far as the compiler knows
+enum class Kind : uint8_t { Void, Bool, I8, I16, I32, I64, F64, Str };
+
+struct Function {
+    Identifier name;
+    std::vector<Instruction> code;
+    std::vector<Kind> parameters;
+    Kind result = Kind::Void;
+    uint32_t frameSize = 1;  // registers, at least one for the result
+};
+
+struct Program {
+    std::vector<Function> functions;
+    std::vector<Value> constants;
+    std::deque<std::string> strings;  // string constants point into these
+    int main = -1;
+
+    // One line per instruction, for debugging the compiler
+    std::string disassemble() const;
+};
+
+// Throws std::runtime_error for programs the bytecode does not cover:
+// imports, structs used as values, f32, or the type mismatches above
+Program compile(ProgramAST* program);
+
+} // namespace bytecode
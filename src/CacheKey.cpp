@@ -0,0 +1,69 @@
+#include "CacheKey.h"
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/xxhash.h>
+#include <cstdio>
+
+std::string CacheKey::digest(std::string_view bytes) {
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx",
+                  static_cast<unsigned long long>(llvm::xxHash64(llvm::StringRef(bytes.data(), bytes.size()))));
+    return hex;
+}
+
+void CacheKey::add(std::string name, std::string value) {
+    fields.emplace_back(std::move(name), std::move(value));
+}
+
+const std::string* CacheKey::get(std::string_view name) const {
+    for (const auto& field : fields) {
+        if (field.first == name) return &field.second;
+    }
+    return nullptr;
+}
+
+std::string CacheKey::hash() const {
+    return digest(serialize());
+}
+
+std::string CacheKey::serialize() const {
+    std::string text;
+    for (const auto& field : fields) {
+        text += field.first;
+        text += ' ';
+        text += field.second;
+        text += '\n';
+    }
+    return text;
+}
+
+CacheKey CacheKey::parse(std::string_view manifest) {
+    CacheKey key;
+    while (!manifest.empty()) {
+        size_t end = manifest.find('\n');
+        std::string_view line = manifest.substr(0, end);
+        manifest = end == std::string_view::npos ? std::string_view() : manifest.substr(end + 1);
+
+        size_t space = line.find(' ');
+        if (space == std::string_view::npos) continue;
+        key.add(std::string(line.substr(0, space)), std::string(line.substr(space + 1)));
+    }
+    return key;
+}
+
+std::vector<std::string> CacheKey::differences(const CacheKey& previous) const {
+    std::vector<std::string> changes;
+    for (const auto& field : fields) {
+        const std::string* old = previous.get(field.first);
+        if (!old) {
+            changes.push_back(field.first + " added (" + field.second + ")");
+        } else if (*old != field.second) {
+            changes.push_back(field.first + " changed (" + *old + " -> " + field.second + ")");
+        }
+    }
+    for (const auto& field : previous.fields) {
+        if (!get(field.first)) {
+            changes.push_back(field.first + " dropped (" + field.second + ")");
+        }
+    }
+    return changes;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Key of a build-cache entry: an ordered list of named inputs hashed
+// together. Large inputs (source text, nested keys) enter as their digest.
+// The field list itself is saved next to the entry as a manifest, so a miss
+// can be explained by the fields that differ from the previous build.
+//
+// Digests are xxHash64: content-based, so they survive checkouts that reset
+// mtimes, and identical on every standard library, unlike std::hash.
+class CacheKey {
+private:
+    std::vector<std::pair<std::string, std::string>> fields;
+
+public:
+    // 16 lowercase hex digits
+    static std::string digest(std::string_view bytes);
+
+    void add(std::string name, std::string value);
+    const std::string* get(std::string_view name) const;
+
+    // Digest of every field, names included
+    std::string hash() const;
+
+    // One "name value" line per field, and back
+    std::string serialize() const;
+    static CacheKey parse(std::string_view manifest);
+
+    // "<name> changed (old -> new)" for each field that differs from
+    // `previous`, in field order, plus added and dropped fields
+    std::vector<std::string> differences(const CacheKey& previous) const;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "AST.h"
+#include "CacheKey.h"
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
@@ -11,21 +12,106 @@
 #include <llvm/IR/GlobalVariable.h>
 #include <llvm/IR/DIBuilder.h>
 #include <llvm/Support/raw_ostream.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <unordered_map>
 #include <memory>
 #include <filesystem>
 #include <functional>
 
+class Parser;
+class ModuleCacheReader;
+
+namespace llvm {
+class TargetMachine;
+}
+
 class CodeGenerator {
+public:
+    // What a streamed compilation kept resident, for --max-memory
+    struct StreamStats {
+        size_t declarations = 0;
+        size_t largestDeclarationBytes = 0;  // AST arena bytes of the biggest declaration
+        size_t objectChunks = 0;             // partial objects flushed to the cache
+    };
+    
+    // Lowered functions are written out once the module holds this many
+    // instructions, so a streamed build never keeps the whole file's IR
+    static constexpr size_t kStreamFlushInstructions = 32768;
+    
+    // What an incremental build reused, for --explain-cache
+    struct IncrementalStats {
+        size_t functions = 0;
+        size_t partitions = 0;
+        size_t reusedPartitions = 0;
+        size_t loweredFunctions = 0;
+    };
+    
+    // An incremental build cuts the program into partitions of consecutive
+    // functions after every function whose name hash has these bits set
+    // (64 functions on average). Boundaries depend on names only, so editing
+    // a body never moves them and inserting a function moves one.
+    static constexpr uint64_t kPartitionBoundaryMask = 63;
+    
+    // IR optimisation level: the new pass manager's default pipelines, with
+    // a matching CodeGenOpt level for instruction selection
+    enum class OptLevel { O0, O1, O2, O3, Os, Oz };
+    
+    // "0", "1", "2", "3", "s" or "z"; false for anything else
+    static bool parseOptLevel(const std::string& text, OptLevel& level);
+    static const char* optLevelName(OptLevel level);
+    
+    // Expands "native" in --target-cpu/--target-features to the host's CPU
+    // and feature set (a native CPU brings its features along unless some
+    // are given) and writes features as "+name"/"-name". Throws for a CPU
+    // the target does not know.
+    static void resolveTarget(std::string& cpu, std::string& features);
+    
+    // Makes `path` name an indexed profile for --profile-use, merging a raw
+    // .profraw into the project's .build/cache first, and returns the
+    // profile's digest. Throws when the file is not a readable profile.
+    static std::string loadProfile(std::string& path, const std::filesystem::path& projectRoot);
+    
+    // The object --profile-generate links into the program, which is
+    // installed next to the binary running the compiler. Throws, naming
+    // where it looked, when it is not there.
+    static std::string findProfileRuntime();
+    
+    // --lto: objects hold bitcode (with a ThinLTO summary for Thin) and the
+    // linker optimises them together
+    enum class LTOMode { None, Thin, Full };
+    
+    // Flags that change generated code; all of them are part of every
+    // module's cache key
+    struct BuildOptions {
+        bool debugMode = true;
+        OptLevel optLevel = OptLevel::O0;
+        std::string targetCPU = "generic";
+        std::string targetFeatures;  // "+avx2,-fma"; empty for the CPU's own set
+        LTOMode lto = LTOMode::None;
+        std::string profileGenerate;  // .profraw the instrumented program writes
+        std::string profileUse;       // indexed profile for branch weights and entry counts
+        std::string profileDigest;    // of profileUse, from loadProfile
+        
+        bool optimized() const { return optLevel != OptLevel::O0; }
+        std::string cacheKey() const;
+    };
+    
+    // Runs the pass pipeline `options` ask for (none at -O0 without a
+    // profile) on `module`, which targets `targetMachine`
+    static void optimizeModule(llvm::Module& module, llvm::TargetMachine& targetMachine,
+                               const BuildOptions& options);
+    
 private:
-    std::unique_ptr<llvm::LLVMContext> context;
+    std::unique_ptr<llvm::LLVMContext> ownedContext;  // until takeModule or takeUnit hands it on
+    llvm::LLVMContext* context;
+    llvm::orc::ThreadSafeContext sessionContext;      // shared by the units of a REPL session
     std::unique_ptr<llvm::Module> module;
     std::unique_ptr<llvm::IRBuilder<>> builder;
     std::unique_ptr<llvm::DIBuilder> debugBuilder;
     
     // Builtin system
-    std::unordered_map<std::string, std::function<llvm::Value*(const std::vector<llvm::Value*>&)>> builtinFunctions;
-    std::unordered_map<std::string, std::unordered_map<std::string, std::function<llvm::Value*(llvm::Value*, const std::vector<llvm::Value*>&)>>> builtinMethods;
+    std::unordered_map<Identifier, std::function<llvm::Value*(const std::vector<llvm::Value*>&)>> builtinFunctions;
+    std::unordered_map<std::string, std::unordered_map<Identifier, std::function<llvm::Value*(llvm::Value*, const std::vector<llvm::Value*>&)>>> builtinMethods;
     
     // Project structure
     std::filesystem::path projectRoot;
@@ -38,17 +124,49 @@ private:
     llvm::DIFile* debugFile;
     
     // Symbol tables
-    std::unordered_map<std::string, llvm::Value*> namedValues;
-    std::unordered_map<std::string, llvm::Function*> functions;
-    std::unordered_map<std::string, llvm::StructType*> structs;
+    std::unordered_map<Identifier, llvm::Value*> namedValues;
+    std::unordered_map<Identifier, llvm::Function*> functions;
+    std::unordered_map<Identifier, llvm::FunctionType*> flushedFunctions; // Defined in an earlier object chunk
+    std::unordered_map<Identifier, llvm::StructType*> structs; // Opaque until the declaration is seen
+    std::unordered_map<const TypeInfo*, llvm::Type*> llvmTypes; // Canonical TypeInfo -> lowered type
     
     // Module system
-    std::unordered_map<std::string, std::shared_ptr<ProgramAST>> moduleCache;
+    std::unordered_map<std::string, ProgramAST*> moduleCache;
+    std::unordered_map<std::string, std::unique_ptr<ASTContext>> moduleContexts; // Arenas owning module ASTs
+    std::unordered_map<std::string, std::unique_ptr<Parser>> moduleParsers; // Kept alive to parse deferred bodies
+    std::unordered_map<std::string, std::unique_ptr<ModuleCacheReader>> moduleCacheReaders; // Same, for cached ASTs
     std::unordered_map<std::string, std::filesystem::path> moduleCachePaths; // Track cache paths for each module
     std::unordered_map<std::string, std::string> moduleObjectFiles; // Track object files for each module
+    std::vector<llvm::orc::ThreadSafeModule> jitModules; // Imported modules, lowered in memory for the JIT
+    std::unordered_map<std::string, CacheKey> moduleSourceKeys; // Inputs of the module's AST
+    std::unordered_map<std::string, CacheKey> moduleKeys; // Inputs of the module's object, imports included
+    std::unordered_map<std::string, ProgramAST*> moduleInterfaces; // What importers see of each module
+    std::unordered_map<std::string, std::unique_ptr<ASTContext>> moduleInterfaceContexts;
+    std::unordered_map<std::string, std::unique_ptr<ModuleCacheReader>> moduleInterfaceReaders;
+    std::unordered_map<std::string, std::string> moduleInterfaceHashes; // Digest of each .flsi
+    BuildOptions buildOptions;
+    bool explainCache = false;
+    bool cleanCache = false;
+    std::string linker = "auto";
+    bool jitMode = false;
     std::filesystem::path currentSourceDir;
     std::vector<std::string> missingModules; // Track missing modules for reporting
     
+    // Streaming state
+    std::string moduleStem;
+    bool streaming = false;
+    size_t pendingInstructions = 0;
+    std::vector<std::string> mainObjectChunks; // Flushed by a streamed build, or an incremental build's partitions
+    StreamStats streamStats;
+    
+    // Incremental state: the program's functions in order, and while this
+    // generator lowers one partition, the build it belongs to
+    std::vector<FunctionDeclAST*> programFunctions;
+    std::unordered_map<Identifier, size_t> programFunctionIndex;
+    const CodeGenerator* partitionOwner = nullptr;
+    size_t partitionBegin = 0;
+    IncrementalStats incrementalStats;
+    
     // Built-in functions
     llvm::Function* printlnFunc;
     llvm::Function* mallocFunc;
@@ -57,32 +175,47 @@ private:
     void setupProjectStructure(const std::string& sourceFile);
     void createBuiltinFunctions();
     void setupDebugInfo(const std::string& sourceFile);
-    llvm::Type* getFlastType(const std::string& typeName);
+    llvm::Type* getFlastType(const TypeInfo* type);
+    llvm::Type* lowerType(const TypeInfo* type);
+    llvm::StructType* getStructType(Identifier name);
+    void defineStruct(StructDeclAST* structDecl);
+    llvm::Function* lookupFunction(Identifier name);
+    // Stack slot in the current function's entry block, where it is
+    // allocated once per call and mem2reg/SROA can promote it
+    llvm::AllocaInst* createEntryBlockAlloca(llvm::Type* type, llvm::StringRef name);
+    void flushModule();
     
     // Builtin system methods
     void registerBuiltinFunctions();
     void registerBuiltinMethods();
-    llvm::Value* callBuiltinFunction(const std::string& name, const std::vector<llvm::Value*>& args);
-    llvm::Value* callBuiltinMethod(const std::string& type, const std::string& method, llvm::Value* object, const std::vector<llvm::Value*>& args);
+    llvm::Value* callBuiltinFunction(Identifier name, const std::vector<llvm::Value*>& args);
+    llvm::Value* callBuiltinMethod(const std::string& type, Identifier method, llvm::Value* object, const std::vector<llvm::Value*>& args);
     std::string getTypeName(llvm::Value* value);
     
     // Code generation methods
     llvm::Value* codegen(ExprAST* expr);
     llvm::Value* codegen(StmtAST* stmt);
+    llvm::FunctionType* getFunctionType(FunctionDeclAST* func);
     llvm::Function* codegen(FunctionDeclAST* func);
 
     void codegen(ImportDeclAST* importDecl);
     
     // Module loading
-    std::string resolveModulePath(const std::string& importPath, const std::string& currentDir);
-    std::shared_ptr<ProgramAST> loadModule(const std::string& modulePath);
-    void processImportedFunctions(std::shared_ptr<ProgramAST> module, const std::vector<std::string>& specificImports, bool isWildcard);
+    std::string resolveModulePath(const std::string& importPath, const std::string& currentDir,
+                                  bool reportMissing = true);
+    ProgramAST* loadModule(const std::string& modulePath);
+    void processImportedFunctions(ProgramAST* module, const ASTList<std::string_view>& specificImports, bool isWildcard,
+                                  bool announce = true);
     
     llvm::Value* codegenNumber(NumberExprAST* expr);
     llvm::Value* codegenScientific(ScientificExprAST* expr);
     llvm::Value* codegenString(StringExprAST* expr);
     llvm::Value* codegenVariable(VariableExprAST* expr);
     llvm::Value* codegenBinary(BinaryExprAST* expr);
+    llvm::Value* codegenUnary(UnaryExprAST* expr);
+    llvm::Value* codegenLogical(BinaryExprAST* expr);
+    llvm::Value* emitBinary(BinaryOp op, llvm::Value* lhs, llvm::Value* rhs);
+    llvm::Value* toBool(llvm::Value* value);
     llvm::Value* codegenCall(CallExprAST* expr);
     llvm::Value* codegenMemberAccess(MemberAccessExprAST* expr);
     llvm::Value* codegenMethodCall(MethodCallExprAST* expr);
@@ -98,26 +231,87 @@ private:
     llvm::Value* codegenBlock(BlockStmtAST* blockStmt);
     
     // Module-specific caching
+    ProgramAST* loadModuleAST(const std::string& modulePath);
+    ProgramAST* loadModuleInterface(const std::string& modulePath);
+    std::string getModuleInterfaceFileName(const std::string& modulePath);
+    const CacheKey& getModuleSourceKey(const std::string& modulePath);
+    const CacheKey& getModuleKey(const std::string& modulePath);
+    void explainCacheLookup(const std::string& modulePath, const std::filesystem::path& entry,
+                            const CacheKey& key, bool hit);
+    void recordCacheEntry(const std::filesystem::path& entry, const CacheKey& key);
     std::string getModuleCacheFileName(const std::string& modulePath);
     std::filesystem::path getModuleCacheDir(const std::string& modulePath);
     void createModuleCacheStructure(const std::string& modulePath);
-    bool isModuleCacheValid(const std::string& modulePath);
-    void saveModuleCache(const std::string& modulePath, std::shared_ptr<ProgramAST> moduleAst);
-    std::shared_ptr<ProgramAST> loadModuleFromCache(const std::string& modulePath);
+    // The module's cached AST, or nullptr when it is missing or does not validate
+    std::unique_ptr<ModuleCacheReader> openModuleCache(const std::string& modulePath);
+    void saveModuleCache(const std::string& modulePath, ProgramAST* moduleAst);
+    ProgramAST* loadModuleFromCache(const std::string& modulePath);
     
     // Module object file generation
     std::string getModuleObjectFileName(const std::string& modulePath);
-    void generateModuleObjectFile(const std::string& modulePath, std::shared_ptr<ProgramAST> moduleAst);
+    void generateModuleObjectFile(const std::string& modulePath, ProgramAST* moduleInterface);
+    void lowerModule(const CodeGenerator& importer, const std::string& modulePath, ProgramAST* moduleAst,
+                     const std::string& objectFile);
+    void importFunction(FunctionDeclAST* funcDecl);
+    llvm::Function* declareFunction(FunctionDeclAST* funcDecl);
+    
+    // Incremental builds
+    std::string fingerprintFunction(size_t index, const std::vector<std::string>& signatureDigests);
+    void lowerPartition(const CodeGenerator& owner, ProgramAST* program, size_t begin, size_t end,
+                        const std::string& objectFile);
     bool isModuleObjectValid(const std::string& modulePath);
     std::vector<std::string> collectModuleObjectFiles();
     
+    // Object emission
+    std::unique_ptr<llvm::TargetMachine> createTargetMachine();
+    
     // Missing modules reporting
     void reportMissingModules();
     
 public:
     CodeGenerator();
+    ~CodeGenerator();
+    void setBuildOptions(const BuildOptions& options) { buildOptions = options; }
+    // Print why each imported module's cache entries hit or missed
+    void setExplainCache(bool enabled) { explainCache = enabled; }
+    // Empty .build/cache once the project's paths are known
+    void setCleanCache(bool enabled) { cleanCache = enabled; }
+    // Linker for writeExecutable, as accepted by Linker::link
+    void setLinker(const std::string& name) { linker = name; }
+    // Lower imported modules into memory for takeImportedModules instead of
+    // writing (or reusing) their cached objects
+    void setJITMode(bool enabled) { jitMode = enabled; }
     void generateCode(ProgramAST* program, const std::string& sourceFile);
+    // Streaming variant: lowers each declaration as `parser` produces it and
+    // resets `declarations` (the parser's arena) after every one
+    void generateCode(Parser& parser, ASTContext& declarations, const std::string& sourceFile);
+    const StreamStats& getStreamStats() const { return streamStats; }
+    // Variant for executables: lowers the program's functions in partitions
+    // and reuses each partition's cached object while its fingerprint holds
+    void generateCodeIncremental(ProgramAST* program, const std::string& sourceFile);
+    const IncrementalStats& getIncrementalStats() const { return incrementalStats; }
+    
+    // Building blocks of both variants
+    void beginModule(const std::string& sourceFile);
+    void generateDeclaration(DeclAST* decl);
+    void finishModule();
+    
     void printIR();
+    // Hands the module over with its context, unoptimised: the JIT runs the
+    // pipeline on what it compiles. The generator cannot lower anything
+    // afterwards.
+    llvm::orc::ThreadSafeModule takeModule();
+    // In JIT mode, every module the program imports, taken the same way
+    std::vector<llvm::orc::ThreadSafeModule> takeImportedModules() { return std::move(jitModules); }
+    
+    // REPL units: takeUnit hands over what was lowered since the last unit,
+    // sharing one context with every other unit, and starts a new module in
+    // which earlier functions are reached through declarations;
+    // discardUnit drops it instead, after an error
+    llvm::orc::ThreadSafeModule takeUnit();
+    void discardUnit();
+    // Whether a function lowered in an earlier unit returns nothing
+    bool isVoidFunction(Identifier name) const;
     void writeObjectFile(const std::string& filename);
     std::string writeExecutable(const std::string& sourceFile, bool debugMode = true, bool optimized = false);
     void cleanupCache();
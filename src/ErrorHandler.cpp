@@ -1,4 +1,5 @@
 #include "ErrorHandler.h"
+#include "SourceManager.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
@@ -171,6 +172,13 @@ ErrorContext ErrorHandler::createContext(const std::string& fileName, int line,
     ErrorContext context(fileName, line, column);
     context.lineContent = lineContent;
     context.tokenValue = tokenValue;
+    
+    // Fill in the offending line from the source manager's line table
+    if (lineContent.empty() && !fileName.empty()) {
+        if (FileId file = g_sourceManager.findFile(fileName)) {
+            context.lineContent = std::string(g_sourceManager.getLineText(file, line));
+        }
+    }
     return context;
 }
 
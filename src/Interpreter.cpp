@@ -0,0 +1,201 @@
+#include "Interpreter.h"
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FLAST_THREADED_DISPATCH 1
+#endif
+
+using namespace bytecode;
+
+namespace {
+
+uint64_t bits(int64_t value) { return static_cast<uint64_t>(value); }
+
+// fptosi on x86: out-of-range and NaN give the smallest integer
+int64_t floatToInt(double value) {
+    return value >= -9223372036854775808.0 && value < 9223372036854775808.0 ? static_cast<int64_t>(value) : INT64_MIN;
+}
+
+} // namespace
+
+Interpreter::Interpreter(const Program& program, size_t registers)
+    : program(program), registers(new Value[registers]), registerCount(registers) {}
+
+int Interpreter::runMain() {
+    if (program.main < 0) {
+        throw std::runtime_error("Cannot run the program: it has no main");
+    }
+    int64_t result = execute(program.functions[program.main]);
+    std::fflush(stdout);
+    return program.functions[program.main].result == Kind::Void ? 0 : static_cast<int>(result);
+}
+
+int64_t Interpreter::execute(const Function& entry) {
+    struct Frame {
+        const Instruction* resume;
+        Value* base;
+        const Function* function;
+    };
+    std::vector<Frame> frames;
+    frames.reserve(64);
+
+    const Function* functions = program.functions.data();
+    const Value* constants = program.constants.data();
+    const Function* function = &entry;
+    Value* base = registers.get();
+    Value* const end = base + registerCount;
+    const Instruction* ip = entry.code.data();
+    const Instruction* in;
+
+    auto overflow = [&]() {
+        return std::runtime_error("Stack overflow in " + function->name + " (" + std::to_string(frames.size()) +
+                                  " calls deep)");
+    };
+    auto divisionByZero = [&]() { return std::runtime_error("Integer division by zero in " + function->name); };
+    if (base + entry.frameSize > end) throw overflow();
+
+#define A base[in->a]
+#define B base[in->b]
+#define C base[in->c]
+
+#if FLAST_THREADED_DISPATCH
+    static const void* const dispatch[] = {
+#define FLAST_BYTECODE_LABEL(name) &&op_##name,
+        FLAST_BYTECODE_OPS(FLAST_BYTECODE_LABEL)
+#undef FLAST_BYTECODE_LABEL
+    };
+#define OP(name) op_##name:
+#define NEXT() do { in = ip++; goto *dispatch[static_cast<size_t>(in->op)]; } while (0)
+    NEXT();
+#else
+#define OP(name) case Op::name:
+#define NEXT() continue
+    for (;;) {
+        in = ip++;
+        switch (in->op) {
+#endif
+
+    OP(Move) A = B; NEXT();
+    OP(LoadInt) A.i = in->bc(); NEXT();
+    OP(LoadConst) A = constants[in->bc()]; NEXT();
+
+    OP(Add) A.i = static_cast<int64_t>(bits(B.i) + bits(C.i)); NEXT();
+    OP(Sub) A.i = static_cast<int64_t>(bits(B.i) - bits(C.i)); NEXT();
+    OP(Mul) A.i = static_cast<int64_t>(bits(B.i) * bits(C.i)); NEXT();
+    OP(Add32) A.i = static_cast<int32_t>(static_cast<uint32_t>(B.i) + static_cast<uint32_t>(C.i)); NEXT();
+    OP(Sub32) A.i = static_cast<int32_t>(static_cast<uint32_t>(B.i) - static_cast<uint32_t>(C.i)); NEXT();
+    OP(Mul32) A.i = static_cast<int32_t>(static_cast<uint32_t>(B.i) * static_cast<uint32_t>(C.i)); NEXT();
+    OP(AddImm) A.i = static_cast<int64_t>(bits(B.i) + bits(in->sc())); NEXT();
+    OP(AddImm32) A.i = static_cast<int32_t>(static_cast<uint32_t>(B.i) + static_cast<uint32_t>(in->sc())); NEXT();
+    OP(Div)
+        if (C.i == 0) throw divisionByZero();
+        A.i = C.i == -1 ? static_cast<int64_t>(0 - bits(B.i)) : B.i / C.i;
+        NEXT();
+    OP(Rem)
+        if (C.i == 0) throw divisionByZero();
+        A.i = C.i == -1 ? 0 : B.i % C.i;
+        NEXT();
+    OP(Shl) A.i = static_cast<int64_t>(bits(B.i) << (C.i & 63)); NEXT();
+    OP(Shr) A.i = B.i >> (C.i & 63); NEXT();
+    OP(UShr) A.i = static_cast<int64_t>(bits(B.i) >> (C.i & 63)); NEXT();
+    OP(And) A.i = B.i & C.i; NEXT();
+    OP(Or) A.i = B.i | C.i; NEXT();
+    OP(Xor) A.i = B.i ^ C.i; NEXT();
+    OP(Neg) A.i = static_cast<int64_t>(0 - bits(B.i)); NEXT();
+    OP(Not) A.i = B.i == 0; NEXT();
+    OP(IntToBool) A.i = B.i != 0; NEXT();
+    OP(BitNot) A.i = ~B.i; NEXT();
+    OP(SExt) {
+        unsigned shift = 64 - in->c;
+        A.i = static_cast<int64_t>(bits(B.i) << shift) >> shift;
+        NEXT();
+    }
+    OP(ZExt) A.i = static_cast<int64_t>(bits(B.i) & ((uint64_t(1) << in->c) - 1)); NEXT();
+
+    OP(Eq) A.i = B.i == C.i; NEXT();
+    OP(Ne) A.i = B.i != C.i; NEXT();
+    OP(Lt) A.i = B.i < C.i; NEXT();
+    OP(Le) A.i = B.i <= C.i; NEXT();
+    OP(Gt) A.i = B.i > C.i; NEXT();
+    OP(Ge) A.i = B.i >= C.i; NEXT();
+    OP(Cmp3) A.i = (B.i > C.i) - (B.i < C.i); NEXT();
+
+    OP(FAdd) A.f = B.f + C.f; NEXT();
+    OP(FSub) A.f = B.f - C.f; NEXT();
+    OP(FMul) A.f = B.f * C.f; NEXT();
+    OP(FDiv) A.f = B.f / C.f; NEXT();
+    OP(FRem) A.f = std::fmod(B.f, C.f); NEXT();
+    OP(FPow) A.f = std::pow(B.f, C.f); NEXT();
+    OP(FNeg) A.f = -B.f; NEXT();
+    OP(FEq) A.i = B.f == C.f; NEXT();
+    OP(FNe) A.i = B.f < C.f || B.f > C.f; NEXT();
+    OP(FLt) A.i = B.f < C.f; NEXT();
+    OP(FLe) A.i = B.f <= C.f; NEXT();
+    OP(FGt) A.i = B.f > C.f; NEXT();
+    OP(FGe) A.i = B.f >= C.f; NEXT();
+    OP(FCmp3) A.i = (B.f > C.f) - (B.f < C.f); NEXT();
+    OP(IntToFloat) A.f = static_cast<double>(B.i); NEXT();
+    OP(FloatToInt) A.i = floatToInt(B.f); NEXT();
+    OP(FloatToBool) A.i = B.f < 0.0 || B.f > 0.0; NEXT();
+    OP(StrToBool) A.i = B.s != nullptr; NEXT();
+
+    OP(Jump) ip += in->bc(); NEXT();
+    OP(JumpIf) if (A.i != 0) ip += in->bc(); NEXT();
+    OP(JumpIfNot) if (A.i == 0) ip += in->bc(); NEXT();
+    OP(JumpEq) if (A.i == B.i) ip += in->sc(); NEXT();
+    OP(JumpNe) if (A.i != B.i) ip += in->sc(); NEXT();
+    OP(JumpLt) if (A.i < B.i) ip += in->sc(); NEXT();
+    OP(JumpLe) if (A.i <= B.i) ip += in->sc(); NEXT();
+    OP(JumpGt) if (A.i > B.i) ip += in->sc(); NEXT();
+    OP(JumpGe) if (A.i >= B.i) ip += in->sc(); NEXT();
+
+    OP(Call) {
+        const Function* callee = &functions[in->bc()];
+        Value* calleeBase = base + in->a;
+        if (calleeBase + callee->frameSize > end) throw overflow();
+        frames.push_back({ip, base, function});
+        base = calleeBase;
+        function = callee;
+        ip = callee->code.data();
+        NEXT();
+    }
+    OP(Return) {
+        // The callee's first register is the caller's result register
+        base[0] = A;
+        if (frames.empty()) return base[0].i;
+        ip = frames.back().resume;
+        base = frames.back().base;
+        function = frames.back().function;
+        frames.pop_back();
+        NEXT();
+    }
+    OP(ReturnVoid) {
+        if (frames.empty()) return 0;
+        ip = frames.back().resume;
+        base = frames.back().base;
+        function = frames.back().function;
+        frames.pop_back();
+        NEXT();
+    }
+
+    // The builtins pass every integer to printf as %d, as CodeGenerator does
+    OP(PrintInt) A.i = std::printf(in->c ? "%d\n" : "%d", static_cast<int>(B.i)); NEXT();
+    OP(PrintFloat) A.i = std::printf(in->c ? "%f\n" : "%f", B.f); NEXT();
+    OP(PrintString) A.i = std::printf(in->c ? "%s\n" : "%s", B.s); NEXT();
+
+#if !FLAST_THREADED_DISPATCH
+            default:
+                throw std::runtime_error("Invalid bytecode");
+        }
+    }
+#endif
+
+#undef A
+#undef B
+#undef C
+#undef OP
+#undef NEXT
+}
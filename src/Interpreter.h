@@ -0,0 +1,29 @@
+#pragma once
+#include "Bytecode.h"
+#include <memory>
+
+// Runs a bytecode::Program for `flast run --interp`.
+//
+// Dispatch is threaded: every handler ends with its own indirect jump to
+// the next one (labels as values, in GCC and Clang), which keeps branch
+// prediction per opcode pair instead of funnelling through one switch.
+// Other compilers get the switch. Calls slide the frame up the register
+// stack so a callee's parameters are the caller's argument registers.
+class Interpreter {
+public:
+    // `registers` bounds the frames of all active calls together; the
+    // memory is only touched as deep as the program recurses
+    explicit Interpreter(const bytecode::Program& program, size_t registers = size_t(1) << 22);
+
+    // Calls main and returns its result (0 for a main without one).
+    // Throws std::runtime_error on integer division by zero or when the
+    // calls outgrow the register stack.
+    int runMain();
+
+private:
+    int64_t execute(const bytecode::Function& entry);
+
+    const bytecode::Program& program;
+    std::unique_ptr<bytecode::Value[]> registers;
+    size_t registerCount;
+};
@@ -0,0 +1,145 @@
+#include "JIT.h"
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetSelect.h>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+
+// Unwraps an ORC result, turning its error into the exception flast reports
+template <typename T>
+T check(llvm::Expected<T> value, const std::string& what) {
+    if (!value) {
+        throw std::runtime_error(what + ": " + llvm::toString(value.takeError()));
+    }
+    return std::move(*value);
+}
+
+void check(llvm::Error error, const std::string& what) {
+    if (error) {
+        throw std::runtime_error(what + ": " + llvm::toString(std::move(error)));
+    }
+}
+
+llvm::CodeGenOpt::Level codeGenLevel(CodeGenerator::OptLevel level) {
+    switch (level) {
+        case CodeGenerator::OptLevel::O0: return llvm::CodeGenOpt::None;
+        case CodeGenerator::OptLevel::O1: return llvm::CodeGenOpt::Less;
+        case CodeGenerator::OptLevel::O3: return llvm::CodeGenOpt::Aggressive;
+        default: return llvm::CodeGenOpt::Default;
+    }
+}
+
+} // namespace
+
+JITSession::JITSession(const CodeGenerator::BuildOptions& options, bool lazy) : options(options), lazy(lazy) {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmParser();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    // Position-independent, so the JIT may place code and data anywhere
+    llvm::orc::JITTargetMachineBuilder machine{llvm::Triple(llvm::sys::getProcessTriple())};
+    machine.setCPU(options.targetCPU);
+    machine.setFeatures(options.targetFeatures);
+    machine.setCodeGenOptLevel(codeGenLevel(options.optLevel));
+    machine.setRelocationModel(llvm::Reloc::PIC_);
+    optimizer = check(machine.createTargetMachine(), "Cannot create the target machine");
+
+    if (lazy) {
+        jit = check(llvm::orc::LLLazyJITBuilder().setJITTargetMachineBuilder(std::move(machine)).create(),
+                    "Cannot start the JIT");
+    } else {
+        jit = check(llvm::orc::LLJITBuilder().setJITTargetMachineBuilder(std::move(machine)).create(),
+                    "Cannot start the JIT");
+    }
+
+    // Sees whole modules in an eager session and single functions, as the
+    // compile-on-demand layer splits them off, in a lazy one
+    jit->getIRTransformLayer().setTransform(
+        [this](llvm::orc::ThreadSafeModule module, llvm::orc::MaterializationResponsibility&) {
+            module.withModuleDo([&](llvm::Module& m) {
+                CodeGenerator::optimizeModule(m, *optimizer, this->options);
+            });
+            return llvm::Expected<llvm::orc::ThreadSafeModule>(std::move(module));
+        });
+
+    char prefix = jit->getDataLayout().getGlobalPrefix();
+    jit->getMainJITDylib().addGenerator(
+        check(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(prefix),
+              "Cannot resolve symbols from the process"));
+}
+
+JITSession::~JITSession() = default;
+
+void JITSession::prepare(llvm::Module& module) {
+    // Units handed over without a target get the JIT's own
+    if (module.getTargetTriple().empty()) {
+        module.setTargetTriple(optimizer->getTargetTriple().str());
+        module.setDataLayout(optimizer->createDataLayout());
+    }
+}
+
+void JITSession::addModule(llvm::orc::ThreadSafeModule module) {
+    module.withModuleDo([&](llvm::Module& m) {
+        prepare(m);
+        if (llvm::Function* main = m.getFunction("main"); main && !main->isDeclaration()) {
+            mainReturnsInt = main->getReturnType()->isIntegerTy();
+        }
+    });
+
+    if (lazy) {
+        check(static_cast<llvm::orc::LLLazyJIT&>(*jit).addLazyIRModule(std::move(module)), "Cannot add module");
+    } else {
+        check(jit->addIRModule(std::move(module)), "Cannot add module");
+    }
+}
+
+void JITSession::compile(const std::vector<std::string>& symbols) {
+    for (const auto& symbol : symbols) {
+        check(jit->lookup(symbol), "Cannot compile " + symbol);
+    }
+}
+
+void JITSession::runOnce(llvm::orc::ThreadSafeModule module, const std::string& function) {
+    module.withModuleDo([&](llvm::Module& m) { prepare(m); });
+
+    // Compiled eagerly even in a lazy session: all of it runs right away
+    auto tracker = jit->getMainJITDylib().createResourceTracker();
+    check(jit->addIRModule(tracker, std::move(module)), "Cannot add module");
+    auto symbol = check(jit->lookup(function), "Cannot run " + function);
+    reinterpret_cast<void (*)()>(symbol.getAddress())();
+    std::fflush(stdout);
+    check(tracker->remove(), "Cannot free " + function);
+}
+
+int JITSession::runMain(const std::string& programName, const std::vector<std::string>& args) {
+    auto symbol = check(jit->lookup("main"), "Cannot run the program");
+
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(programName.c_str()));
+    for (const auto& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    check(jit->initialize(jit->getMainJITDylib()), "Static constructors failed");
+
+    // A main declared without parameters ignores the registers these are
+    // passed in, as a C runtime calling it would
+    int result;
+    if (mainReturnsInt) {
+        auto main = reinterpret_cast<int (*)(int, char**)>(symbol.getAddress());
+        result = main(static_cast<int>(argv.size() - 1), argv.data());
+    } else {
+        auto main = reinterpret_cast<void (*)(int, char**)>(symbol.getAddress());
+        main(static_cast<int>(argv.size() - 1), argv.data());
+        result = 0;
+    }
+
+    check(jit->deinitialize(jit->getMainJITDylib()), "Static destructors failed");
+    std::fflush(stdout);
+    return result;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "CodeGen.h"
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class TargetMachine;
+namespace orc {
+class LLJIT;
+}
+}
+
+// Runs lowered modules in this process for `flast run`, without writing
+// objects or linking.
+//
+// Eager sessions optimise and compile each module as a whole when main is
+// looked up; lazy ones (--lazy) optimise and compile a function the first
+// time it is called, so a script pays only for the code it reaches.
+// Symbols no module defines (printf, malloc, pow, ...) resolve against the
+// libraries flast itself is linked with.
+class JITSession {
+public:
+    // Modules are optimised as `options` ask and compiled for its CPU and
+    // features, at the matching CodeGenOpt level
+    JITSession(const CodeGenerator::BuildOptions& options, bool lazy);
+    ~JITSession();
+
+    // Throws std::runtime_error when the module clashes with one added before
+    void addModule(llvm::orc::ThreadSafeModule module);
+
+    // Compiles the named symbols now instead of on their first use
+    void compile(const std::vector<std::string>& symbols);
+
+    // Compiles `module` on its own, calls its `void function()` and then
+    // frees it again; what it calls stays defined. For REPL input.
+    void runOnce(llvm::orc::ThreadSafeModule module, const std::string& function);
+
+    // Runs the program's static constructors, then main(argc, argv) with
+    // `programName` as argv[0], then the destructors; returns main's result
+    // (0 for a main without one). Throws when there is no main.
+    int runMain(const std::string& programName, const std::vector<std::string>& args);
+
+private:
+    void prepare(llvm::Module& module);
+
+    CodeGenerator::BuildOptions options;
+    std::unique_ptr<llvm::TargetMachine> optimizer;  // what the pipeline tunes for
+    std::unique_ptr<llvm::orc::LLJIT> jit;
+    bool lazy;
+    bool mainReturnsInt = true;
+};
+
+// Holds back std::cout while alive: in-memory runs keep compiler progress
+// out of the program's own output
+class QuietConsole {
+public:
+    explicit QuietConsole(bool enabled) : saved(enabled ? std::cout.rdbuf(discarded.rdbuf()) : nullptr) {}
+    ~QuietConsole() {
+        if (saved) std::cout.rdbuf(saved);
+    }
+
+private:
+    std::ostringstream discarded;
+    std::streambuf* saved;
+};
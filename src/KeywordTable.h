@@ -0,0 +1,220 @@
+#pragma once
+#include "Token.h"
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+// Keyword classification through a perfect hash generated at compile time.
+// The hash seed is searched by the compiler so that every keyword lands in a
+// distinct slot; a lookup is then one hash, one table load and at most one
+// string comparison, with no per-Lexer setup.
+
+struct KeywordEntry {
+    std::string_view text;
+    TokenType type;
+};
+
+inline constexpr KeywordEntry kKeywords[] = {
+    // FLAST-style function declaration
+    {"func", TokenType::TOK_FUNC},
+    {"return", TokenType::TOK_RETURN},
+    {"public", TokenType::TOK_PUBLIC},
+    {"private", TokenType::TOK_PRIVATE},
+    {"protected", TokenType::TOK_PROTECTED},
+    {"static", TokenType::TOK_STATIC},
+    {"constant", TokenType::TOK_CONSTANT},
+    {"mutable", TokenType::TOK_MUTABLE},
+    {"unsafe", TokenType::TOK_UNSAFE},
+
+    // Control flow
+    {"if", TokenType::TOK_IF},
+    {"else", TokenType::TOK_ELSE},
+    {"elseif", TokenType::TOK_ELSEIF},
+    {"while", TokenType::TOK_WHILE},
+    {"for", TokenType::TOK_FOR},
+    {"loop", TokenType::TOK_LOOP},
+    {"break", TokenType::TOK_BREAK},
+    {"continue", TokenType::TOK_CONTINUE},
+    {"switch", TokenType::TOK_SWITCH},
+    {"case", TokenType::TOK_CASE},
+    {"default", TokenType::TOK_DEFAULT},
+
+    // Data Types (Rust-like)
+    {"struct", TokenType::TOK_STRUCT},
+    {"enum", TokenType::TOK_ENUM},
+    {"union", TokenType::TOK_UNION},
+    {"impl", TokenType::TOK_IMPL},
+    {"trait", TokenType::TOK_TRAIT},
+    {"where", TokenType::TOK_WHERE},
+    {"self", TokenType::TOK_SELF},
+    {"Self", TokenType::TOK_SELF_TYPE},
+
+    // Variables and types
+    {"let", TokenType::TOK_LET},
+    {"var", TokenType::TOK_VAR},
+    {"auto", TokenType::TOK_AUTO},
+    {"typeof", TokenType::TOK_TYPEOF},
+    {"sizeof", TokenType::TOK_SIZEOF},
+    
+    // Primitive types
+    {"int8", TokenType::TOK_INT8},
+    {"int16", TokenType::TOK_INT16},
+    {"int32", TokenType::TOK_INT32},
+    {"int64", TokenType::TOK_INT64},
+    {"int128", TokenType::TOK_INT128},
+    {"uint8", TokenType::TOK_UINT8},
+    {"uint16", TokenType::TOK_UINT16},
+    {"uint32", TokenType::TOK_UINT32},
+    {"uint64", TokenType::TOK_UINT64},
+    {"uint128", TokenType::TOK_UINT128},
+    {"float32", TokenType::TOK_FLOAT32},
+    {"float64", TokenType::TOK_FLOAT64},
+    {"char", TokenType::TOK_CHAR_TYPE},
+    {"string", TokenType::TOK_STRING_TYPE},
+    {"bool", TokenType::TOK_BOOL_TYPE},
+    {"void", TokenType::TOK_VOID},
+    {"ptr", TokenType::TOK_POINTER},
+
+    // Collection types
+    {"array", TokenType::TOK_ARRAY},
+    {"list", TokenType::TOK_LIST},
+    {"slice", TokenType::TOK_SLICE},
+    {"map", TokenType::TOK_MAP},
+    {"set", TokenType::TOK_SET},
+    {"tuple", TokenType::TOK_TUPLE},
+    {"option", TokenType::TOK_OPTION},
+    {"result", TokenType::TOK_RESULT},
+
+    // Import/Export (TypeScript-like)
+    {"import", TokenType::TOK_IMPORT},
+    {"from", TokenType::TOK_FROM},
+    {"export", TokenType::TOK_EXPORT},
+    {"module", TokenType::TOK_MODULE},
+    {"as", TokenType::TOK_AS},
+    {"use", TokenType::TOK_USE},
+    {"mod", TokenType::TOK_MOD},
+    {"crate", TokenType::TOK_CRATE},
+
+    // Memory & Ownership (FLAST-style)
+    {"box", TokenType::TOK_BOX},
+    {"ref", TokenType::TOK_REF},
+    {"deref", TokenType::TOK_DEREF},
+    {"move", TokenType::TOK_MOVE},
+    {"copy", TokenType::TOK_COPY},
+    {"clone", TokenType::TOK_CLONE},
+    {"drop", TokenType::TOK_DROP},
+    {"new", TokenType::TOK_NEW},
+    {"delete", TokenType::TOK_DELETE},
+
+    // Concurrency
+    {"async", TokenType::TOK_ASYNC},
+    {"await", TokenType::TOK_AWAIT},
+    {"spawn", TokenType::TOK_SPAWN},
+    {"thread", TokenType::TOK_THREAD},
+    {"mutex", TokenType::TOK_MUTEX},
+    {"rwlock", TokenType::TOK_RWLOCK},
+    {"channel", TokenType::TOK_CHANNEL},
+    {"send", TokenType::TOK_SEND},
+    {"sync", TokenType::TOK_SYNC},
+
+    // External & FFI
+    {"extern", TokenType::TOK_EXTERN},
+    {"c", TokenType::TOK_C},
+    {"cpp", TokenType::TOK_CPP},
+    {"cdecl", TokenType::TOK_CDECL},
+    {"stdcall", TokenType::TOK_STDCALL},
+    {"fastcall", TokenType::TOK_FASTCALL},
+
+    // Exception handling
+    {"try", TokenType::TOK_TRY},
+    {"catch", TokenType::TOK_CATCH},
+    {"finally", TokenType::TOK_FINALLY},
+    {"throw", TokenType::TOK_THROW},
+    {"panic", TokenType::TOK_PANIC},
+    {"unwrap", TokenType::TOK_UNWRAP},
+    {"expect", TokenType::TOK_EXPECT},
+
+    // Special keywords
+    {"in", TokenType::TOK_IN},
+    {"is", TokenType::TOK_IS},
+    {"not", TokenType::TOK_NOT},
+    {"and", TokenType::TOK_AND},
+    {"or", TokenType::TOK_OR},
+    {"xor", TokenType::TOK_XOR},
+    {"true", TokenType::TOK_TRUE},
+    {"false", TokenType::TOK_FALSE},
+    {"null", TokenType::TOK_NULL_VALUE},
+    {"none", TokenType::TOK_NONE},
+    {"some", TokenType::TOK_SOME},
+    {"ok", TokenType::TOK_OK},
+    {"err", TokenType::TOK_ERR},
+
+    // Built-in functions
+    {"assert", TokenType::TOK_ASSERT},
+    {"debug_assert", TokenType::TOK_DEBUG_ASSERT},
+    {"unreachable", TokenType::TOK_UNREACHABLE},
+    {"todo", TokenType::TOK_TODO},
+    {"unimplemented", TokenType::TOK_UNIMPLEMENTED},
+};
+
+inline constexpr size_t kKeywordCount = sizeof(kKeywords) / sizeof(kKeywords[0]);
+inline constexpr size_t kKeywordSlotCount = 2048;  // power of two
+static_assert(kKeywordCount < 255, "slot table stores keyword indices in a uint8_t");
+
+constexpr size_t maxKeywordLength() {
+    size_t longest = 0;
+    for (const auto& entry : kKeywords) {
+        if (entry.text.size() > longest) longest = entry.text.size();
+    }
+    return longest;
+}
+
+inline constexpr size_t kMaxKeywordLength = maxKeywordLength();
+
+constexpr uint32_t keywordHash(std::string_view text, uint32_t seed) {
+    // FNV-1a seeded with the length, followed by a murmur-style finaliser
+    uint32_t h = seed ^ (static_cast<uint32_t>(text.size()) * 0x9E3779B1u);
+    for (char c : text) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 0x01000193u;
+    }
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+struct KeywordSlots {
+    uint32_t seed;
+    uint8_t slots[kKeywordSlotCount];  // keyword index + 1, 0 = empty
+};
+
+constexpr KeywordSlots buildKeywordSlots() {
+    for (uint32_t seed = 1; seed < 100000; seed++) {
+        KeywordSlots table{seed, {}};
+        bool collision = false;
+        for (size_t i = 0; i < kKeywordCount && !collision; i++) {
+            uint32_t slot = keywordHash(kKeywords[i].text, seed) & (kKeywordSlotCount - 1);
+            if (table.slots[slot] != 0) {
+                collision = true;
+            } else {
+                table.slots[slot] = static_cast<uint8_t>(i + 1);
+            }
+        }
+        if (!collision) return table;
+    }
+    return KeywordSlots{0, {}};
+}
+
+inline constexpr KeywordSlots kKeywordSlots = buildKeywordSlots();
+static_assert(kKeywordSlots.seed != 0, "no collision-free seed for the keyword table");
+
+// Returns the keyword entry for `text`, or nullptr for ordinary identifiers.
+inline const KeywordEntry* lookupKeyword(std::string_view text) {
+    if (text.empty() || text.size() > kMaxKeywordLength) return nullptr;
+    uint32_t slot = keywordHash(text, kKeywordSlots.seed) & (kKeywordSlotCount - 1);
+    uint8_t index = kKeywordSlots.slots[slot];
+    if (index == 0) return nullptr;
+    const KeywordEntry& entry = kKeywords[index - 1];
+    return entry.text == text ? &entry : nullptr;
+}
@@ -1,206 +1,225 @@
 #include "Lexer.h"
+#include "KeywordTable.h"
+#include "ThreadPool.h"
 #include <cctype>
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
-#include <sstream>
 
-Lexer::Lexer(const std::string& input) : input(input), position(0), current(0), line(1), column(1) {
-    initializeKeywords();
-    initializeBuiltinMethods();
-}
-
-void Lexer::initializeKeywords() {
-    // FLAST-style function declaration
-    keywords["func"] = TokenType::TOK_FUNC;
-    keywords["return"] = TokenType::TOK_RETURN;
-    keywords["public"] = TokenType::TOK_PUBLIC;
-    keywords["private"] = TokenType::TOK_PRIVATE;
-    keywords["protected"] = TokenType::TOK_PROTECTED;
-    keywords["static"] = TokenType::TOK_STATIC;
-    keywords["constant"] = TokenType::TOK_CONSTANT;
-    keywords["mutable"] = TokenType::TOK_MUTABLE;
-    keywords["unsafe"] = TokenType::TOK_UNSAFE;
+namespace {
 
-    // Control flow
-    keywords["if"] = TokenType::TOK_IF;
-    keywords["else"] = TokenType::TOK_ELSE;
-    keywords["elseif"] = TokenType::TOK_ELSEIF;
-    keywords["while"] = TokenType::TOK_WHILE;
-    keywords["for"] = TokenType::TOK_FOR;
-    keywords["loop"] = TokenType::TOK_LOOP;
-    keywords["break"] = TokenType::TOK_BREAK;
-    keywords["continue"] = TokenType::TOK_CONTINUE;
-    keywords["switch"] = TokenType::TOK_SWITCH;
-    keywords["case"] = TokenType::TOK_CASE;
-    keywords["default"] = TokenType::TOK_DEFAULT;
+// Built-in methods that can be called on objects
+constexpr std::string_view kBuiltinMethods[] = {
+    "type", "to_string", "to_int", "to_float", "to_bool", "length", "size",
+    "is_empty", "contains", "starts_with", "ends_with", "split", "join", "trim",
+    "replace", "push", "pop", "insert", "remove", "clear", "sort", "reverse", "map",
+    "filter", "reduce", "fold", "find", "any", "all", "count", "min", "max", "sum",
+};
 
-    // Data Types (Rust-like)
-    keywords["struct"] = TokenType::TOK_STRUCT;
-    keywords["enum"] = TokenType::TOK_ENUM;
-    keywords["union"] = TokenType::TOK_UNION;
-    keywords["impl"] = TokenType::TOK_IMPL;
-    keywords["trait"] = TokenType::TOK_TRAIT;
-    keywords["where"] = TokenType::TOK_WHERE;
-    keywords["self"] = TokenType::TOK_SELF;
-    keywords["Self"] = TokenType::TOK_SELF_TYPE;
+} // namespace
 
-    // Variables and types
-    keywords["let"] = TokenType::TOK_LET;
-    keywords["var"] = TokenType::TOK_VAR;
-    keywords["auto"] = TokenType::TOK_AUTO;
-    keywords["typeof"] = TokenType::TOK_TYPEOF;
-    keywords["sizeof"] = TokenType::TOK_SIZEOF;
-    
-    // Primitive types
-    keywords["int8"] = TokenType::TOK_INT8;
-    keywords["int16"] = TokenType::TOK_INT16;
-    keywords["int32"] = TokenType::TOK_INT32;
-    keywords["int64"] = TokenType::TOK_INT64;
-    keywords["int128"] = TokenType::TOK_INT128;
-    keywords["uint8"] = TokenType::TOK_UINT8;
-    keywords["uint16"] = TokenType::TOK_UINT16;
-    keywords["uint32"] = TokenType::TOK_UINT32;
-    keywords["uint64"] = TokenType::TOK_UINT64;
-    keywords["uint128"] = TokenType::TOK_UINT128;
-    keywords["float32"] = TokenType::TOK_FLOAT32;
-    keywords["float64"] = TokenType::TOK_FLOAT64;
-    keywords["char"] = TokenType::TOK_CHAR_TYPE;
-    keywords["string"] = TokenType::TOK_STRING_TYPE;
-    keywords["bool"] = TokenType::TOK_BOOL_TYPE;
-    keywords["void"] = TokenType::TOK_VOID;
-    keywords["ptr"] = TokenType::TOK_POINTER;
+Lexer::Lexer(SourceBuffer& source)
+    : source(source), input(source.text()), position(0), current(0), line(1), column(1),
+      scan(LexerScan::active()) {}
 
-    // Collection types
-    keywords["array"] = TokenType::TOK_ARRAY;
-    keywords["list"] = TokenType::TOK_LIST;
-    keywords["slice"] = TokenType::TOK_SLICE;
-    keywords["map"] = TokenType::TOK_MAP;
-    keywords["set"] = TokenType::TOK_SET;
-    keywords["tuple"] = TokenType::TOK_TUPLE;
-    keywords["option"] = TokenType::TOK_OPTION;
-    keywords["result"] = TokenType::TOK_RESULT;
+Lexer::Lexer(SourceBuffer& source, const LexChunk& chunk)
+    : source(source), input(source.text().substr(chunk.begin, chunk.end - chunk.begin)),
+      position(0), current(0), line(chunk.startLine), column(1), scan(LexerScan::active()) {}
 
-    // Import/Export (TypeScript-like)
-    keywords["import"] = TokenType::TOK_IMPORT;
-    keywords["from"] = TokenType::TOK_FROM;
-    keywords["export"] = TokenType::TOK_EXPORT;
-    keywords["module"] = TokenType::TOK_MODULE;
-    keywords["as"] = TokenType::TOK_AS;
-    keywords["use"] = TokenType::TOK_USE;
-    keywords["mod"] = TokenType::TOK_MOD;
-    keywords["crate"] = TokenType::TOK_CRATE;
+bool Lexer::isBuiltinMethod(std::string_view name) {
+    for (std::string_view method : kBuiltinMethods) {
+        if (method == name) return true;
+    }
+    return false;
+}
 
-    // Memory & Ownership (FLAST-style)
-    keywords["box"] = TokenType::TOK_BOX;
-    keywords["ref"] = TokenType::TOK_REF;
-    keywords["deref"] = TokenType::TOK_DEREF;
-    keywords["move"] = TokenType::TOK_MOVE;
-    keywords["copy"] = TokenType::TOK_COPY;
-    keywords["clone"] = TokenType::TOK_CLONE;
-    keywords["drop"] = TokenType::TOK_DROP;
-    keywords["new"] = TokenType::TOK_NEW;
-    keywords["delete"] = TokenType::TOK_DELETE;
+std::vector<Token> Lexer::tokenize() {
+    std::vector<Token> tokens;
+    tokens.reserve(input.size() / 5 + 1);  // typical source averages ~5 bytes per token
+    
+    while (!isAtEnd()) {
+        Token token = nextToken();
+        if (token.type != TokenType::TOK_LINE_COMMENT && 
+            token.type != TokenType::TOK_BLOCK_COMMENT) {
+            tokens.push_back(std::move(token));
+        }
+    }
+    
+    tokens.push_back(Token(TokenType::TOK_EOF, "", line, column));
+    return tokens;
+}
 
-    // Concurrency
-    keywords["async"] = TokenType::TOK_ASYNC;
-    keywords["await"] = TokenType::TOK_AWAIT;
-    keywords["spawn"] = TokenType::TOK_SPAWN;
-    keywords["thread"] = TokenType::TOK_THREAD;
-    keywords["mutex"] = TokenType::TOK_MUTEX;
-    keywords["rwlock"] = TokenType::TOK_RWLOCK;
-    keywords["channel"] = TokenType::TOK_CHANNEL;
-    keywords["send"] = TokenType::TOK_SEND;
-    keywords["sync"] = TokenType::TOK_SYNC;
+namespace {
 
-    // External & FFI
-    keywords["extern"] = TokenType::TOK_EXTERN;
-    keywords["c"] = TokenType::TOK_C;
-    keywords["cpp"] = TokenType::TOK_CPP;
-    keywords["cdecl"] = TokenType::TOK_CDECL;
-    keywords["stdcall"] = TokenType::TOK_STDCALL;
-    keywords["fastcall"] = TokenType::TOK_FASTCALL;
+bool isIdentByte(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
 
-    // Exception handling
-    keywords["try"] = TokenType::TOK_TRY;
-    keywords["catch"] = TokenType::TOK_CATCH;
-    keywords["finally"] = TokenType::TOK_FINALLY;
-    keywords["throw"] = TokenType::TOK_THROW;
-    keywords["panic"] = TokenType::TOK_PANIC;
-    keywords["unwrap"] = TokenType::TOK_UNWRAP;
-    keywords["expect"] = TokenType::TOK_EXPECT;
+bool isDigitByte(char c) {
+    return c >= '0' && c <= '9';
+}
 
-    // Special keywords
-    keywords["in"] = TokenType::TOK_IN;
-    keywords["is"] = TokenType::TOK_IS;
-    keywords["not"] = TokenType::TOK_NOT;
-    keywords["and"] = TokenType::TOK_AND;
-    keywords["or"] = TokenType::TOK_OR;
-    keywords["xor"] = TokenType::TOK_XOR;
-    keywords["true"] = TokenType::TOK_TRUE;
-    keywords["false"] = TokenType::TOK_FALSE; 
-    keywords["null"] = TokenType::TOK_NULL_VALUE;
-    keywords["none"] = TokenType::TOK_NONE;
-    keywords["some"] = TokenType::TOK_SOME;
-    keywords["ok"] = TokenType::TOK_OK;
-    keywords["err"] = TokenType::TOK_ERR;
+// True when the '"' at `quote` belongs to a raw string, i.e. it is preceded
+// by an 'r' that nextToken() sees at the start of a token.
+bool opensRawString(const char* base, const char* quote) {
+    if (quote == base || quote[-1] != 'r') return false;
+    const char* runStart = quote - 1;
+    while (runStart > base && isIdentByte(runStart[-1])) runStart--;
+    if (runStart == quote - 1) return true;       // lone 'r'
+    if (!isDigitByte(*runStart)) return false;    // identifier ending in 'r'
+    
+    // The run starts with a number: follow Lexer::number() to find where the
+    // number ends and check that the 'r' is what comes right after it
+    const char* p = runStart;
+    while (p < quote && (isDigitByte(*p) || *p == '_')) p++;
+    if (p < quote && (*p == 'e' || *p == 'E')) {
+        p++;
+        while (p < quote && (isDigitByte(*p) || *p == '_')) p++;
+    }
+    return p == quote - 1;
+}
 
-    // Built-in functions
-    keywords["assert"] = TokenType::TOK_ASSERT;
-    keywords["debug_assert"] = TokenType::TOK_DEBUG_ASSERT;
-    keywords["unreachable"] = TokenType::TOK_UNREACHABLE;
-    keywords["todo"] = TokenType::TOK_TODO;
-    keywords["unimplemented"] = TokenType::TOK_UNIMPLEMENTED;
+// Skips a quoted literal body starting after the opening quote, honouring
+// backslash escapes the same way stringLiteral()/templateString() do.
+const char* skipQuoted(const LexerScan::Kernels& scan, const char* p, const char* end, char quote) {
+    while (true) {
+        p = scan.findEither(p, end, quote, '\\');
+        if (p == end) return end;
+        if (*p == quote) return p + 1;
+        p += 2;  // backslash and the escaped character
+        if (p >= end) return end;
+    }
 }
 
-void Lexer::initializeBuiltinMethods() {
-    // Built-in methods that can be called on objects
-    builtinMethods.insert("type");
-    builtinMethods.insert("to_string");
-    builtinMethods.insert("to_int");
-    builtinMethods.insert("to_float");
-    builtinMethods.insert("to_bool");
-    builtinMethods.insert("length");
-    builtinMethods.insert("size");
-    builtinMethods.insert("is_empty");
-    builtinMethods.insert("contains");
-    builtinMethods.insert("starts_with");
-    builtinMethods.insert("ends_with");
-    builtinMethods.insert("split");
-    builtinMethods.insert("join");
-    builtinMethods.insert("trim");
-    builtinMethods.insert("replace");
-    builtinMethods.insert("push");
-    builtinMethods.insert("pop");
-    builtinMethods.insert("insert");
-    builtinMethods.insert("remove");
-    builtinMethods.insert("clear");
-    builtinMethods.insert("sort");
-    builtinMethods.insert("reverse");
-    builtinMethods.insert("map");
-    builtinMethods.insert("filter");
-    builtinMethods.insert("reduce");
-    builtinMethods.insert("fold");
-    builtinMethods.insert("find");
-    builtinMethods.insert("any");
-    builtinMethods.insert("all");
-    builtinMethods.insert("count");
-    builtinMethods.insert("min");
-    builtinMethods.insert("max");
-    builtinMethods.insert("sum");
+} // namespace
+
+std::vector<LexChunk> Lexer::splitIntoChunks(std::string_view text, size_t chunkCount) {
+    const LexerScan::Kernels& scan = LexerScan::active();
+    const char* base = text.data();
+    const char* end = base + text.size();
+    size_t stride = std::max<size_t>(1, text.size() / std::max<size_t>(1, chunkCount));
+    
+    std::vector<LexChunk> chunks;
+    size_t chunkStart = 0;
+    size_t nextSplit = stride;
+    int startLine = 1;
+    
+    auto cutAfter = [&](const char* newline) {
+        size_t at = newline + 1 - base;
+        if (at == text.size()) {
+            nextSplit = text.size();  // never leave an empty final chunk
+            return;
+        }
+        chunks.push_back({chunkStart, at, startLine});
+        startLine += static_cast<int>(scan.countNewlines(base + chunkStart, base + at));
+        chunkStart = at;
+        nextSplit = at + stride;
+    };
+    
+    // Walk the buffer at token level, jumping over strings and comments. Only
+    // bytes that can open one of those stop the scan; newlines in between are
+    // candidate split points once the next chunk is due.
+    const char* p = base;
+    while (p < end) {
+        const char* special = scan.findAny4(p, end, '"', '\'', '`', '/');
+        while (nextSplit < text.size() && base + nextSplit < special) {
+            const char* newline = scan.findByte(std::max(p, base + nextSplit), special, '\n');
+            if (newline == special) break;
+            cutAfter(newline);
+        }
+        if (special == end) break;
+        
+        p = special + 1;
+        switch (*special) {
+            case '/':
+                if (p < end && *p == '/') {
+                    p = scan.findByte(p, end, '\n');
+                } else if (p < end && *p == '*') {
+                    const char* close = scan.findBlockCommentEnd(p + 1, end);
+                    p = close == end ? end : close + 2;
+                }
+                break;
+            case '"':
+                if (opensRawString(base, special)) {
+                    p = scan.findByte(p, end, '"');
+                    if (p < end) p++;
+                } else {
+                    p = skipQuoted(scan, p, end, '"');
+                }
+                break;
+            default:
+                p = skipQuoted(scan, p, end, *special);
+                break;
+        }
+    }
+    
+    chunks.push_back({chunkStart, text.size(), startLine});
+    return chunks;
 }
 
-std::vector<Token> Lexer::tokenize() {
-    std::vector<Token> tokens;
+std::vector<Token> Lexer::tokenizeParallel(unsigned threads, size_t minChunkBytes) {
+    if (threads == 0) threads = ThreadPool::hardwareThreads();
+    if (threads <= 1 || input.size() < 2 * minChunkBytes) {
+        return tokenize();
+    }
+    
+    // A few chunks per thread so an unlucky large chunk doesn't serialise the tail
+    size_t chunkCount = std::min<size_t>(threads * 4, input.size() / minChunkBytes);
+    std::vector<LexChunk> chunks = splitIntoChunks(input, chunkCount);
+    if (chunks.size() < 2) {
+        return tokenize();
+    }
+    
+    std::vector<std::vector<Token>> results(chunks.size());
+    std::vector<std::pair<int, int>> endPositions(chunks.size());
+    bool failed = false;
+    {
+        ThreadPool pool(std::min<size_t>(threads, chunks.size()));
+        std::vector<std::future<void>> pending;
+        pending.reserve(chunks.size());
+        for (size_t i = 0; i < chunks.size(); i++) {
+            pending.push_back(pool.submit([this, &chunks, &results, &endPositions, i] {
+                Lexer chunkLexer(source, chunks[i]);
+                chunkLexer.reportErrors = false;
+                results[i] = chunkLexer.tokenize();
+                endPositions[i] = {chunkLexer.line, chunkLexer.column};
+            }));
+        }
+        for (auto& task : pending) {
+            try {
+                task.get();
+            } catch (const std::exception&) {
+                failed = true;
+            }
+        }
+    }
     
-    while (!isAtEnd()) {
-        Token token = nextToken();
-        if (token.type != TokenType::TOK_LINE_COMMENT && 
-            token.type != TokenType::TOK_BLOCK_COMMENT) {
-            tokens.push_back(token);
+    // Lexical errors are rare; redo the whole file serially so they are
+    // reported with exactly the serial lexer's diagnostics
+    if (failed) {
+        return tokenize();
+    }
+    
+    // Stitch: chunks end in a newline, so each one closes with the EOF tokens
+    // tokenize() emits at end of input (two when the input ends in whitespace).
+    // Only the last chunk's EOF tokens belong in the serial stream.
+    for (size_t i = 0; i + 1 < results.size(); i++) {
+        while (!results[i].empty() && results[i].back().type == TokenType::TOK_EOF) {
+            results[i].pop_back();
         }
     }
+    size_t total = 0;
+    for (const auto& chunkTokens : results) total += chunkTokens.size();
+    std::vector<Token> tokens;
+    tokens.reserve(total);
+    for (auto& chunkTokens : results) {
+        tokens.insert(tokens.end(), std::make_move_iterator(chunkTokens.begin()),
+                      std::make_move_iterator(chunkTokens.end()));
+    }
     
-    tokens.push_back(Token(TokenType::TOK_EOF, "", line, column));
+    current = input.size();
+    line = endPositions.back().first;
+    column = endPositions.back().second;
     return tokens;
 }
 
@@ -223,28 +242,23 @@ Token Lexer::nextToken() {
     
     // Block comments
     if (c == '/' && peek() == '*') {
+        size_t start = current - 1;
         advance(); // consume '*'
-        std::string comment = "/*";
-        while (!isAtEnd() && !(peek() == '*' && peekNext() == '/')) {
-            comment += advance();
-        }
+        advanceTo(scan.findBlockCommentEnd(input.data() + current, input.data() + input.size()) - input.data());
         if (!isAtEnd()) {
             advance(); // consume '*'
             advance(); // consume '/'
-            comment += "*/";
         }
-        return Token(TokenType::TOK_BLOCK_COMMENT, comment, startLine, startColumn);
+        return Token(TokenType::TOK_BLOCK_COMMENT, input.substr(start, current - start), startLine, startColumn);
     }
     
     // Doc comments
     if (c == '/' && peek() == '/' && peekNext() == '/') {
+        size_t start = current - 1;
         advance(); // consume second '/'
         advance(); // consume third '/'
-        std::string comment = "///";
-        while (!isAtEnd() && peek() != '\n') {
-            comment += advance();
-        }
-        return Token(TokenType::TOK_DOC_COMMENT, comment, startLine, startColumn);
+        advanceTo(scan.findByte(input.data() + current, input.data() + input.size(), '\n') - input.data());
+        return Token(TokenType::TOK_DOC_COMMENT, input.substr(start, current - start), startLine, startColumn);
     }
     
     // Numbers (including scientific notation)
@@ -265,10 +279,9 @@ Token Lexer::nextToken() {
     // Raw strings r"..."
     if (c == 'r' && peek() == '"') {
         advance(); // consume '"'
-        std::string value;
-        while (!isAtEnd() && peek() != '"') {
-            value += advance();
-        }
+        size_t start = current;
+        advanceTo(scan.findByte(input.data() + current, input.data() + input.size(), '"') - input.data());
+        std::string_view value = input.substr(start, current - start);
         if (!isAtEnd()) advance(); // consume closing '"'
         return Token(TokenType::TOK_RAW_STRING, value, startLine, startColumn);
     }
@@ -493,59 +506,60 @@ Token Lexer::nextToken() {
 Token Lexer::number() {
     int startLine = line;
     int startColumn = column;
-    std::string value;
+    size_t start = current;
     bool hasDecimal = false;
     bool hasExponent = false;
+    bool hasSeparator = false;
     
     // Integer part
     while (!isAtEnd() && (isDigit(peek()) || peek() == '_')) {
-        if (peek() != '_') {
-            value += advance();
-        } else {
-            advance(); // skip underscore separators
-        }
+        if (peek() == '_') hasSeparator = true; // underscore separators are dropped below
+        advance();
     }
     
     // Decimal part
     if (!isAtEnd() && peek() == '.' && isDigit(peekNext())) {
         hasDecimal = true;
-        value += advance(); // consume '.'
+        advance(); // consume '.'
         while (!isAtEnd() && (isDigit(peek()) || peek() == '_')) {
-            if (peek() != '_') {
-                value += advance();
-            } else {
-                advance(); // skip underscore separators
-            }
+            if (peek() == '_') hasSeparator = true;
+            advance();
         }
     }
     
     // Scientific notation (e.g., 1e10, 2.5e-3, 10E+5)
     if (!isAtEnd() && (peek() == 'e' || peek() == 'E')) {
         hasExponent = true;
-        value += advance(); // consume 'e' or 'E'
+        advance(); // consume 'e' or 'E'
         
         // Optional + or - after exponent
         if (!isAtEnd() && (peek() == '+' || peek() == '-')) {
-            value += advance();
+            advance();
         }
         
         // Exponent digits
         if (!isAtEnd() && isDigit(peek())) {
             while (!isAtEnd() && (isDigit(peek()) || peek() == '_')) {
-                if (peek() != '_') {
-                    value += advance();
-                } else {
-                    advance(); // skip underscore separators
-                }
+                if (peek() == '_') hasSeparator = true;
+                advance();
             }
         } else {
-            std::string lineContent = getCurrentLineContent();
-            ErrorContext context("", line, column, lineContent, "");
-            REPORT_ERROR(ErrorCode::INVALID_NUMBER, "Invalid scientific notation", context);
+            ErrorContext context = g_errorHandler.createContext(source.getName(), line, column);
+            if (reportErrors) REPORT_ERROR(ErrorCode::INVALID_NUMBER, "Invalid scientific notation", context);
             throw std::runtime_error("Invalid scientific notation");
         }
     }
     
+    std::string_view value = input.substr(start, current - start);
+    if (hasSeparator) {
+        std::string digits;
+        digits.reserve(value.size());
+        for (char c : value) {
+            if (c != '_') digits += c;
+        }
+        value = source.storeDecoded(std::move(digits));
+    }
+    
     if (hasExponent) {
         return Token(TokenType::TOK_SCIENTIFIC, value, startLine, startColumn);
     } else {
@@ -556,8 +570,17 @@ Token Lexer::number() {
 Token Lexer::stringLiteral(char quote) {
     int startLine = line;
     int startColumn = column - 1; // account for opening quote
-    std::string value;
+    size_t start = current;
+    
+    // Literals without escapes are returned as a view into the source
+    advanceTo(scan.findEither(input.data() + current, input.data() + input.size(), quote, '\\') - input.data());
+    if (!isAtEnd() && peek() == quote) {
+        std::string_view value = input.substr(start, current - start);
+        advance(); // consume closing quote
+        return Token(TokenType::TOK_STRING, value, startLine, startColumn);
+    }
     
+    std::string value(input.substr(start, current - start));
     while (!isAtEnd() && peek() != quote) {
         char c = advance();
         if (c == '\\' && !isAtEnd()) {
@@ -579,22 +602,29 @@ Token Lexer::stringLiteral(char quote) {
     }
     
     if (isAtEnd()) {
-        std::string lineContent = getCurrentLineContent();
-        ErrorContext context("", startLine, startColumn, lineContent, "");
-        REPORT_ERROR(ErrorCode::UNTERMINATED_STRING, "", context);
+        ErrorContext context = g_errorHandler.createContext(source.getName(), startLine, startColumn);
+        if (reportErrors) REPORT_ERROR(ErrorCode::UNTERMINATED_STRING, "", context);
         throw std::runtime_error("Unterminated string");
     }
     
     advance(); // consume closing quote
     
-    return Token(TokenType::TOK_STRING, value, startLine, startColumn);
+    return Token(TokenType::TOK_STRING, source.storeDecoded(std::move(value)), startLine, startColumn);
 }
 
 Token Lexer::templateString() {
     int startLine = line;
     int startColumn = column - 1; // account for opening backtick
-    std::string value;
+    size_t start = current;
+    
+    advanceTo(scan.findEither(input.data() + current, input.data() + input.size(), '`', '\\') - input.data());
+    if (!isAtEnd() && peek() == '`') {
+        std::string_view value = input.substr(start, current - start);
+        advance(); // consume closing backtick
+        return Token(TokenType::TOK_STRING, value, startLine, startColumn);
+    }
     
+    std::string value(input.substr(start, current - start));
     while (!isAtEnd() && peek() != '`') {
         char c = advance();
         if (c == '\\' && !isAtEnd()) {
@@ -614,39 +644,44 @@ Token Lexer::templateString() {
     }
     
     if (isAtEnd()) {
-        std::string lineContent = getCurrentLineContent();
-        ErrorContext context("", startLine, startColumn, lineContent, "");
-        REPORT_ERROR(ErrorCode::UNTERMINATED_STRING, "Unterminated template string", context);
+        ErrorContext context = g_errorHandler.createContext(source.getName(), startLine, startColumn);
+        if (reportErrors) REPORT_ERROR(ErrorCode::UNTERMINATED_STRING, "Unterminated template string", context);
         throw std::runtime_error("Unterminated template string");
     }
     
     advance(); // consume closing backtick
     
-    return Token(TokenType::TOK_STRING, value, startLine, startColumn);
+    return Token(TokenType::TOK_STRING, source.storeDecoded(std::move(value)), startLine, startColumn);
 }
 
 Token Lexer::identifier() {
     int startLine = line;
     int startColumn = column;
-    std::string value;
+    size_t start = current;
     
-    while (!isAtEnd() && (isAlphaNumeric(peek()) || peek() == '_')) {
-        value += advance();
+    // Identifiers never contain newlines, so only the column moves. Short
+    // identifiers are finished inline before falling back to the kernel.
+    const char* end = input.data() + current;
+    const char* limit = input.data() + std::min(input.size(), current + 8);
+    while (end < limit && (isAlphaNumeric(*end) || *end == '_')) end++;
+    if (end == limit) {
+        end = scan.skipIdentifier(end, input.data() + input.size());
     }
+    column += static_cast<int>(end - (input.data() + current));
+    current = end - input.data();
+    std::string_view value = input.substr(start, current - start);
     
     // Check if it's a keyword
-    auto it = keywords.find(value);
-    if (it != keywords.end()) {
-        return Token(it->second, value, startLine, startColumn);
+    if (const KeywordEntry* keyword = lookupKeyword(value)) {
+        return Token(keyword->type, value, startLine, startColumn);
     }
     
-    // Check if it's a built-in method (for semantic analysis)
-    if (builtinMethods.find(value) != builtinMethods.end()) {
-        // We'll handle built-in method recognition in the parser
-        // For now, treat them as regular identifiers
-    }
+    // Built-in methods (see isBuiltinMethod) are recognised by the parser;
+    // here they are regular identifiers
     
-    return Token(TokenType::TOK_IDENTIFIER, value, startLine, startColumn);
+    Token token(TokenType::TOK_IDENTIFIER, value, startLine, startColumn);
+    token.symbol = StringInterner::global().intern(value);
+    return token;
 }
 
 char Lexer::peek() {
@@ -674,43 +709,47 @@ char Lexer::advance() {
     return c;
 }
 
+void Lexer::advanceTo(size_t target) {
+    // Bulk version of advance(): line/column are updated by counting the
+    // newlines in the skipped block instead of inspecting every byte
+    const char* begin = input.data() + current;
+    const char* end = input.data() + target;
+    size_t newlines = scan.countNewlines(begin, end);
+    if (newlines == 0) {
+        column += static_cast<int>(target - current);
+    } else {
+        const char* lastNewline = end - 1;
+        while (*lastNewline != '\n') lastNewline--;
+        line += static_cast<int>(newlines);
+        column = static_cast<int>(end - lastNewline);
+    }
+    current = target;
+}
+
 void Lexer::skipWhitespace() {
-    while (!isAtEnd()) {
-        char c = peek();
-        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
-            advance();
-        } else {
-            break;
+    // Most tokens are separated by nothing or a single space; only hand
+    // longer runs (indentation, blank lines) to the vector kernel
+    if (isAtEnd() || (peek() != ' ' && peek() != '\t' && peek() != '\r' && peek() != '\n')) return;
+    if (peek() == ' ') {
+        char next = peekNext();
+        if (next != ' ' && next != '\t' && next != '\r' && next != '\n') {
+            current++;
+            column++;
+            return;
         }
     }
+    advanceTo(scan.skipWhitespace(input.data() + current, input.data() + input.size()) - input.data());
 }
 
 void Lexer::skipComment() {
     // Skip single-line comment
-    while (!isAtEnd() && peek() != '\n') {
-        advance();
-    }
+    advanceTo(scan.findByte(input.data() + current, input.data() + input.size(), '\n') - input.data());
 }
 
 bool Lexer::isAtEnd() {
     return current >= input.length();
 }
 
-std::string Lexer::getCurrentLineContent() const {
-    std::stringstream ss(input);
-    std::string line;
-    int currentLine = 1;
-    
-    while (std::getline(ss, line)) {
-        if (currentLine == this->line) {
-            return line;
-        }
-        currentLine++;
-    }
-    
-    return "";
-}
-
 bool Lexer::isAlpha(char c) {
     return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
 }
@@ -1,26 +1,35 @@
 #pragma once
 #include "Token.h"
 #include "ErrorHandler.h"
+#include "SourceBuffer.h"
+#include "LexerScan.h"
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
-#include <unordered_set>
+
+// Byte range of a source buffer that can be lexed independently: it starts
+// right after a newline that lies outside every string and comment.
+struct LexChunk {
+    size_t begin;
+    size_t end;
+    int startLine;
+};
 
 class Lexer {
 private:
-    std::string input;
+    SourceBuffer& source;
+    std::string_view input;
     size_t position;
     size_t current;
     int line;
     int column;
-    std::unordered_map<std::string, TokenType> keywords;
-    std::unordered_set<std::string> builtinMethods;
+    const LexerScan::Kernels& scan;
+    bool reportErrors = true;  // chunk lexers stay quiet; the serial retry reports
     
-    void initializeKeywords();
-    void initializeBuiltinMethods();
     char peek();
     char peekNext();
     char advance();
+    void advanceTo(size_t target);
     void skipWhitespace();
     void skipComment();
     Token string();
@@ -35,8 +44,20 @@ private:
     bool match(char expected);
     
 public:
-    Lexer(const std::string& input);
+    // The lexer and every token it produces borrow from `source`.
+    Lexer(SourceBuffer& source);
+    // Lexes only source[chunk.begin, chunk.end), numbering lines from chunk.startLine
+    Lexer(SourceBuffer& source, const LexChunk& chunk);
     std::vector<Token> tokenize();
+    
+    // Same token stream as tokenize(), produced by lexing newline-aligned
+    // chunks on `threads` workers. Inputs smaller than two chunks of
+    // `minChunkBytes` are lexed serially. Must be called on a fresh Lexer.
+    std::vector<Token> tokenizeParallel(unsigned threads, size_t minChunkBytes = 256 * 1024);
+    
+    // Pre-scan that splits `text` into about `chunkCount` chunks
+    static std::vector<LexChunk> splitIntoChunks(std::string_view text, size_t chunkCount);
     Token nextToken();
-    std::string getCurrentLineContent() const;
+    
+    static bool isBuiltinMethod(std::string_view name);
 }; 
\ No newline at end of file
@@ -0,0 +1,367 @@
+#include "LexerScan.h"
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FLAST_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace LexerScan {
+
+namespace {
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline bool isIdentChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// ---------------------------------------------------------------------------
+// Scalar kernels (also used for the tails of the vector kernels)
+// ---------------------------------------------------------------------------
+
+const char* skipWhitespaceScalar(const char* p, const char* end) {
+    while (p < end && isSpace(*p)) p++;
+    return p;
+}
+
+const char* skipIdentifierScalar(const char* p, const char* end) {
+    while (p < end && isIdentChar(*p)) p++;
+    return p;
+}
+
+const char* findByteScalar(const char* p, const char* end, char c) {
+    while (p < end && *p != c) p++;
+    return p;
+}
+
+const char* findEitherScalar(const char* p, const char* end, char a, char b) {
+    while (p < end && *p != a && *p != b) p++;
+    return p;
+}
+
+const char* findAny4Scalar(const char* p, const char* end, char a, char b, char c, char d) {
+    while (p < end && *p != a && *p != b && *p != c && *p != d) p++;
+    return p;
+}
+
+const char* findBlockCommentEndScalar(const char* p, const char* end) {
+    while (p + 1 < end && !(p[0] == '*' && p[1] == '/')) p++;
+    return p + 1 < end ? p : end;
+}
+
+size_t countNewlinesScalar(const char* p, const char* end) {
+    size_t count = 0;
+    for (; p < end; p++) {
+        count += (*p == '\n');
+    }
+    return count;
+}
+
+#ifdef FLAST_SCAN_X86
+
+// ---------------------------------------------------------------------------
+// SSE2 kernels (baseline on x86-64)
+// ---------------------------------------------------------------------------
+
+inline __m128i inRange128(__m128i v, char lo, char hi) {
+    // All ranges tested here are ASCII, so signed comparisons are safe:
+    // bytes >= 0x80 are negative and fall outside every range.
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+}
+
+inline __m128i identMask128(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20)); // fold A-Z onto a-z
+    __m128i m = _mm_or_si128(inRange128(lower, 'a', 'z'), inRange128(v, '0', '9'));
+    return _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+}
+
+inline __m128i spaceMask128(__m128i v) {
+    __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+    return _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')),
+                                        _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+}
+
+const char* skipWhitespaceSSE2(const char* p, const char* end) {
+    for (; p + 16 <= end; p += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(spaceMask128(v))) & 0xFFFFu;
+        if (stop) return p + __builtin_ctz(stop);
+    }
+    return skipWhitespaceScalar(p, end);
+}
+
+const char* skipIdentifierSSE2(const char* p, const char* end) {
+    for (; p + 16 <= end; p += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(identMask128(v))) & 0xFFFFu;
+        if (stop) return p + __builtin_ctz(stop);
+    }
+    return skipIdentifierScalar(p, end);
+}
+
+const char* findByteSSE2(const char* p, const char* end, char c) {
+    __m128i needle = _mm_set1_epi8(c);
+    for (; p + 16 <= end; p += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned hit = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)));
+        if (hit) return p + __builtin_ctz(hit);
+    }
+    return findByteScalar(p, end, c);
+}
+
+const char* findEitherSSE2(const char* p, const char* end, char a, char b) {
+    __m128i na = _mm_set1_epi8(a);
+    __m128i nb = _mm_set1_epi8(b);
+    for (; p + 16 <= end; p += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, na), _mm_cmpeq_epi8(v, nb));
+        unsigned hit = static_cast<unsigned>(_mm_movemask_epi8(m));
+        if (hit) return p + __builtin_ctz(hit);
+    }
+    return findEitherScalar(p, end, a, b);
+}
+
+const char* findAny4SSE2(const char* p, const char* end, char a, char b, char c, char d) {
+    __m128i na = _mm_set1_epi8(a);
+    __m128i nb = _mm_set1_epi8(b);
+    __m128i nc = _mm_set1_epi8(c);
+    __m128i nd = _mm_set1_epi8(d);
+    for (; p + 16 <= end; p += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, na), _mm_cmpeq_epi8(v, nb)),
+                                 _mm_or_si128(_mm_cmpeq_epi8(v, nc), _mm_cmpeq_epi8(v, nd)));
+        unsigned hit = static_cast<unsigned>(_mm_movemask_epi8(m));
+        if (hit) return p + __builtin_ctz(hit);
+    }
+    return findAny4Scalar(p, end, a, b, c, d);
+}
+
+const char* findBlockCommentEndSSE2(const char* p, const char* end) {
+    __m128i star = _mm_set1_epi8('*');
+    __m128i slash = _mm_set1_epi8('/');
+    // Compare each block with itself shifted by one byte so "*/" pairs that
+    // straddle the block boundary are still found.
+    for (; p + 17 <= end; p += 16) {
+        __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+        __m128i m = _mm_and_si128(_mm_cmpeq_epi8(v0, star), _mm_cmpeq_epi8(v1, slash));
+        unsigned hit = static_cast<unsigned>(_mm_movemask_epi8(m));
+        if (hit) return p + __builtin_ctz(hit);
+    }
+    return findBlockCommentEndScalar(p, end);
+}
+
+size_t countNewlinesSSE2(const char* p, const char* end) {
+    __m128i newline = _mm_set1_epi8('\n');
+    __m128i zero = _mm_setzero_si128();
+    size_t count = 0;
+    while (p + 16 <= end) {
+        // Per-byte counters saturate after 255 blocks; fold them into the
+        // total with a sum-of-absolute-differences before that happens.
+        __m128i acc = zero;
+        for (int i = 0; i < 255 && p + 16 <= end; i++, p += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(v, newline));
+        }
+        __m128i sums = _mm_sad_epu8(acc, zero);
+        count += static_cast<size_t>(_mm_cvtsi128_si32(sums)) +
+                 static_cast<size_t>(_mm_cvtsi128_si32(_mm_unpackhi_epi64(sums, sums)));
+    }
+    return count + countNewlinesScalar(p, end);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 kernels (selected at runtime)
+// ---------------------------------------------------------------------------
+
+#define FLAST_AVX2 __attribute__((target("avx2")))
+
+FLAST_AVX2 inline __m256i inRange256(__m256i v, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+}
+
+FLAST_AVX2 inline __m256i identMask256(__m256i v) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i m = _mm256_or_si256(inRange256(lower, 'a', 'z'), inRange256(v, '0', '9'));
+    return _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+}
+
+FLAST_AVX2 inline __m256i spaceMask256(__m256i v) {
+    __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+    return _mm256_or_si256(m, _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')),
+                                              _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+}
+
+FLAST_AVX2 const char* skipWhitespaceAVX2(const char* p, const char* end) {
+    for (; p + 32 <= end; p += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(spaceMask256(v)));
+        if (stop) return p + __builtin_ctz(stop);
+    }
+    return skipWhitespaceSSE2(p, end);
+}
+
+FLAST_AVX2 const char* skipIdentifierAVX2(const char* p, const char* end) {
+    for (; p + 32 <= end; p += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(identMask256(v)));
+        if (stop) return p + __builtin_ctz(stop);
+    }
+    return skipIdentifierSSE2(p, end);
+}
+
+FLAST_AVX2 const char* findByteAVX2(const char* p, const char* end, char c) {
+    __m256i needle = _mm256_set1_epi8(c);
+    for (; p + 32 <= end; p += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned hit = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+        if (hit) return p + __builtin_ctz(hit);
+    }
+    return findByteSSE2(p, end, c);
+}
+
+FLAST_AVX2 const char* findEitherAVX2(const char* p, const char* end, char a, char b) {
+    __m256i na = _mm256_set1_epi8(a);
+    __m256i nb = _mm256_set1_epi8(b);
+    for (; p + 32 <= end; p += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, na), _mm256_cmpeq_epi8(v, nb));
+        unsigned hit = static_cast<unsigned>(_mm256_movemask_epi8(m));
+        if (hit) return p + __builtin_ctz(hit);
+    }
+    return findEitherSSE2(p, end, a, b);
+}
+
+FLAST_AVX2 const char* findAny4AVX2(const char* p, const char* end, char a, char b, char c, char d) {
+    __m256i na = _mm256_set1_epi8(a);
+    __m256i nb = _mm256_set1_epi8(b);
+    __m256i nc = _mm256_set1_epi8(c);
+    __m256i nd = _mm256_set1_epi8(d);
+    for (; p + 32 <= end; p += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, na), _mm256_cmpeq_epi8(v, nb)),
+                                    _mm256_or_si256(_mm256_cmpeq_epi8(v, nc), _mm256_cmpeq_epi8(v, nd)));
+        unsigned hit = static_cast<unsigned>(_mm256_movemask_epi8(m));
+        if (hit) return p + __builtin_ctz(hit);
+    }
+    return findAny4SSE2(p, end, a, b, c, d);
+}
+
+FLAST_AVX2 const char* findBlockCommentEndAVX2(const char* p, const char* end) {
+    __m256i star = _mm256_set1_epi8('*');
+    __m256i slash = _mm256_set1_epi8('/');
+    for (; p + 33 <= end; p += 32) {
+        __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+        __m256i m = _mm256_and_si256(_mm256_cmpeq_epi8(v0, star), _mm256_cmpeq_epi8(v1, slash));
+        unsigned hit = static_cast<unsigned>(_mm256_movemask_epi8(m));
+        if (hit) return p + __builtin_ctz(hit);
+    }
+    return findBlockCommentEndSSE2(p, end);
+}
+
+FLAST_AVX2 size_t countNewlinesAVX2(const char* p, const char* end) {
+    __m256i newline = _mm256_set1_epi8('\n');
+    __m256i zero = _mm256_setzero_si256();
+    size_t count = 0;
+    while (p + 32 <= end) {
+        __m256i acc = zero;
+        for (int i = 0; i < 255 && p + 32 <= end; i++, p += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(v, newline));
+        }
+        __m256i sums = _mm256_sad_epu8(acc, zero);
+        count += static_cast<size_t>(_mm256_extract_epi64(sums, 0)) +
+                 static_cast<size_t>(_mm256_extract_epi64(sums, 1)) +
+                 static_cast<size_t>(_mm256_extract_epi64(sums, 2)) +
+                 static_cast<size_t>(_mm256_extract_epi64(sums, 3));
+    }
+    return count + countNewlinesSSE2(p, end);
+}
+
+#undef FLAST_AVX2
+
+#endif // FLAST_SCAN_X86
+
+const Kernels scalarKernels = {
+    Level::Scalar,
+    skipWhitespaceScalar, skipIdentifierScalar, findByteScalar,
+    findEitherScalar, findAny4Scalar, findBlockCommentEndScalar, countNewlinesScalar
+};
+
+#ifdef FLAST_SCAN_X86
+const Kernels sse2Kernels = {
+    Level::SSE2,
+    skipWhitespaceSSE2, skipIdentifierSSE2, findByteSSE2,
+    findEitherSSE2, findAny4SSE2, findBlockCommentEndSSE2, countNewlinesSSE2
+};
+
+const Kernels avx2Kernels = {
+    Level::AVX2,
+    skipWhitespaceAVX2, skipIdentifierAVX2, findByteAVX2,
+    findEitherAVX2, findAny4AVX2, findBlockCommentEndAVX2, countNewlinesAVX2
+};
+#endif
+
+const Kernels* kernelsFor(Level level) {
+#ifdef FLAST_SCAN_X86
+    switch (level) {
+        case Level::AVX2: return &avx2Kernels;
+        case Level::SSE2: return &sse2Kernels;
+        case Level::Scalar: break;
+    }
+#else
+    (void)level;
+#endif
+    return &scalarKernels;
+}
+
+Level detectLevel() {
+#ifdef FLAST_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Level::AVX2;
+    if (__builtin_cpu_supports("sse2")) return Level::SSE2;
+#endif
+    return Level::Scalar;
+}
+
+std::atomic<const Kernels*>& activeKernels() {
+    static std::atomic<const Kernels*> kernels{kernelsFor(detectLevel())};
+    return kernels;
+}
+
+} // namespace
+
+const Kernels& active() {
+    return *activeKernels().load(std::memory_order_acquire);
+}
+
+Level bestLevel() {
+    static const Level level = detectLevel();
+    return level;
+}
+
+Level setLevel(Level level) {
+    if (static_cast<int>(level) > static_cast<int>(bestLevel())) {
+        level = bestLevel();
+    }
+    activeKernels().store(kernelsFor(level), std::memory_order_release);
+    return level;
+}
+
+const char* levelName(Level level) {
+    switch (level) {
+        case Level::Scalar: return "scalar";
+        case Level::SSE2: return "sse2";
+        case Level::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+} // namespace LexerScan
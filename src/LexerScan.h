@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+
+// Vectorised scanning kernels used by the Lexer's hot loops.
+//
+// Every kernel takes a half-open range [begin, end) and returns a pointer to
+// the first byte that stops the scan (or `end`). Kernels never read past
+// `end`. The implementation is picked once at startup from the host CPU
+// (AVX2, then SSE2, then portable scalar code) and can be overridden, which
+// the lexer benchmark uses to compare the paths.
+namespace LexerScan {
+
+enum class Level {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+struct Kernels {
+    Level level;
+    // First byte that is not ' ', '\t', '\r' or '\n'
+    const char* (*skipWhitespace)(const char* begin, const char* end);
+    // First byte that is not [A-Za-z0-9_]
+    const char* (*skipIdentifier)(const char* begin, const char* end);
+    // First occurrence of `c`
+    const char* (*findByte)(const char* begin, const char* end, char c);
+    // First occurrence of `a` or `b` (string bodies stop at quote or backslash)
+    const char* (*findEither)(const char* begin, const char* end, char a, char b);
+    // First occurrence of any of `a`, `b`, `c`, `d`
+    const char* (*findAny4)(const char* begin, const char* end, char a, char b, char c, char d);
+    // Start of the first "*/" sequence
+    const char* (*findBlockCommentEnd)(const char* begin, const char* end);
+    // Number of '\n' bytes in the range
+    size_t (*countNewlines)(const char* begin, const char* end);
+};
+
+// Kernels currently in use
+const Kernels& active();
+
+// Best level supported by the host CPU
+Level bestLevel();
+
+// Select a specific implementation. Levels the host cannot run are clamped
+// to bestLevel(). Returns the level actually selected.
+Level setLevel(Level level);
+
+const char* levelName(Level level);
+
+} // namespace LexerScan
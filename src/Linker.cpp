@@ -0,0 +1,291 @@
+#include "Linker.h"
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/Triple.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+
+#ifdef FLAST_HAVE_LLD
+#include <lld/Common/Driver.h>
+#endif
+
+namespace {
+
+// Startup files, search paths and loader a driver like gcc would pass to ld
+struct CRuntime {
+    std::string emulation;
+    std::string dynamicLinker;
+    std::vector<std::string> startFiles;
+    std::vector<std::string> endFiles;
+    std::vector<std::string> searchDirs;
+};
+
+bool isCompilerDriver(const std::string& spec) {
+    std::string name = std::filesystem::path(spec).filename().string();
+    return name == "cc" || name == "gcc" || name == "clang" || name == "c++" ||
+           name == "g++" || name == "clang++" || llvm::StringRef(name).startswith("gcc-") ||
+           llvm::StringRef(name).startswith("clang-");
+}
+
+bool lldAvailable() {
+#ifdef FLAST_HAVE_LLD
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::string findFile(const std::vector<std::string>& dirs, const std::string& name) {
+    for (const auto& dir : dirs) {
+        auto path = std::filesystem::path(dir) / name;
+        if (std::filesystem::exists(path)) return path.string();
+    }
+    return "";
+}
+
+// Newest <root>/<triple>/<version>/ holding crtbegin.o, compared numerically
+// so that 12 beats 9
+std::string findGccDir(const std::vector<std::string>& roots) {
+    std::string best;
+    std::vector<unsigned> bestVersion;
+    for (const auto& root : roots) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(root, ec)) continue;
+        for (const auto& entry : std::filesystem::directory_iterator(root, ec)) {
+            if (!std::filesystem::exists(entry.path() / "crtbegin.o")) continue;
+            std::vector<unsigned> version;
+            llvm::SmallVector<llvm::StringRef, 4> parts;
+            llvm::StringRef(entry.path().filename().string()).split(parts, '.');
+            for (auto part : parts) {
+                unsigned number = 0;
+                if (part.getAsInteger(10, number)) break;
+                version.push_back(number);
+            }
+            if (!version.empty() && (best.empty() || version > bestVersion)) {
+                best = entry.path().string();
+                bestVersion = version;
+            }
+        }
+    }
+    return best;
+}
+
+// Returns false when this host's C runtime layout is not one we know; the
+// caller then leaves linking to a compiler driver
+bool discoverCRuntime(CRuntime& runtime) {
+    llvm::Triple triple(llvm::sys::getDefaultTargetTriple());
+    if (!triple.isOSLinux()) return false;
+
+    std::string multiarch;
+    switch (triple.getArch()) {
+        case llvm::Triple::x86_64:
+            runtime.emulation = "elf_x86_64";
+            runtime.dynamicLinker = "/lib64/ld-linux-x86-64.so.2";
+            multiarch = "x86_64-linux-gnu";
+            break;
+        case llvm::Triple::aarch64:
+            runtime.emulation = "aarch64linux";
+            runtime.dynamicLinker = "/lib/ld-linux-aarch64.so.1";
+            multiarch = "aarch64-linux-gnu";
+            break;
+        default:
+            return false;
+    }
+    if (!std::filesystem::exists(runtime.dynamicLinker)) return false;
+
+    std::vector<std::string> libDirs = {
+        "/usr/lib/" + multiarch, "/lib/" + multiarch, "/usr/lib64", "/lib64", "/usr/lib", "/lib",
+    };
+    std::string gccDir = findGccDir({"/usr/lib/gcc/" + multiarch, "/usr/lib/gcc/" + triple.str(),
+                                     "/usr/lib64/gcc/" + triple.str()});
+    if (gccDir.empty()) return false;
+
+    std::string crt1 = findFile(libDirs, "crt1.o");
+    std::string crti = findFile(libDirs, "crti.o");
+    std::string crtn = findFile(libDirs, "crtn.o");
+    if (crt1.empty() || crti.empty() || crtn.empty()) return false;
+
+    runtime.startFiles = {crt1, crti, gccDir + "/crtbegin.o"};
+    runtime.endFiles = {gccDir + "/crtend.o", crtn};
+    runtime.searchDirs.push_back(gccDir);
+    for (const auto& dir : libDirs) {
+        if (std::filesystem::is_directory(dir)) runtime.searchDirs.push_back(dir);
+    }
+    return true;
+}
+
+const CRuntime* getCRuntime() {
+    static CRuntime runtime;
+    static bool found = discoverCRuntime(runtime);
+    return found ? &runtime : nullptr;
+}
+
+bool isLLD(const std::string& program) {
+    return std::filesystem::path(program).filename().string().find("lld") != std::string::npos;
+}
+
+// LTO options in the gold plugin's spelling, which LLD accepts too. LLD
+// has LTO built in; every other linker loads LLVMgold.so for it.
+std::vector<std::string> ltoArguments(const Linker::LTOOptions& lto, bool lld) {
+    std::vector<std::string> args;
+    if (!lto.enabled) return args;
+    
+    if (!lld) {
+#ifdef FLAST_LLVM_GOLD_PLUGIN
+        args.push_back("-plugin");
+        args.push_back(FLAST_LLVM_GOLD_PLUGIN);
+#else
+        throw std::runtime_error("--lto needs LLD or LLVM's gold plugin (LLVMgold.so), and neither was found");
+#endif
+    }
+    
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    args.push_back("-plugin-opt=O" + std::to_string(lto.optLevel));
+    args.push_back("-plugin-opt=mcpu=" + lto.cpu);
+    if (!lto.features.empty()) args.push_back("-plugin-opt=-mattr=" + lto.features);
+    if (lto.thin) {
+        // Backends run on every core and are reused from the cache while
+        // their module, its imports and these options are unchanged
+        args.push_back("-plugin-opt=thinlto");
+        args.push_back("-plugin-opt=jobs=" + std::to_string(jobs));
+        if (!lto.cacheDir.empty()) args.push_back("-plugin-opt=cache-dir=" + lto.cacheDir);
+    } else {
+        // The merged module is code-generated in parallel partitions
+        args.push_back("-plugin-opt=lto-partitions=" + std::to_string(jobs));
+    }
+    return args;
+}
+
+// Argument list for ld-compatible linkers, argv[0] included
+std::vector<std::string> linkerArguments(const std::string& program, const CRuntime& runtime,
+                                         const Linker::Job& job) {
+    std::vector<std::string> args = {
+        program, "--eh-frame-hdr", "-m", runtime.emulation,
+        "-dynamic-linker", runtime.dynamicLinker, "-o", job.output,
+    };
+    args.insert(args.end(), runtime.startFiles.begin(), runtime.startFiles.end());
+    for (const auto& dir : runtime.searchDirs) args.push_back("-L" + dir);
+    auto lto = ltoArguments(job.lto, isLLD(program));
+    args.insert(args.end(), lto.begin(), lto.end());
+    args.insert(args.end(), job.objects.begin(), job.objects.end());
+    // Same libraries, in the same order, as gcc's default link
+    args.push_back("--as-needed");
+    for (const auto& library : job.libraries) args.push_back("-l" + library);
+    for (const char* library : {"-lgcc", "-lgcc_s", "-lc", "-lgcc", "-lgcc_s"}) {
+        args.push_back(library);
+    }
+    args.push_back("--no-as-needed");
+    args.insert(args.end(), runtime.endFiles.begin(), runtime.endFiles.end());
+    return args;
+}
+
+std::vector<std::string> driverArguments(const std::string& program, const Linker::Job& job) {
+    std::vector<std::string> args = {program, "-no-pie"};
+    auto lto = ltoArguments(job.lto, false);
+    for (size_t i = 0; i < lto.size(); i++) {
+        // -Wl,-plugin,<path> keeps the pair together
+        if (lto[i] == "-plugin" && i + 1 < lto.size()) {
+            args.push_back("-Wl,-plugin," + lto[++i]);
+        } else {
+            args.push_back("-Wl," + lto[i]);
+        }
+    }
+    args.insert(args.end(), job.objects.begin(), job.objects.end());
+    for (const auto& library : job.libraries) args.push_back("-l" + library);
+    args.push_back("-o");
+    args.push_back(job.output);
+    return args;
+}
+
+std::string findProgram(const std::string& spec) {
+    if (spec.find('/') != std::string::npos) {
+        if (!std::filesystem::exists(spec)) {
+            throw std::runtime_error("Linker not found: " + spec);
+        }
+        return spec;
+    }
+    auto program = llvm::sys::findProgramByName(spec);
+    if (!program) {
+        throw std::runtime_error("Linker not found on PATH: " + spec);
+    }
+    return *program;
+}
+
+void runProgram(const std::vector<std::string>& args) {
+    std::vector<llvm::StringRef> argv(args.begin(), args.end());
+    std::string error;
+    int result = llvm::sys::ExecuteAndWait(args[0], argv, llvm::None, {}, 0, 0, &error);
+    if (result != 0) {
+        throw std::runtime_error("Linking failed" + (error.empty() ? "" : ": " + error));
+    }
+}
+
+#ifdef FLAST_HAVE_LLD
+void runLLD(const std::vector<std::string>& args) {
+    std::vector<const char*> argv;
+    for (const auto& arg : args) argv.push_back(arg.c_str());
+    // Keep LLD from exiting the process and let it free its state, so the
+    // compiler can carry on (and link again) after a failure
+    if (!lld::elf::link(argv, llvm::outs(), llvm::errs(), false, false)) {
+        throw std::runtime_error("Linking failed");
+    }
+}
+#endif
+
+// "auto" resolved to the linker it stands for on this host
+std::string resolveSpec(const std::string& spec) {
+    if (spec != "auto") return spec;
+    // Linking directly, in-process or not, needs the C runtime's objects;
+    // without them only the compiler driver knows how to link. Fastest first
+    if (getCRuntime()) {
+        if (lldAvailable()) return "lld";
+        for (const char* candidate : {"ld.lld", "mold", "ld.gold", "ld"}) {
+            if (llvm::sys::findProgramByName(candidate)) return candidate;
+        }
+    }
+    return "cc";
+}
+
+} // namespace
+
+std::string Linker::describe(const std::string& spec) {
+    std::string resolved = resolveSpec(spec);
+    if (resolved == "lld") return lldAvailable() ? "lld (in-process)" : "lld (not built in)";
+    auto program = resolved.find('/') != std::string::npos
+        ? llvm::ErrorOr<std::string>(resolved) : llvm::sys::findProgramByName(resolved);
+    return resolved + (program ? " (" + *program + ")" : " (not found)");
+}
+
+void Linker::link(const std::string& spec, const Job& job) {
+    std::string resolved = resolveSpec(spec);
+
+    if (resolved == "lld") {
+#ifdef FLAST_HAVE_LLD
+        const CRuntime* runtime = getCRuntime();
+        if (!runtime) {
+            throw std::runtime_error("lld: could not find the C runtime (crt1.o, crtbegin.o) to link against");
+        }
+        runLLD(linkerArguments("ld.lld", *runtime, job));
+        return;
+#else
+        throw std::runtime_error("This flast was built without LLD; use --linker=ld or --linker=cc");
+#endif
+    }
+
+    std::string program = findProgram(resolved);
+    if (isCompilerDriver(resolved)) {
+        runProgram(driverArguments(program, job));
+        return;
+    }
+
+    const CRuntime* runtime = getCRuntime();
+    if (!runtime) {
+        throw std::runtime_error(resolved + ": could not find the C runtime (crt1.o, crtbegin.o); "
+                                 "use --linker=cc");
+    }
+    runProgram(linkerArguments(program, *runtime, job));
+}
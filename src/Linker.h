@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Links object files into an executable without going through a shell.
+//
+// The linker is chosen by name, as given to --linker=:
+//   auto   LLD in-process when flast was built against it, else the fastest
+//          of ld.lld, mold, ld.gold and ld driven directly with a discovered
+//          C runtime, else cc
+//   lld    LLD in-process (only when built with FLAST_HAVE_LLD)
+//   ld, ld.lld, ld.gold, mold, or a path to any of them
+//          run directly, with the C runtime startup files and libraries
+//          passed explicitly
+//   cc, gcc, clang, or a path to one
+//          a compiler driver, which finds the C runtime itself
+namespace Linker {
+
+// Link-time optimisation of bitcode objects, done by the linker: LLD
+// natively, ld.gold, ld.bfd and mold through LLVM's gold plugin
+struct LTOOptions {
+    bool enabled = false;
+    bool thin = true;          // ThinLTO; false for one merged (full) LTO module
+    unsigned optLevel = 2;     // 0-3; -Os and -Oz run as 2
+    std::string cpu = "generic";
+    std::string features;      // "+avx2,-fma"
+    std::string cacheDir;      // ThinLTO backend results, keyed by LTO's own hashes
+};
+
+struct Job {
+    std::vector<std::string> objects;
+    std::vector<std::string> libraries;  // without the -l
+    std::string output;
+    LTOOptions lto;
+};
+
+// Name of the linker `spec` resolves to, e.g. "ld (/usr/bin/ld)"
+std::string describe(const std::string& spec);
+
+// Throws std::runtime_error when the linker cannot be found or fails
+void link(const std::string& spec, const Job& job);
+
+} // namespace Linker
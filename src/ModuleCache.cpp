@@ -0,0 +1,873 @@
+#include "ModuleCache.h"
+#include "TypeContext.h"
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FileUtilities.h>
+#include <llvm/Support/raw_ostream.h>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace ModuleCache;
+
+// Operand encoding per node kind (unused operands hold kNone):
+//
+//   NumberExpr        a,b = value bits, c = original text; flags: scientific
+//   ScientificExpr    a,b = value bits, c = original text
+//   StringExpr        a = value          BoolExpr   flags: value
+//   VariableExpr      a = name           NullExpr, Break, Continue: -
+//   BinaryExpr        op, a = left, b = right
+//   UnaryExpr         op, a = operand; flags: prefix
+//   CallExpr          a = callee, b = args
+//   MemberAccessExpr  a = object, b = member; flags: safe access
+//   IndexExpr         a = object, b = index
+//   NewExpr           a = class, b = args
+//   List/Tuple/Array  b = elements
+//   MapExpr           b = pairs (key, value)
+//   LambdaExpr        a = params (name, type), b = return type, c = body
+//   BuiltinMethodExpr a = object, b = method, c = args
+//   MethodCallExpr    a = object, b = method, c = args
+//   TypeCast          a = expression, b = target type
+//   VarDeclStmt       a = name, b = type, c = initializer; flags: const, public
+//   AssignStmt        a = target, b = operator, c = value
+//   ExprStmt, ReturnStmt, ThrowStmt   a = expression
+//   BlockStmt         a = statements
+//   IfStmt            a = condition, b = then, c = else
+//   WhileStmt         a = condition, b = body
+//   ForStmt           a = init, b = condition, c = update, d = body
+//   ForInStmt         a = variable, b = iterable, c = body
+//   MatchStmt         a = value, b = arms (pattern, body)
+//   TryCatchStmt      a = try, b = variable, c = type, d = catch, e = finally
+//   StructDecl        a = name, b = fields (name, type), c = generics; flags: public
+//   EnumDecl          a = name, b = variants (name, type list), c = generics; flags: public
+//   TraitDecl         a = name, b = methods, c = generics; flags: public
+//   ImplDecl          a = target, b = trait, c = methods, d = generics
+//   FunctionDecl      a = name, b = params (name, type, default, optional),
+//                     c = return type, d = body, e = extern language;
+//                     flags: public, static, virtual, override, async, extern
+//   ImportDecl        a = module, b = alias, c = names; flags: wildcard
+//   ModuleDecl        a = name, b = declarations
+//   Program           a = declarations
+//
+// A list operand is the index of a count in the list section, followed by
+// count * stride words.
+
+namespace {
+
+enum : uint8_t {
+    kTypePointer = 1 << 0,
+    kTypeReference = 1 << 1,
+    kTypeConst = 1 << 2,
+    kTypeOptional = 1 << 3,
+};
+
+void splitDouble(double value, uint32_t& low, uint32_t& high) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    low = static_cast<uint32_t>(bits);
+    high = static_cast<uint32_t>(bits >> 32);
+}
+
+double joinDouble(uint32_t low, uint32_t high) {
+    uint64_t bits = static_cast<uint64_t>(high) << 32 | low;
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint8_t flagsOf(std::initializer_list<bool> bits) {
+    uint8_t flags = 0;
+    uint8_t bit = 1;
+    for (bool set : bits) {
+        if (set) flags |= bit;
+        bit <<= 1;
+    }
+    return flags;
+}
+
+class Writer {
+private:
+    std::vector<NodeRecord> nodes;
+    std::vector<TypeRecord> types;
+    std::vector<uint32_t> lists;
+    std::vector<StringRecord> strings;
+    std::string text;
+    // Owns its keys: building a deferred body can intern new identifiers
+    std::unordered_map<std::string, uint32_t> stringIds;
+    std::unordered_map<const TypeInfo*, uint32_t> typeIds;
+
+    uint32_t string(std::string_view value) {
+        auto [it, inserted] = stringIds.try_emplace(std::string(value), static_cast<uint32_t>(strings.size()));
+        if (inserted) {
+            strings.push_back({static_cast<uint32_t>(text.size()), static_cast<uint32_t>(value.size())});
+            text.append(value);
+        }
+        return it->second;
+    }
+
+    uint32_t string(Identifier name) {
+        return name.empty() ? kNone : string(std::string_view(name.str()));
+    }
+
+    uint32_t list(llvm::ArrayRef<uint32_t> words, uint32_t stride = 1) {
+        if (words.empty()) return kNone;
+        uint32_t id = static_cast<uint32_t>(lists.size());
+        lists.push_back(static_cast<uint32_t>(words.size() / stride));
+        lists.insert(lists.end(), words.begin(), words.end());
+        return id;
+    }
+
+    uint32_t type(const TypeInfo* info) {
+        if (!info) return kNone;
+        auto it = typeIds.find(info);
+        if (it != typeIds.end()) return it->second;
+
+        // Parameters get lower ids than their owner
+        uint32_t parameters = typeList(info->parameters);
+        TypeRecord record{};
+        record.type = static_cast<uint8_t>(info->type);
+        record.modifiers = (info->isPointer ? kTypePointer : 0) | (info->isReference ? kTypeReference : 0) |
+                           (info->isConst ? kTypeConst : 0) | (info->isOptional ? kTypeOptional : 0);
+        record.className = string(info->className);
+        record.parameters = parameters;
+        uint32_t id = static_cast<uint32_t>(types.size());
+        types.push_back(record);
+        typeIds.emplace(info, id);
+        return id;
+    }
+
+    uint32_t typeList(const ASTList<const TypeInfo*>& items) {
+        llvm::SmallVector<uint32_t, 8> ids;
+        for (const TypeInfo* item : items) ids.push_back(type(item));
+        return list(ids);
+    }
+
+    template<typename T>
+    uint32_t nodeList(const ASTList<T*>& items) {
+        llvm::SmallVector<uint32_t, 8> ids;
+        for (T* item : items) ids.push_back(node(item));
+        return list(ids);
+    }
+
+public:
+    uint32_t node(ASTNode* n);
+    void save(const std::string& path, uint32_t root);
+};
+
+uint32_t Writer::node(ASTNode* n) {
+    if (!n) return kNone;
+
+    NodeRecord r{};
+    r.kind = static_cast<uint8_t>(n->kind);
+    r.first = static_cast<uint32_t>(nodes.size());
+    r.a = r.b = r.c = r.d = r.e = kNone;
+
+    switch (n->kind) {
+        case NodeKind::NumberExpr: {
+            auto* number = static_cast<NumberExprAST*>(n);
+            splitDouble(number->value, r.a, r.b);
+            r.c = string(number->originalText);
+            r.flags = flagsOf({number->isScientific});
+            break;
+        }
+        case NodeKind::ScientificExpr: {
+            auto* number = static_cast<ScientificExprAST*>(n);
+            splitDouble(number->value, r.a, r.b);
+            r.c = string(number->originalText);
+            break;
+        }
+        case NodeKind::StringExpr:
+            r.a = string(static_cast<StringExprAST*>(n)->value);
+            break;
+        case NodeKind::BoolExpr:
+            r.flags = flagsOf({static_cast<BoolExprAST*>(n)->value});
+            break;
+        case NodeKind::NullExpr:
+        case NodeKind::BreakStmt:
+        case NodeKind::ContinueStmt:
+            break;
+        case NodeKind::VariableExpr:
+            r.a = string(static_cast<VariableExprAST*>(n)->name);
+            break;
+        case NodeKind::BinaryExpr: {
+            auto* binary = static_cast<BinaryExprAST*>(n);
+            r.op = static_cast<uint16_t>(binary->op);
+            r.a = node(binary->left);
+            r.b = node(binary->right);
+            break;
+        }
+        case NodeKind::UnaryExpr: {
+            auto* unary = static_cast<UnaryExprAST*>(n);
+            r.op = static_cast<uint16_t>(unary->op);
+            r.a = node(unary->operand);
+            r.flags = flagsOf({unary->isPrefix});
+            break;
+        }
+        case NodeKind::CallExpr: {
+            auto* call = static_cast<CallExprAST*>(n);
+            r.a = string(call->callee);
+            r.b = nodeList(call->args);
+            break;
+        }
+        case NodeKind::MemberAccessExpr: {
+            auto* access = static_cast<MemberAccessExprAST*>(n);
+            r.a = node(access->object);
+            r.b = string(access->member);
+            r.flags = flagsOf({access->isSafeAccess});
+            break;
+        }
+        case NodeKind::IndexExpr: {
+            auto* index = static_cast<IndexExprAST*>(n);
+            r.a = node(index->object);
+            r.b = node(index->index);
+            break;
+        }
+        case NodeKind::NewExpr: {
+            auto* newExpr = static_cast<NewExprAST*>(n);
+            r.a = string(newExpr->className);
+            r.b = nodeList(newExpr->args);
+            break;
+        }
+        case NodeKind::ListExpr:
+            r.b = nodeList(static_cast<ListExprAST*>(n)->elements);
+            break;
+        case NodeKind::TupleExpr:
+            r.b = nodeList(static_cast<TupleExprAST*>(n)->elements);
+            break;
+        case NodeKind::ArrayExpr:
+            r.b = nodeList(static_cast<ArrayExprAST*>(n)->elements);
+            break;
+        case NodeKind::MapExpr: {
+            llvm::SmallVector<uint32_t, 8> words;
+            for (auto& pair : static_cast<MapExprAST*>(n)->pairs) {
+                uint32_t key = node(pair.first);
+                words.push_back(key);
+                words.push_back(node(pair.second));
+            }
+            r.b = list(words, 2);
+            break;
+        }
+        case NodeKind::LambdaExpr: {
+            auto* lambda = static_cast<LambdaExprAST*>(n);
+            llvm::SmallVector<uint32_t, 8> words;
+            for (auto& param : lambda->parameters) {
+                words.push_back(string(param.first));
+                words.push_back(type(param.second));
+            }
+            r.a = list(words, 2);
+            r.b = type(lambda->returnType);
+            r.c = nodeList(lambda->body);
+            break;
+        }
+        case NodeKind::BuiltinMethodExpr: {
+            auto* call = static_cast<BuiltinMethodExprAST*>(n);
+            r.a = node(call->object);
+            r.b = string(call->methodName);
+            r.c = nodeList(call->args);
+            break;
+        }
+        case NodeKind::MethodCallExpr: {
+            auto* call = static_cast<MethodCallExprAST*>(n);
+            r.a = node(call->object);
+            r.b = string(call->method);
+            r.c = nodeList(call->args);
+            break;
+        }
+        case NodeKind::TypeCast: {
+            auto* cast = static_cast<TypeCastAST*>(n);
+            r.a = node(cast->expression);
+            r.b = type(cast->targetType);
+            break;
+        }
+        case NodeKind::VarDeclStmt: {
+            auto* var = static_cast<VarDeclStmtAST*>(n);
+            r.a = string(var->name);
+            r.b = type(var->type);
+            r.c = node(var->initializer);
+            r.flags = flagsOf({var->isConst, var->isPublic});
+            break;
+        }
+        case NodeKind::AssignStmt: {
+            auto* assign = static_cast<AssignStmtAST*>(n);
+            r.a = node(assign->target);
+            r.b = string(assign->op);
+            r.c = node(assign->value);
+            break;
+        }
+        case NodeKind::ExprStmt:
+            r.a = node(static_cast<ExprStmtAST*>(n)->expression);
+            break;
+        case NodeKind::ReturnStmt:
+            r.a = node(static_cast<ReturnStmtAST*>(n)->value);
+            break;
+        case NodeKind::ThrowStmt:
+            r.a = node(static_cast<ThrowStmtAST*>(n)->exception);
+            break;
+        case NodeKind::BlockStmt:
+            r.a = nodeList(static_cast<BlockStmtAST*>(n)->statements);
+            break;
+        case NodeKind::IfStmt: {
+            auto* ifStmt = static_cast<IfStmtAST*>(n);
+            r.a = node(ifStmt->condition);
+            r.b = node(ifStmt->thenStmt);
+            r.c = node(ifStmt->elseStmt);
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            auto* whileStmt = static_cast<WhileStmtAST*>(n);
+            r.a = node(whileStmt->condition);
+            r.b = node(whileStmt->body);
+            break;
+        }
+        case NodeKind::ForStmt: {
+            auto* forStmt = static_cast<ForStmtAST*>(n);
+            r.a = node(forStmt->init);
+            r.b = node(forStmt->condition);
+            r.c = node(forStmt->update);
+            r.d = node(forStmt->body);
+            break;
+        }
+        case NodeKind::ForInStmt: {
+            auto* forIn = static_cast<ForInStmtAST*>(n);
+            r.a = string(forIn->variable);
+            r.b = node(forIn->iterable);
+            r.c = node(forIn->body);
+            break;
+        }
+        case NodeKind::MatchStmt: {
+            auto* match = static_cast<MatchStmtAST*>(n);
+            r.a = node(match->value);
+            llvm::SmallVector<uint32_t, 8> words;
+            for (auto& arm : match->arms) {
+                uint32_t pattern = node(arm.first);
+                words.push_back(pattern);
+                words.push_back(node(arm.second));
+            }
+            r.b = list(words, 2);
+            break;
+        }
+        case NodeKind::TryCatchStmt: {
+            auto* tryCatch = static_cast<TryCatchStmtAST*>(n);
+            r.a = node(tryCatch->tryBody);
+            r.b = string(tryCatch->exceptionVar);
+            r.c = type(tryCatch->exceptionType);
+            r.d = node(tryCatch->catchBody);
+            r.e = node(tryCatch->finallyBody);
+            break;
+        }
+        case NodeKind::StructDecl: {
+            auto* structDecl = static_cast<StructDeclAST*>(n);
+            r.a = string(structDecl->name);
+            llvm::SmallVector<uint32_t, 8> words;
+            for (auto& field : structDecl->fields) {
+                words.push_back(string(field.first));
+                words.push_back(type(field.second));
+            }
+            r.b = list(words, 2);
+            r.c = typeList(structDecl->generics);
+            r.flags = flagsOf({structDecl->isPublic});
+            break;
+        }
+        case NodeKind::EnumDecl: {
+            auto* enumDecl = static_cast<EnumDeclAST*>(n);
+            r.a = string(enumDecl->name);
+            llvm::SmallVector<uint32_t, 8> words;
+            for (auto& variant : enumDecl->variants) {
+                uint32_t name = string(variant.first);
+                words.push_back(name);
+                words.push_back(typeList(variant.second));
+            }
+            r.b = list(words, 2);
+            r.c = typeList(enumDecl->generics);
+            r.flags = flagsOf({enumDecl->isPublic});
+            break;
+        }
+        case NodeKind::TraitDecl: {
+            auto* trait = static_cast<TraitDeclAST*>(n);
+            r.a = string(trait->name);
+            r.b = nodeList(trait->methods);
+            r.c = typeList(trait->generics);
+            r.flags = flagsOf({trait->isPublic});
+            break;
+        }
+        case NodeKind::ImplDecl: {
+            auto* impl = static_cast<ImplDeclAST*>(n);
+            r.a = type(impl->targetType);
+            r.b = type(impl->traitType);
+            r.c = nodeList(impl->methods);
+            r.d = typeList(impl->generics);
+            break;
+        }
+        case NodeKind::FunctionDecl: {
+            auto* func = static_cast<FunctionDeclAST*>(n);
+            llvm::SmallVector<uint32_t, 16> words;
+            for (auto& param : func->parameters) {
+                uint32_t name = string(param.name);
+                uint32_t paramType = type(param.type);
+                words.push_back(name);
+                words.push_back(paramType);
+                words.push_back(node(param.defaultValue));
+                words.push_back(param.isOptional ? 1 : 0);
+            }
+            r.a = string(func->name);
+            r.b = list(words, 4);
+            r.c = type(func->returnType);
+            // Written last, so the body is one contiguous range right before this record
+            r.d = node(func->ensureBody());
+            r.e = string(func->externLang);
+            r.flags = flagsOf({func->isPublic, func->isStatic, func->isVirtual,
+                               func->isOverride, func->isAsync, func->isExtern});
+            break;
+        }
+        case NodeKind::ImportDecl: {
+            auto* import = static_cast<ImportDeclAST*>(n);
+            r.a = string(import->moduleName);
+            r.b = string(import->alias);
+            llvm::SmallVector<uint32_t, 8> words;
+            for (std::string_view name : import->specificImports) words.push_back(string(name));
+            r.c = list(words);
+            r.flags = flagsOf({import->isWildcard});
+            break;
+        }
+        case NodeKind::ModuleDecl: {
+            auto* moduleDecl = static_cast<ModuleDeclAST*>(n);
+            r.a = string(moduleDecl->name);
+            r.b = nodeList(moduleDecl->declarations);
+            break;
+        }
+        case NodeKind::Program:
+            r.a = nodeList(static_cast<ProgramAST*>(n)->declarations);
+            break;
+    }
+
+    nodes.push_back(r);
+    return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+template<typename T>
+void appendSection(std::string& out, const std::vector<T>& items, uint32_t& offset) {
+    // Every section starts 8-byte aligned so records can be read in place
+    out.resize((out.size() + 7) & ~size_t(7));
+    offset = static_cast<uint32_t>(out.size());
+    out.append(reinterpret_cast<const char*>(items.data()), items.size() * sizeof(T));
+}
+
+void Writer::save(const std::string& path, uint32_t root) {
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.root = root;
+    header.nodeCount = static_cast<uint32_t>(nodes.size());
+    header.typeCount = static_cast<uint32_t>(types.size());
+    header.listWords = static_cast<uint32_t>(lists.size());
+    header.stringCount = static_cast<uint32_t>(strings.size());
+    header.textBytes = static_cast<uint32_t>(text.size());
+
+    std::string out(sizeof(Header), '\0');
+    appendSection(out, nodes, header.nodesOffset);
+    appendSection(out, types, header.typesOffset);
+    appendSection(out, lists, header.listsOffset);
+    appendSection(out, strings, header.stringsOffset);
+    header.textOffset = static_cast<uint32_t>(out.size());
+    out.append(text);
+    std::memcpy(&out[0], &header, sizeof(header));
+
+    // A concurrent build must never map a half-written file, and a killed
+    // one must not leave one under the final name
+    int fd;
+    llvm::SmallString<128> temporary;
+    if (std::error_code ec = llvm::sys::fs::createUniqueFile(path + "-%%%%%%.tmp", fd, temporary)) {
+        throw std::runtime_error("Could not write module cache " + path + ": " + ec.message());
+    }
+    llvm::FileRemover remover(temporary);  // unless renamed into place below
+    {
+        llvm::raw_fd_ostream file(fd, true);
+        file.write(out.data(), out.size());
+        file.close();
+        if (file.has_error()) {
+            std::string message = file.error().message();
+            file.clear_error();
+            throw std::runtime_error("Could not write module cache " + path + ": " + message);
+        }
+    }
+    if (std::error_code ec = llvm::sys::fs::rename(temporary, path)) {
+        throw std::runtime_error("Could not write module cache " + path + ": " + ec.message());
+    }
+    remover.releaseFile();
+}
+
+} // namespace
+
+void ModuleCache::write(ProgramAST* program, const std::string& path) {
+    Writer writer;
+    uint32_t root = writer.node(program);
+    writer.save(path, root);
+}
+
+ProgramAST* ModuleCache::buildInterface(ProgramAST* module, ASTContext& context) {
+    llvm::SmallVector<DeclAST*, 32> declarations;
+    for (auto* decl : module->declarations) {
+        switch (decl->kind) {
+            case NodeKind::ImportDecl:
+                declarations.push_back(decl);
+                break;
+            case NodeKind::StructDecl:
+                if (static_cast<StructDeclAST*>(decl)->isPublic) declarations.push_back(decl);
+                break;
+            case NodeKind::EnumDecl:
+                if (static_cast<EnumDeclAST*>(decl)->isPublic) declarations.push_back(decl);
+                break;
+            case NodeKind::FunctionDecl: {
+                auto* func = static_cast<FunctionDeclAST*>(decl);
+                if (!func->isPublic) break;
+                
+                // Any other body change must not reach importers
+                BlockStmtAST* body = func->ensureBody();
+                bool inlineable = body && body->statements.size() == 1 &&
+                                  llvm::isa<ReturnStmtAST>(body->statements[0]);
+                declarations.push_back(context.create<FunctionDeclAST>(
+                    func->name, func->parameters, func->returnType, inlineable ? body : nullptr,
+                    func->isPublic, func->isStatic, func->isVirtual, func->isOverride,
+                    func->isAsync, func->isExtern, func->externLang));
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return context.create<ProgramAST>(context.list(declarations));
+}
+
+// ==================== READER ====================
+
+ModuleCacheReader::ModuleCacheReader(std::unique_ptr<SourceBuffer> file) : file(std::move(file)) {}
+
+std::unique_ptr<ModuleCacheReader> ModuleCacheReader::open(const std::string& path) {
+    std::unique_ptr<SourceBuffer> buffer;
+    try {
+        buffer = SourceBuffer::fromFile(path);
+    } catch (const std::runtime_error&) {
+        return nullptr;
+    }
+
+    std::unique_ptr<ModuleCacheReader> reader(new ModuleCacheReader(std::move(buffer)));
+    if (!reader->validate()) return nullptr;
+    return reader;
+}
+
+bool ModuleCacheReader::validate() {
+    std::string_view bytes = file->text();
+    if (bytes.size() < sizeof(Header) || reinterpret_cast<uintptr_t>(bytes.data()) % 8 != 0) return false;
+
+    header = reinterpret_cast<const Header*>(bytes.data());
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion) return false;
+
+    auto fits = [&](uint32_t offset, uint64_t count, size_t size) {
+        return offset % 8 == 0 && offset + count * size <= bytes.size();
+    };
+    if (!fits(header->nodesOffset, header->nodeCount, sizeof(NodeRecord)) ||
+        !fits(header->typesOffset, header->typeCount, sizeof(TypeRecord)) ||
+        !fits(header->listsOffset, header->listWords, sizeof(uint32_t)) ||
+        !fits(header->stringsOffset, header->stringCount, sizeof(StringRecord)) ||
+        uint64_t(header->textOffset) + header->textBytes != bytes.size() ||  // text ends the file
+        header->nodeCount == 0 || header->root != header->nodeCount - 1) {
+        return false;
+    }
+
+    nodes = reinterpret_cast<const NodeRecord*>(bytes.data() + header->nodesOffset);
+    types = reinterpret_cast<const TypeRecord*>(bytes.data() + header->typesOffset);
+    lists = reinterpret_cast<const uint32_t*>(bytes.data() + header->listsOffset);
+    strings = reinterpret_cast<const StringRecord*>(bytes.data() + header->stringsOffset);
+    text = bytes.data() + header->textOffset;
+    return true;
+}
+
+void ModuleCacheReader::corrupt(const char* what) const {
+    throw std::runtime_error("Corrupt module cache " + file->getName() + ": " + what);
+}
+
+std::string_view ModuleCacheReader::string(uint32_t id) const {
+    if (id == kNone) return std::string_view();
+    if (id >= header->stringCount) corrupt("string index out of range");
+    const StringRecord& record = strings[id];
+    if (uint64_t(record.offset) + record.length > header->textBytes) corrupt("string out of range");
+    return std::string_view(text + record.offset, record.length);
+}
+
+Identifier ModuleCacheReader::identifier(uint32_t id) const {
+    return id == kNone ? Identifier() : Identifier(string(id));
+}
+
+const uint32_t* ModuleCacheReader::list(uint32_t id, uint32_t stride, uint32_t& count) const {
+    count = 0;
+    if (id == kNone) return nullptr;
+    if (id >= header->listWords) corrupt("list index out of range");
+    count = lists[id];
+    if (id + 1 + uint64_t(count) * stride > header->listWords) corrupt("list out of range");
+    return lists + id + 1;
+}
+
+const TypeInfo* ModuleCacheReader::type(uint32_t id) {
+    if (id == kNone) return nullptr;
+    if (id >= header->typeCount) corrupt("type index out of range");
+    if (typeCache.empty()) typeCache.resize(header->typeCount, nullptr);
+    if (typeCache[id]) return typeCache[id];
+
+    const TypeRecord& record = types[id];
+    if (record.type > static_cast<uint8_t>(FlastType::UNKNOWN)) corrupt("unknown type kind");
+    uint32_t count;
+    const uint32_t* items = list(record.parameters, 1, count);
+    llvm::SmallVector<const TypeInfo*, 4> parameters;
+    for (uint32_t i = 0; i < count; i++) {
+        if (items[i] >= id) corrupt("type parameter out of order");
+        parameters.push_back(type(items[i]));
+    }
+
+    TypeInfo shape(static_cast<FlastType>(record.type), identifier(record.className));
+    shape.isPointer = record.modifiers & kTypePointer;
+    shape.isReference = record.modifiers & kTypeReference;
+    shape.isConst = record.modifiers & kTypeConst;
+    shape.isOptional = record.modifiers & kTypeOptional;
+    shape.parameters = ASTList<const TypeInfo*>(parameters.data(), parameters.size());
+    return typeCache[id] = g_typeContext.get(shape);
+}
+
+ASTList<const TypeInfo*> ModuleCacheReader::typeList(uint32_t id) {
+    uint32_t count;
+    const uint32_t* items = list(id, 1, count);
+    llvm::SmallVector<const TypeInfo*, 8> result;
+    for (uint32_t i = 0; i < count; i++) result.push_back(type(items[i]));
+    return context->list(result);
+}
+
+template<typename T>
+T* ModuleCacheReader::child(uint32_t id, uint32_t parent) const {
+    if (id == kNone) return nullptr;
+    // Post-order: children always precede their parent
+    if (id >= parent || !decoded[id]) corrupt("child link out of order");
+    T* node = llvm::dyn_cast<T>(decoded[id]);
+    if (!node) corrupt("child of the wrong kind");
+    return node;
+}
+
+template<typename T>
+ASTList<T*> ModuleCacheReader::childList(uint32_t id, uint32_t parent) {
+    uint32_t count;
+    const uint32_t* items = list(id, 1, count);
+    llvm::SmallVector<T*, 8> result;
+    for (uint32_t i = 0; i < count; i++) {
+        T* item = child<T>(items[i], parent);
+        if (!item) corrupt("missing list element");
+        result.push_back(item);
+    }
+    return context->list(result);
+}
+
+ASTNode* ModuleCacheReader::build(uint32_t index, bool deferBody) {
+    const NodeRecord& r = nodes[index];
+    ASTContext& ast = *context;
+
+    switch (static_cast<NodeKind>(r.kind)) {
+        case NodeKind::NumberExpr:
+            return ast.create<NumberExprAST>(joinDouble(r.a, r.b), r.flags & 1, string(r.c));
+        case NodeKind::ScientificExpr:
+            return ast.create<ScientificExprAST>(joinDouble(r.a, r.b), string(r.c));
+        case NodeKind::StringExpr:
+            return ast.create<StringExprAST>(string(r.a));
+        case NodeKind::BoolExpr:
+            return ast.create<BoolExprAST>(r.flags & 1);
+        case NodeKind::NullExpr:
+            return ast.create<NullExprAST>();
+        case NodeKind::VariableExpr:
+            return ast.create<VariableExprAST>(identifier(r.a));
+        case NodeKind::BinaryExpr:
+            if (r.op >= static_cast<uint16_t>(BinaryOp::Count)) corrupt("unknown binary operator");
+            return ast.create<BinaryExprAST>(static_cast<BinaryOp>(r.op), child<ExprAST>(r.a, index),
+                                             child<ExprAST>(r.b, index));
+        case NodeKind::UnaryExpr:
+            if (r.op >= static_cast<uint16_t>(UnaryOp::Count)) corrupt("unknown unary operator");
+            return ast.create<UnaryExprAST>(static_cast<UnaryOp>(r.op), child<ExprAST>(r.a, index), r.flags & 1);
+        case NodeKind::CallExpr:
+            return ast.create<CallExprAST>(identifier(r.a), childList<ExprAST>(r.b, index));
+        case NodeKind::MemberAccessExpr:
+            return ast.create<MemberAccessExprAST>(child<ExprAST>(r.a, index), identifier(r.b), r.flags & 1);
+        case NodeKind::IndexExpr:
+            return ast.create<IndexExprAST>(child<ExprAST>(r.a, index), child<ExprAST>(r.b, index));
+        case NodeKind::NewExpr:
+            return ast.create<NewExprAST>(identifier(r.a), childList<ExprAST>(r.b, index));
+        case NodeKind::ListExpr:
+            return ast.create<ListExprAST>(childList<ExprAST>(r.b, index));
+        case NodeKind::TupleExpr:
+            return ast.create<TupleExprAST>(childList<ExprAST>(r.b, index));
+        case NodeKind::ArrayExpr:
+            return ast.create<ArrayExprAST>(childList<ExprAST>(r.b, index));
+        case NodeKind::MapExpr: {
+            uint32_t count;
+            const uint32_t* words = list(r.b, 2, count);
+            llvm::SmallVector<std::pair<ExprAST*, ExprAST*>, 8> pairs;
+            for (uint32_t i = 0; i < count; i++) {
+                pairs.emplace_back(child<ExprAST>(words[2 * i], index), child<ExprAST>(words[2 * i + 1], index));
+            }
+            return ast.create<MapExprAST>(ast.list(pairs));
+        }
+        case NodeKind::LambdaExpr: {
+            uint32_t count;
+            const uint32_t* words = list(r.a, 2, count);
+            llvm::SmallVector<std::pair<std::string_view, const TypeInfo*>, 8> params;
+            for (uint32_t i = 0; i < count; i++) {
+                params.emplace_back(string(words[2 * i]), type(words[2 * i + 1]));
+            }
+            return ast.create<LambdaExprAST>(ast.list(params), type(r.b), childList<StmtAST>(r.c, index));
+        }
+        case NodeKind::BuiltinMethodExpr:
+            return ast.create<BuiltinMethodExprAST>(child<ExprAST>(r.a, index), string(r.b),
+                                                    childList<ExprAST>(r.c, index));
+        case NodeKind::MethodCallExpr:
+            return ast.create<MethodCallExprAST>(child<ExprAST>(r.a, index), identifier(r.b),
+                                                 childList<ExprAST>(r.c, index));
+        case NodeKind::TypeCast:
+            return ast.create<TypeCastAST>(child<ExprAST>(r.a, index), type(r.b));
+        case NodeKind::VarDeclStmt:
+            return ast.create<VarDeclStmtAST>(identifier(r.a), type(r.b), child<ExprAST>(r.c, index),
+                                              r.flags & 1, (r.flags & 2) != 0);
+        case NodeKind::AssignStmt:
+            return ast.create<AssignStmtAST>(child<ExprAST>(r.a, index), string(r.b), child<ExprAST>(r.c, index));
+        case NodeKind::ExprStmt:
+            return ast.create<ExprStmtAST>(child<ExprAST>(r.a, index));
+        case NodeKind::ReturnStmt:
+            return ast.create<ReturnStmtAST>(child<ExprAST>(r.a, index));
+        case NodeKind::ThrowStmt:
+            return ast.create<ThrowStmtAST>(child<ExprAST>(r.a, index));
+        case NodeKind::BlockStmt:
+            return ast.create<BlockStmtAST>(childList<StmtAST>(r.a, index));
+        case NodeKind::IfStmt:
+            return ast.create<IfStmtAST>(child<ExprAST>(r.a, index), child<StmtAST>(r.b, index),
+                                         child<StmtAST>(r.c, index));
+        case NodeKind::WhileStmt:
+            return ast.create<WhileStmtAST>(child<ExprAST>(r.a, index), child<StmtAST>(r.b, index));
+        case NodeKind::ForStmt:
+            return ast.create<ForStmtAST>(child<StmtAST>(r.a, index), child<ExprAST>(r.b, index),
+                                          child<StmtAST>(r.c, index), child<StmtAST>(r.d, index));
+        case NodeKind::ForInStmt:
+            return ast.create<ForInStmtAST>(identifier(r.a), child<ExprAST>(r.b, index), child<StmtAST>(r.c, index));
+        case NodeKind::BreakStmt:
+            return ast.create<BreakStmtAST>();
+        case NodeKind::ContinueStmt:
+            return ast.create<ContinueStmtAST>();
+        case NodeKind::MatchStmt: {
+            uint32_t count;
+            const uint32_t* words = list(r.b, 2, count);
+            llvm::SmallVector<std::pair<ExprAST*, StmtAST*>, 8> arms;
+            for (uint32_t i = 0; i < count; i++) {
+                arms.emplace_back(child<ExprAST>(words[2 * i], index), child<StmtAST>(words[2 * i + 1], index));
+            }
+            return ast.create<MatchStmtAST>(child<ExprAST>(r.a, index), ast.list(arms));
+        }
+        case NodeKind::TryCatchStmt:
+            return ast.create<TryCatchStmtAST>(child<StmtAST>(r.a, index), string(r.b), type(r.c),
+                                               child<StmtAST>(r.d, index), child<StmtAST>(r.e, index));
+        case NodeKind::StructDecl: {
+            uint32_t count;
+            const uint32_t* words = list(r.b, 2, count);
+            llvm::SmallVector<std::pair<Identifier, const TypeInfo*>, 8> fields;
+            for (uint32_t i = 0; i < count; i++) {
+                fields.emplace_back(identifier(words[2 * i]), type(words[2 * i + 1]));
+            }
+            return ast.create<StructDeclAST>(identifier(r.a), ast.list(fields), typeList(r.c), r.flags & 1);
+        }
+        case NodeKind::EnumDecl: {
+            uint32_t count;
+            const uint32_t* words = list(r.b, 2, count);
+            llvm::SmallVector<std::pair<std::string_view, ASTList<const TypeInfo*>>, 8> variants;
+            for (uint32_t i = 0; i < count; i++) {
+                variants.emplace_back(string(words[2 * i]), typeList(words[2 * i + 1]));
+            }
+            return ast.create<EnumDeclAST>(string(r.a), ast.list(variants), typeList(r.c), r.flags & 1);
+        }
+        case NodeKind::TraitDecl:
+            return ast.create<TraitDeclAST>(string(r.a), childList<DeclAST>(r.b, index), typeList(r.c), r.flags & 1);
+        case NodeKind::ImplDecl:
+            return ast.create<ImplDeclAST>(type(r.a), childList<DeclAST>(r.c, index), type(r.b), typeList(r.d));
+        case NodeKind::FunctionDecl: {
+            uint32_t count;
+            const uint32_t* words = list(r.b, 4, count);
+            llvm::SmallVector<ParameterAST, 8> params;
+            for (uint32_t i = 0; i < count; i++) {
+                params.emplace_back(identifier(words[4 * i]), type(words[4 * i + 1]),
+                                    child<ExprAST>(words[4 * i + 2], index), words[4 * i + 3] != 0);
+            }
+
+            BlockStmtAST* body = nullptr;
+            DeferredBody deferred;
+            if (deferBody && r.d != kNone) {
+                if (r.d >= index || nodes[r.d].first > r.d) corrupt("function body out of range");
+                deferred.source = this;
+                deferred.begin = nodes[r.d].first;
+                deferred.end = r.d + 1;
+            } else {
+                body = child<BlockStmtAST>(r.d, index);
+            }
+
+            uint8_t f = r.flags;
+            auto* func = ast.create<FunctionDeclAST>(identifier(r.a), ast.list(params), type(r.c), body,
+                                                     f & 1, (f & 2) != 0, (f & 4) != 0, (f & 8) != 0,
+                                                     (f & 16) != 0, (f & 32) != 0, string(r.e));
+            func->deferred = deferred;
+            return func;
+        }
+        case NodeKind::ImportDecl: {
+            uint32_t count;
+            const uint32_t* words = list(r.c, 1, count);
+            llvm::SmallVector<std::string_view, 8> names;
+            for (uint32_t i = 0; i < count; i++) names.push_back(string(words[i]));
+            return ast.create<ImportDeclAST>(string(r.a), string(r.b), ast.list(names), r.flags & 1);
+        }
+        case NodeKind::ModuleDecl:
+            return ast.create<ModuleDeclAST>(string(r.a), childList<DeclAST>(r.b, index));
+        case NodeKind::Program:
+            return ast.create<ProgramAST>(childList<DeclAST>(r.a, index));
+    }
+    corrupt("unknown node kind");
+}
+
+void ModuleCacheReader::decodeRange(uint32_t first, uint32_t last, uint32_t skipFirst, uint32_t skipLast) {
+    if (first > last || last >= header->nodeCount) corrupt("node range out of bounds");
+    for (uint32_t i = first; i <= last; i++) {
+        if (i == skipFirst) {
+            i = skipLast;
+            continue;
+        }
+        decoded[i] = build(i, i == last && skipFirst != kNone);
+    }
+}
+
+ProgramAST* ModuleCacheReader::load(ASTContext& target) {
+    context = &target;
+    decoded.assign(header->nodeCount, nullptr);
+
+    const NodeRecord& root = nodes[header->root];
+    if (root.kind != static_cast<uint8_t>(NodeKind::Program)) corrupt("root is not a program");
+
+    // Top-level declarations are decoded whole, except function bodies
+    uint32_t count;
+    const uint32_t* items = list(root.a, 1, count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t index = items[i];
+        if (index >= header->root) corrupt("declaration out of range");
+        const NodeRecord& decl = nodes[index];
+        if (decl.kind == static_cast<uint8_t>(NodeKind::FunctionDecl) && decl.d != kNone) {
+            if (decl.d >= index || nodes[decl.d].first < decl.first) corrupt("function body out of range");
+            decodeRange(decl.first, index, nodes[decl.d].first, decl.d);
+        } else {
+            decodeRange(decl.first, index);
+        }
+    }
+    return static_cast<ProgramAST*>(decoded[header->root] = build(header->root, false));
+}
+
+BlockStmtAST* ModuleCacheReader::loadBody(FunctionDeclAST& func, const DeferredBody& range) {
+    decodeRange(range.begin, range.end - 1);
+    auto* body = llvm::dyn_cast<BlockStmtAST>(decoded[range.end - 1]);
+    if (!body) corrupt("function body is not a block");
+    return body;
+}
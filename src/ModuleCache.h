@@ -0,0 +1,116 @@
+#pragma once
+#include "AST.h"
+#include "ASTContext.h"
+#include "SourceBuffer.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Binary AST of one imported module, kept in .build/cache/modules so warm
+// builds never lex or parse the module again. The format is relocatable and
+// can be read straight out of a memory mapping: a flat array of fixed-size
+// node records in post-order (children before parents, every subtree
+// contiguous) linked by index, a table of types, length-prefixed index
+// lists and a string table. Nothing in the file is a pointer.
+namespace ModuleCache {
+
+constexpr char kMagic[4] = {'F', 'L', 'A', 'C'};
+constexpr uint32_t kVersion = 1;  // bump on any layout or encoding change
+constexpr uint32_t kNone = 0xFFFFFFFF;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t root;  // the Program node, always the last record
+    uint32_t nodeCount, nodesOffset;
+    uint32_t typeCount, typesOffset;
+    uint32_t listWords, listsOffset;
+    uint32_t stringCount, stringsOffset;
+    uint32_t textBytes, textOffset;
+};
+
+// Operands a..e are node, type, string or list indices (or raw bits for
+// numbers) depending on `kind`; see ModuleCache.cpp for the encoding.
+struct NodeRecord {
+    uint8_t kind;
+    uint8_t flags;   // node-specific booleans
+    uint16_t op;     // BinaryOp / UnaryOp
+    uint32_t first;  // first record of this node's subtree
+    uint32_t a, b, c, d, e;
+};
+
+struct TypeRecord {
+    uint8_t type;       // FlastType
+    uint8_t modifiers;  // pointer, reference, const, optional
+    uint16_t reserved;
+    uint32_t className;   // string
+    uint32_t parameters;  // list of earlier types
+};
+
+struct StringRecord {
+    uint32_t offset;  // into the text section
+    uint32_t length;
+};
+
+// Serialise `program` to `path` (written to a unique temporary, then renamed).
+// Deferred top-level function bodies are built first. Throws on I/O errors.
+void write(ProgramAST* program, const std::string& path);
+
+// The part of a module its importers depend on, allocated in `context`:
+// imports, public structs and enums, and public function signatures. A
+// public function whose body is a single return keeps that body so
+// importers can inline it. Written with write() as the module's .flsi.
+ProgramAST* buildInterface(ProgramAST* module, ASTContext& context);
+
+} // namespace ModuleCache
+
+// Maps a module cache file and rebuilds the AST from it. Top-level function
+// bodies stay deferred and are decoded from their node range on first use,
+// so the reader must outlive the AST it produces; string views in that AST
+// point into the mapping.
+class ModuleCacheReader : public BodySource {
+private:
+    std::unique_ptr<SourceBuffer> file;
+    const ModuleCache::Header* header = nullptr;
+    const ModuleCache::NodeRecord* nodes = nullptr;
+    const ModuleCache::TypeRecord* types = nullptr;
+    const uint32_t* lists = nullptr;
+    const ModuleCache::StringRecord* strings = nullptr;
+    const char* text = nullptr;
+
+    ASTContext* context = nullptr;
+    std::vector<ASTNode*> decoded;        // by node index
+    std::vector<const TypeInfo*> typeCache;  // by type index, filled on demand
+
+    explicit ModuleCacheReader(std::unique_ptr<SourceBuffer> file);
+    bool validate();
+
+    [[noreturn]] void corrupt(const char* what) const;
+    std::string_view string(uint32_t id) const;
+    Identifier identifier(uint32_t id) const;
+    const TypeInfo* type(uint32_t id);
+    const uint32_t* list(uint32_t id, uint32_t stride, uint32_t& count) const;
+    ASTList<const TypeInfo*> typeList(uint32_t id);
+    template<typename T> T* child(uint32_t id, uint32_t parent) const;
+    template<typename T> ASTList<T*> childList(uint32_t id, uint32_t parent);
+
+    ASTNode* build(uint32_t index, bool deferBody);
+    // Decodes records [first, last], skipping [skipFirst, skipLast]
+    void decodeRange(uint32_t first, uint32_t last, uint32_t skipFirst = ModuleCache::kNone,
+                     uint32_t skipLast = ModuleCache::kNone);
+
+public:
+    // nullptr when the file is missing, has another magic or version, or
+    // its sections do not end exactly where the file does (cut short)
+    static std::unique_ptr<ModuleCacheReader> open(const std::string& path);
+
+    // Top-level declarations of the module, allocated in `context`.
+    // Throws std::runtime_error on malformed records.
+    ProgramAST* load(ASTContext& context);
+    BlockStmtAST* loadBody(FunctionDeclAST& func, const DeferredBody& range) override;
+
+    size_t getNodeCount() const { return header->nodeCount; }
+    std::string_view getBytes() const { return file->text(); }
+};
@@ -1,28 +1,39 @@
 #include "Parser.h"
+#include "TypeContext.h"
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/SmallVector.h>
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 
-Parser::Parser(const std::vector<Token>& tokens, const std::string& fileName) 
-    : tokens(tokens), current(0), fileName(fileName) {}
+Parser::Parser(std::vector<Token>&& tokens, ASTContext& ast, const std::string& fileName) 
+    : tokens(std::move(tokens)), current(0), fileName(fileName), ast(ast) {}
+
+Parser::Parser(TokenStream& stream, ASTContext& ast, const std::string& fileName)
+    : stream(&stream), current(0), fileName(fileName), ast(ast) {}
 
 // ==================== UTILITY METHODS ====================
 
+Token& Parser::tokenAt(size_t index) {
+    if (stream) return stream->at(index);
+    if (index >= tokens.size()) {
+        static Token eof(TokenType::TOK_EOF, "", 0, 0);
+        return eof;
+    }
+    return tokens[index];
+}
+
 Token& Parser::peek() {
     if (isAtEnd()) {
         static Token eof(TokenType::TOK_EOF, "", 0, 0);
         return eof;
     }
-    return tokens[current];
+    return tokenAt(current);
 }
 
 
 Token& Parser::peekNext() {
-    if (current + 1 >= tokens.size()) {
-        static Token eof(TokenType::TOK_EOF, "", 0, 0);
-        return eof;
-    }
-    return tokens[current + 1];
+    return tokenAt(current + 1);
 }
 
 Token& Parser::previous() {
@@ -30,11 +41,11 @@ Token& Parser::previous() {
         static Token eof(TokenType::TOK_EOF, "", 0, 0);
         return eof;
     }
-    return tokens[current - 1];
+    return tokenAt(current - 1);
 }
 
 bool Parser::isAtEnd() {
-    return current >= tokens.size() || (current < tokens.size() && tokens[current].type == TokenType::TOK_EOF);
+    return tokenAt(current).type == TokenType::TOK_EOF;
 }
 
 bool Parser::check(TokenType type) {
@@ -52,12 +63,23 @@ bool Parser::match(std::initializer_list<TokenType> types) {
     return false;
 }
 
-Token Parser::advance() {
+const Token& Parser::advance() {
     if (!isAtEnd()) current++;
     return previous();
 }
 
-void Parser::consume(TokenType type, const std::string& message) {
+Identifier Parser::advanceIdentifier() {
+    // Identifiers arrive interned from the lexer; keywords used as names
+    // (self, println, ...) are interned here
+    const Token& token = advance();
+    return token.symbol != 0 ? Identifier(token.symbol) : Identifier(token.value);
+}
+
+std::string_view Parser::advanceText() {
+    return ast.string(advance().value);
+}
+
+void Parser::consume(TokenType type, const char* message) {
     if (check(type)) {
         advance();
         return;
@@ -67,39 +89,17 @@ void Parser::consume(TokenType type, const std::string& message) {
 
 void Parser::error(const std::string& message) {
     Token& current_token = peek();
-    // Get line content from the original source
-    std::string lineContent = "";
-    if (!tokens.empty() && current < tokens.size()) {
-        // Try to find the line content from the token
-        for (const auto& token : tokens) {
-            if (token.line == current_token.line) {
-                // This is a simplified approach - in a real implementation,
-                // you'd want to store the original source lines
-                lineContent = "// Line " + std::to_string(token.line);
-                break;
-            }
-        }
-    }
-    ErrorContext context(fileName, current_token.line, current_token.column, lineContent, current_token.value);
+    // Line content comes from the source manager's line table
+    ErrorContext context = g_errorHandler.createContext(fileName, current_token.line, current_token.column,
+                                                        "", std::string(current_token.value));
     REPORT_ERROR(ErrorCode::INVALID_EXPRESSION, message, context);
 }
 
 ParseError Parser::parseError(const std::string& message) {
     Token& current_token = peek();
-    // Get line content from the original source
-    std::string lineContent = "";
-    if (!tokens.empty() && current < tokens.size()) {
-        // Try to find the line content from the token
-        for (const auto& token : tokens) {
-            if (token.line == current_token.line) {
-                // This is a simplified approach - in a real implementation,
-                // you'd want to store the original source lines
-                lineContent = "// Line " + std::to_string(token.line);
-                break;
-            }
-        }
-    }
-    ErrorContext context(fileName, current_token.line, current_token.column, lineContent, current_token.value);
+    // Line content comes from the source manager's line table
+    ErrorContext context = g_errorHandler.createContext(fileName, current_token.line, current_token.column,
+                                                        "", std::string(current_token.value));
     REPORT_ERROR(ErrorCode::INVALID_EXPRESSION, message, context);
     return ParseError(message, current_token.line, current_token.column);
 }
@@ -131,28 +131,50 @@ void Parser::synchronize() {
     }
 }
 
+void Parser::skipToMatchingBrace() {
+    consume(TokenType::TOK_LBRACE, "Expected '{'");
+    int depth = 1;
+    while (!isAtEnd()) {
+        TokenType type = advance().type;
+        if (type == TokenType::TOK_LBRACE) {
+            depth++;
+        } else if (type == TokenType::TOK_RBRACE && --depth == 0) {
+            return;
+        }
+    }
+    throw parseError("Expected '}' to close block");
+}
+
 // ==================== MAIN PARSING ====================
 
-std::shared_ptr<ProgramAST> Parser::parseProgram() {
-    std::vector<std::shared_ptr<DeclAST>> declarations;
+ProgramAST* Parser::parseProgram() {
+    llvm::SmallVector<DeclAST*, 8> declarations;
+    
+    while (auto decl = parseNextDeclaration()) {
+        declarations.push_back(decl);
+    }
     
+    return ast.create<ProgramAST>(ast.list(declarations));
+}
+
+DeclAST* Parser::parseNextDeclaration() {
     while (!isAtEnd()) {
         try {
             if (auto decl = parseDeclaration()) {
-                declarations.push_back(decl);
+                return decl;
             }
         } catch (const ParseError& e) {
+            errors.push_back(e);
             synchronize();
         }
     }
-    
-    return std::make_shared<ProgramAST>(declarations);
+    return nullptr;
 }
 
-std::shared_ptr<DeclAST> Parser::parseDeclaration() {
+DeclAST* Parser::parseDeclaration() {
     try {
         // Access modifiers
-        bool isPublic = match({TokenType::TOK_PUB});
+        bool isPublic = match({TokenType::TOK_PUBLIC, TokenType::TOK_PUB});
         bool isStatic = match({TokenType::TOK_STATIC});
         bool isConst = match({TokenType::TOK_CONST});
         bool isUnsafe = match({TokenType::TOK_UNSAFE});
@@ -160,9 +182,9 @@ std::shared_ptr<DeclAST> Parser::parseDeclaration() {
         
         // External declarations
         if (match({TokenType::TOK_EXTERN})) {
-            std::string linkage = "C";
+            std::string_view linkage = "C";
             if (check(TokenType::TOK_STRING)) {
-                linkage = advance().value;
+                linkage = advanceText();
             }
             
             if (check(TokenType::TOK_FUNC)) {
@@ -178,7 +200,7 @@ std::shared_ptr<DeclAST> Parser::parseDeclaration() {
         
         // Declaration types
         if (check(TokenType::TOK_FUNC)) {
-            auto func = parseFunctionDecl();
+            auto func = parseFunctionDecl(lazyFunctionBodies);
             func->isPublic = isPublic;
             func->isStatic = isStatic;
             func->isAsync = isAsync;
@@ -199,6 +221,7 @@ std::shared_ptr<DeclAST> Parser::parseDeclaration() {
         throw parseError("Expected declaration");
         
     } catch (const ParseError& e) {
+        errors.push_back(e);
         synchronize();
         return nullptr;
     }
@@ -206,17 +229,18 @@ std::shared_ptr<DeclAST> Parser::parseDeclaration() {
 
 // ==================== FUNCTION DECLARATION (Rust-like) ====================
 
-std::shared_ptr<FunctionDeclAST> Parser::parseFunctionDecl() {
+FunctionDeclAST* Parser::parseFunctionDecl(bool deferBody) {
+    const char* sourceBegin = peek().value.data();
     consume(TokenType::TOK_FUNC, "Expected 'fn'");
     
     if (!check(TokenType::TOK_IDENTIFIER)) {
         throw parseError("Expected function name");
     }
     
-    std::string name = advance().value;
+    Identifier name = advanceIdentifier();
     
     // Generic parameters
-    std::vector<std::shared_ptr<TypeInfo>> generics;
+    ASTList<const TypeInfo*> generics;
     if (match({TokenType::TOK_LESS})) {
         generics = parseGenericParameters();
         consume(TokenType::TOK_GREATER, "Expected '>' after generic parameters");
@@ -224,20 +248,28 @@ std::shared_ptr<FunctionDeclAST> Parser::parseFunctionDecl() {
     
     // Parameters
     consume(TokenType::TOK_LPAREN, "Expected '(' after function name");
-    std::vector<ParameterAST> parameters = parseParameterList();
+    ASTList<ParameterAST> parameters = parseParameterList();
     consume(TokenType::TOK_RPAREN, "Expected ')' after parameters");
     
     // Return type
-    std::shared_ptr<TypeInfo> returnType;
+    const TypeInfo* returnType;
     if (match({TokenType::TOK_ARROW})) {
         returnType = parseType();
     } else {
-        returnType = std::make_shared<TypeInfo>(FlastType::VOID);
+        returnType = g_typeContext.get(FlastType::VOID);
     }
     
     // Function body
-    std::shared_ptr<BlockStmtAST> body = nullptr;
-    if (check(TokenType::TOK_LBRACE)) {
+    const char* bodyBegin = peek().value.data();
+    BlockStmtAST* body = nullptr;
+    DeferredBody deferred;
+    if (check(TokenType::TOK_LBRACE) && deferBody) {
+        deferred.source = this;
+        deferred.begin = static_cast<uint32_t>(current);  // the opening '{'
+        skipToMatchingBrace();
+        deferred.end = static_cast<uint32_t>(current);
+        deferredBodies++;
+    } else if (check(TokenType::TOK_LBRACE)) {
         enterFunction(returnType);
         body = parseBlock();
         exitFunction();
@@ -245,22 +277,52 @@ std::shared_ptr<FunctionDeclAST> Parser::parseFunctionDecl() {
         consume(TokenType::TOK_SEMICOLON, "Expected ';' or function body");
     }
     
-    return std::make_shared<FunctionDeclAST>(name, parameters, returnType, body);
+    auto func = ast.create<FunctionDeclAST>(name, parameters, returnType, body);
+    func->deferred = deferred;
+    
+    // Token text points into the source buffer, so the declaration's text is
+    // the span between its first and last token
+    const Token& last = previous();
+    const char* sourceEnd = last.value.data() + last.value.size();
+    if (sourceBegin <= bodyBegin && bodyBegin <= sourceEnd) {
+        func->sourceText = std::string_view(sourceBegin, sourceEnd - sourceBegin);
+        func->signatureLength = static_cast<uint32_t>(bodyBegin - sourceBegin);
+    }
+    return func;
+}
+
+BlockStmtAST* Parser::loadBody(FunctionDeclAST& func, const DeferredBody& range) {
+    size_t resume = current;
+    current = range.begin;
+    
+    BlockStmtAST* body = nullptr;
+    try {
+        enterFunction(func.returnType);
+        body = parseBlock();
+        exitFunction();
+    } catch (const ParseError& e) {
+        errors.push_back(e);
+        exitFunction();
+        current = resume;
+        throw;
+    }
+    current = resume;
+    return body;
 }
 
 // ==================== STRUCT DECLARATION ====================
 
-std::shared_ptr<StructDeclAST> Parser::parseStructDecl() {
+StructDeclAST* Parser::parseStructDecl() {
     consume(TokenType::TOK_STRUCT, "Expected 'struct'");
     
     if (!check(TokenType::TOK_IDENTIFIER)) {
         throw parseError("Expected struct name");
     }
     
-    std::string name = advance().value;
+    Identifier name = advanceIdentifier();
     
     // Generic parameters
-    std::vector<std::shared_ptr<TypeInfo>> generics;
+    ASTList<const TypeInfo*> generics;
     if (match({TokenType::TOK_LESS})) {
         generics = parseGenericParameters();
         consume(TokenType::TOK_GREATER, "Expected '>' after generic parameters");
@@ -269,17 +331,17 @@ std::shared_ptr<StructDeclAST> Parser::parseStructDecl() {
     consume(TokenType::TOK_LBRACE, "Expected '{' after struct name");
     
     // Parse fields
-    std::vector<std::pair<std::string, std::shared_ptr<TypeInfo>>> fields;
+    llvm::SmallVector<std::pair<Identifier, const TypeInfo*>, 8> fields;
     
     while (!check(TokenType::TOK_RBRACE) && !isAtEnd()) {
         // Field visibility
-        bool isPublic = match({TokenType::TOK_PUB});
+        bool isPublic = match({TokenType::TOK_PUBLIC, TokenType::TOK_PUB});
         
         if (!check(TokenType::TOK_IDENTIFIER)) {
             throw parseError("Expected field name");
         }
         
-        std::string fieldName = advance().value;
+        Identifier fieldName = advanceIdentifier();
         consume(TokenType::TOK_COLON, "Expected ':' after field name");
         
         auto fieldType = parseType();
@@ -292,22 +354,22 @@ std::shared_ptr<StructDeclAST> Parser::parseStructDecl() {
     
     consume(TokenType::TOK_RBRACE, "Expected '}' after struct fields");
     
-    return std::make_shared<StructDeclAST>(name, fields, generics);
+    return ast.create<StructDeclAST>(name, ast.list(fields), generics);
 }
 
 // ==================== ENUM DECLARATION ====================
 
-std::shared_ptr<EnumDeclAST> Parser::parseEnumDecl() {
+EnumDeclAST* Parser::parseEnumDecl() {
     consume(TokenType::TOK_ENUM, "Expected 'enum'");
     
     if (!check(TokenType::TOK_IDENTIFIER)) {
         throw parseError("Expected enum name");
     }
     
-    std::string name = advance().value;
+    std::string_view name = advanceText();
     
     // Generic parameters
-    std::vector<std::shared_ptr<TypeInfo>> generics;
+    ASTList<const TypeInfo*> generics;
     if (match({TokenType::TOK_LESS})) {
         generics = parseGenericParameters();
         consume(TokenType::TOK_GREATER, "Expected '>' after generic parameters");
@@ -316,15 +378,15 @@ std::shared_ptr<EnumDeclAST> Parser::parseEnumDecl() {
     consume(TokenType::TOK_LBRACE, "Expected '{' after enum name");
     
     // Parse variants
-    std::vector<std::pair<std::string, std::vector<std::shared_ptr<TypeInfo>>>> variants;
+    llvm::SmallVector<std::pair<std::string_view, ASTList<const TypeInfo*>>, 8> variants;
     
     while (!check(TokenType::TOK_RBRACE) && !isAtEnd()) {
         if (!check(TokenType::TOK_IDENTIFIER)) {
             throw parseError("Expected variant name");
         }
         
-        std::string variantName = advance().value;
-        std::vector<std::shared_ptr<TypeInfo>> variantTypes;
+        std::string_view variantName = advanceText();
+        llvm::SmallVector<const TypeInfo*, 8> variantTypes;
         
         // Tuple-like variant
         if (match({TokenType::TOK_LPAREN})) {
@@ -337,7 +399,7 @@ std::shared_ptr<EnumDeclAST> Parser::parseEnumDecl() {
             consume(TokenType::TOK_RPAREN, "Expected ')' after variant types");
         }
         
-        variants.emplace_back(variantName, variantTypes);
+        variants.emplace_back(variantName, ast.list(variantTypes));
         
         if (!match({TokenType::TOK_COMMA})) {
             break;
@@ -346,203 +408,238 @@ std::shared_ptr<EnumDeclAST> Parser::parseEnumDecl() {
     
     consume(TokenType::TOK_RBRACE, "Expected '}' after enum variants");
     
-    return std::make_shared<EnumDeclAST>(name, variants, generics);
+    return ast.create<EnumDeclAST>(name, ast.list(variants), generics);
 }
 
 // ==================== EXPRESSION PARSING WITH PRECEDENCE ====================
 
-std::shared_ptr<ExprAST> Parser::parseExpression() {
-    return parseAssignmentExpression();
-}
-
-std::shared_ptr<ExprAST> Parser::parseAssignmentExpression() {
-    auto expr = parseTernaryExpression();
-    
-    if (isAssignmentOperator(peek().type)) {
-        std::string op = advance().value;
-        auto right = parseAssignmentExpression();
-        return std::make_shared<BinaryExprAST>(op, expr, right);
+static BinaryOp toBinaryOp(TokenType type) {
+    switch (type) {
+        case TokenType::TOK_PLUS: return BinaryOp::Add;
+        case TokenType::TOK_MINUS: return BinaryOp::Sub;
+        case TokenType::TOK_MULTIPLY: return BinaryOp::Mul;
+        case TokenType::TOK_DIVIDE: return BinaryOp::Div;
+        case TokenType::TOK_MODULO: return BinaryOp::Mod;
+        case TokenType::TOK_POWER: return BinaryOp::Pow;
+        case TokenType::TOK_LEFT_SHIFT: return BinaryOp::Shl;
+        case TokenType::TOK_RIGHT_SHIFT: return BinaryOp::Shr;
+        case TokenType::TOK_UNSIGNED_RIGHT_SHIFT: return BinaryOp::UShr;
+        case TokenType::TOK_BIT_AND: return BinaryOp::BitAnd;
+        case TokenType::TOK_BIT_OR:
+        case TokenType::TOK_PIPE: return BinaryOp::BitOr;  // the lexer emits `|` as PIPE
+        case TokenType::TOK_BIT_XOR:
+        case TokenType::TOK_XOR: return BinaryOp::BitXor;
+        case TokenType::TOK_LOGICAL_AND:
+        case TokenType::TOK_AND: return BinaryOp::LogicalAnd;
+        case TokenType::TOK_LOGICAL_OR:
+        case TokenType::TOK_OR: return BinaryOp::LogicalOr;
+        case TokenType::TOK_EQUAL: return BinaryOp::Eq;
+        case TokenType::TOK_NOT_EQUAL: return BinaryOp::Ne;
+        case TokenType::TOK_STRICT_EQUAL: return BinaryOp::StrictEq;
+        case TokenType::TOK_STRICT_NOT_EQUAL: return BinaryOp::StrictNe;
+        case TokenType::TOK_LESS: return BinaryOp::Lt;
+        case TokenType::TOK_GREATER: return BinaryOp::Gt;
+        case TokenType::TOK_LESS_EQUAL: return BinaryOp::Le;
+        case TokenType::TOK_GREATER_EQUAL: return BinaryOp::Ge;
+        case TokenType::TOK_SPACESHIP: return BinaryOp::Spaceship;
+        case TokenType::TOK_ASSIGN: return BinaryOp::Assign;
+        case TokenType::TOK_PLUS_ASSIGN: return BinaryOp::AddAssign;
+        case TokenType::TOK_MINUS_ASSIGN: return BinaryOp::SubAssign;
+        case TokenType::TOK_MULT_ASSIGN: return BinaryOp::MulAssign;
+        case TokenType::TOK_DIV_ASSIGN: return BinaryOp::DivAssign;
+        case TokenType::TOK_MOD_ASSIGN: return BinaryOp::ModAssign;
+        case TokenType::TOK_POWER_ASSIGN: return BinaryOp::PowAssign;
+        case TokenType::TOK_BIT_AND_ASSIGN: return BinaryOp::BitAndAssign;
+        case TokenType::TOK_BIT_OR_ASSIGN: return BinaryOp::BitOrAssign;
+        case TokenType::TOK_BIT_XOR_ASSIGN: return BinaryOp::BitXorAssign;
+        case TokenType::TOK_LEFT_SHIFT_ASSIGN: return BinaryOp::ShlAssign;
+        case TokenType::TOK_RIGHT_SHIFT_ASSIGN: return BinaryOp::ShrAssign;
+        default:
+            throw std::logic_error("Token " + tokenTypeToString(type) + " is not a binary operator");
     }
-    
-    return expr;
 }
 
-std::shared_ptr<ExprAST> Parser::parseTernaryExpression() {
-    auto expr = parseLogicalOrExpression();
-    
-    if (match({TokenType::TOK_QUESTION})) {
-        auto thenExpr = parseExpression();
-        consume(TokenType::TOK_COLON, "Expected ':' in ternary expression");
-        auto elseExpr = parseExpression();
-        
-        // Create a ternary expression (represented as special binary op)
-        auto condition = std::make_shared<BinaryExprAST>("?:", expr, thenExpr);
-        return std::make_shared<BinaryExprAST>("?:", condition, elseExpr);
+static UnaryOp toUnaryOp(TokenType type) {
+    switch (type) {
+        case TokenType::TOK_MINUS: return UnaryOp::Neg;
+        case TokenType::TOK_PLUS: return UnaryOp::Plus;
+        case TokenType::TOK_LOGICAL_NOT:
+        case TokenType::TOK_NOT: return UnaryOp::Not;
+        case TokenType::TOK_BIT_NOT: return UnaryOp::BitNot;
+        case TokenType::TOK_INCREMENT: return UnaryOp::PreIncrement;
+        case TokenType::TOK_DECREMENT: return UnaryOp::PreDecrement;
+        case TokenType::TOK_ADDRESS_OF: return UnaryOp::AddressOf;
+        case TokenType::TOK_DEREFERENCE: return UnaryOp::Dereference;
+        default:
+            throw std::logic_error("Token " + tokenTypeToString(type) + " is not a unary operator");
     }
-    
-    return expr;
 }
 
-std::shared_ptr<ExprAST> Parser::parseLogicalOrExpression() {
-    auto expr = parseLogicalAndExpression();
-    
-    while (match({TokenType::TOK_LOGICAL_OR, TokenType::TOK_OR})) {
-        std::string op = previous().value;
-        auto right = parseLogicalAndExpression();
-        expr = std::make_shared<BinaryExprAST>(op, expr, right);
-    }
-    
-    return expr;
-}
+namespace {
 
-std::shared_ptr<ExprAST> Parser::parseLogicalAndExpression() {
-    auto expr = parseBitwiseOrExpression();
-    
-    while (match({TokenType::TOK_LOGICAL_AND, TokenType::TOK_AND})) {
-        std::string op = previous().value;
-        auto right = parseBitwiseOrExpression();
-        expr = std::make_shared<BinaryExprAST>(op, expr, right);
-    }
-    
-    return expr;
-}
+// Tracks parseExpression nesting (parentheses, arguments, literals) so that
+// pathological input reports an error instead of exhausting the stack
+struct NestingGuard {
+    int& depth;
+    explicit NestingGuard(int& depth) : depth(depth) { ++depth; }
+    ~NestingGuard() { --depth; }
+};
 
-std::shared_ptr<ExprAST> Parser::parseBitwiseOrExpression() {
-    auto expr = parseBitwiseXorExpression();
-    
-    while (match({TokenType::TOK_BIT_OR})) {
-        std::string op = previous().value;
-        auto right = parseBitwiseXorExpression();
-        expr = std::make_shared<BinaryExprAST>(op, expr, right);
-    }
-    
-    return expr;
-}
+} // namespace
 
-std::shared_ptr<ExprAST> Parser::parseBitwiseXorExpression() {
-    auto expr = parseBitwiseAndExpression();
-    
-    while (match({TokenType::TOK_BIT_XOR, TokenType::TOK_XOR})) {
-        std::string op = previous().value;
-        auto right = parseBitwiseAndExpression();
-        expr = std::make_shared<BinaryExprAST>(op, expr, right);
+ExprAST* Parser::parseExpression() {
+    NestingGuard guard(expressionDepth);
+    if (expressionDepth > kMaxExpressionDepth) {
+        throw parseError("Expression nested too deeply");
     }
     
-    return expr;
-}
-
-std::shared_ptr<ExprAST> Parser::parseBitwiseAndExpression() {
-    auto expr = parseEqualityExpression();
-    
-    while (match({TokenType::TOK_BIT_AND})) {
-        std::string op = previous().value;
-        auto right = parseEqualityExpression();
-        expr = std::make_shared<BinaryExprAST>(op, expr, right);
+    // Assignment is right-associative: collect the targets, then fold from the right
+    llvm::SmallVector<std::pair<ExprAST*, BinaryOp>, 4> targets;
+    auto expr = parseTernaryExpression();
+    int depth = expressionTreeDepth;
+    while (isAssignmentOperator(peek().type)) {
+        BinaryOp op = toBinaryOp(advance().type);
+        targets.push_back({expr, op});
+        expr = parseTernaryExpression();
+        depth = std::max(depth, expressionTreeDepth);
     }
-    
-    return expr;
-}
-
-// EQUALITY has SUPER LOW precedence as requested
-std::shared_ptr<ExprAST> Parser::parseEqualityExpression() {
-    auto expr = parseComparisonExpression();
-    
-    while (match({TokenType::TOK_EQUAL, TokenType::TOK_NOT_EQUAL, 
-                  TokenType::TOK_STRICT_EQUAL, TokenType::TOK_STRICT_NOT_EQUAL})) {
-        std::string op = previous().value;
-        auto right = parseComparisonExpression();
-        expr = std::make_shared<BinaryExprAST>(op, expr, right);
+    for (auto it = targets.rbegin(); it != targets.rend(); ++it) {
+        expr = ast.create<BinaryExprAST>(it->second, it->first, expr);
     }
     
+    // Everything that walks the tree recurses once per level, so a chain
+    // too deep for it is rejected here rather than overflowing the stack
+    depth += static_cast<int>(targets.size());
+    if (depth > kMaxExpressionDepth) {
+        throw parseError("Expression nested too deeply");
+    }
+    expressionTreeDepth = depth;
+    nestedExpressionDepth = std::max(nestedExpressionDepth, depth);
     return expr;
 }
 
-// COMPARISON has precedence above equality
-std::shared_ptr<ExprAST> Parser::parseComparisonExpression() {
-    auto expr = parseShiftExpression();
+ExprAST* Parser::parseTernaryExpression() {
+    auto expr = parseBinaryExpression(parseUnaryExpression(), Precedence::LOGICAL_OR);
     
-    while (match({TokenType::TOK_LESS, TokenType::TOK_GREATER, 
-                  TokenType::TOK_LESS_EQUAL, TokenType::TOK_GREATER_EQUAL,
-                  TokenType::TOK_SPACESHIP})) {
-        std::string op = previous().value;
-        auto right = parseShiftExpression();
-        expr = std::make_shared<BinaryExprAST>(op, expr, right);
+    if (match({TokenType::TOK_QUESTION})) {
+        int depth = expressionTreeDepth;
+        auto thenExpr = parseExpression();
+        depth = std::max(depth, expressionTreeDepth);
+        consume(TokenType::TOK_COLON, "Expected ':' in ternary expression");
+        auto elseExpr = parseExpression();
+        expressionTreeDepth = std::max(depth, expressionTreeDepth) + 2;
+        
+        // Create a ternary expression (represented as special binary op)
+        auto condition = ast.create<BinaryExprAST>(BinaryOp::Ternary, expr, thenExpr);
+        return ast.create<BinaryExprAST>(BinaryOp::Ternary, condition, elseExpr);
     }
     
     return expr;
 }
 
-std::shared_ptr<ExprAST> Parser::parseShiftExpression() {
-    auto expr = parseTermExpression();
+// Operator-precedence climbing over the Precedence table in Token.h, from
+// `minPrec` up to ** . Pending operators wait on an explicit stack until an
+// operator that binds less tightly arrives, so chains of any length (either
+// associativity) parse without recursing per operator. `left` is the operand
+// just parsed, so expressionTreeDepth is its depth.
+ExprAST* Parser::parseBinaryExpression(ExprAST* left, Precedence minPrec) {
+    struct PendingOperator {
+        BinaryOp op;
+        Precedence precedence;
+    };
+    llvm::SmallVector<ExprAST*, 16> operands = {left};
+    llvm::SmallVector<int, 16> depths = {expressionTreeDepth};
+    llvm::SmallVector<PendingOperator, 16> operators;
+    
+    auto reduce = [&]() {
+        BinaryOp op = operators.pop_back_val().op;
+        ExprAST* right = operands.pop_back_val();
+        ExprAST* left = operands.pop_back_val();
+        operands.push_back(ast.create<BinaryExprAST>(op, left, right));
+        int rightDepth = depths.pop_back_val();
+        depths.back() = std::max(depths.back(), rightDepth) + 1;
+    };
     
-    while (match({TokenType::TOK_LEFT_SHIFT, TokenType::TOK_RIGHT_SHIFT, 
-                  TokenType::TOK_UNSIGNED_RIGHT_SHIFT})) {
-        std::string op = previous().value;
-        auto right = parseTermExpression();
-        expr = std::make_shared<BinaryExprAST>(op, expr, right);
+    while (true) {
+        TokenType type = peek().type;
+        Precedence precedence = getOperatorPrecedence(type);
+        if (precedence < minPrec || precedence < Precedence::LOGICAL_OR || precedence > Precedence::POWER) {
+            break;
+        }
+        
+        bool rightAssociative = isRightAssociative(type);
+        while (!operators.empty() &&
+               (operators.back().precedence > precedence ||
+                (operators.back().precedence == precedence && !rightAssociative))) {
+            reduce();
+        }
+        
+        advance();
+        operators.push_back({toBinaryOp(type), precedence});
+        operands.push_back(parseUnaryExpression());
+        depths.push_back(expressionTreeDepth);
     }
     
-    return expr;
+    while (!operators.empty()) {
+        reduce();
+    }
+    expressionTreeDepth = depths.front();
+    return operands.front();
 }
 
-// TERM: + and - have LOW precedence
-std::shared_ptr<ExprAST> Parser::parseTermExpression() {
-    auto expr = parseFactorExpression();
-    
-    while (match({TokenType::TOK_PLUS, TokenType::TOK_MINUS})) {
-        std::string op = previous().value;
-        auto right = parseFactorExpression();
-        expr = std::make_shared<BinaryExprAST>(op, expr, right);
-    }
-    
-    return expr;
+Precedence Parser::getOperatorPrecedence(TokenType type) {
+    return ::getOperatorPrecedence(type);
 }
 
-// FACTOR: *, /, % have HIGH precedence  
-std::shared_ptr<ExprAST> Parser::parseFactorExpression() {
-    auto expr = parsePowerExpression();
-    
-    while (match({TokenType::TOK_MULTIPLY, TokenType::TOK_DIVIDE, TokenType::TOK_MODULO})) {
-        std::string op = previous().value;
-        auto right = parsePowerExpression();
-        expr = std::make_shared<BinaryExprAST>(op, expr, right);
-    }
-    
-    return expr;
+bool Parser::isRightAssociative(TokenType type) {
+    return ::isRightAssociative(type);
 }
 
-// POWER: ** has HIGHEST precedence and is right-associative
-std::shared_ptr<ExprAST> Parser::parsePowerExpression() {
-    auto expr = parseUnaryExpression();
-    
-    if (match({TokenType::TOK_POWER})) {
-        std::string op = previous().value;
-        auto right = parsePowerExpression(); // Right associative
-        expr = std::make_shared<BinaryExprAST>(op, expr, right);
+bool Parser::isUnaryOperator(TokenType type) {
+    switch (type) {
+        case TokenType::TOK_LOGICAL_NOT:
+        case TokenType::TOK_NOT:
+        case TokenType::TOK_MINUS:
+        case TokenType::TOK_PLUS:
+        case TokenType::TOK_BIT_NOT:
+        case TokenType::TOK_INCREMENT:
+        case TokenType::TOK_DECREMENT:
+        case TokenType::TOK_ADDRESS_OF:
+        case TokenType::TOK_DEREFERENCE:
+            return true;
+        default:
+            return false;
     }
-    
-    return expr;
 }
 
-std::shared_ptr<ExprAST> Parser::parseUnaryExpression() {
-    if (match({TokenType::TOK_LOGICAL_NOT, TokenType::TOK_NOT, TokenType::TOK_MINUS, 
-               TokenType::TOK_PLUS, TokenType::TOK_BIT_NOT, TokenType::TOK_INCREMENT, 
-               TokenType::TOK_DECREMENT, TokenType::TOK_ADDRESS_OF, TokenType::TOK_DEREFERENCE})) {
-        std::string op = previous().value;
-        auto expr = parseUnaryExpression();
-        return std::make_shared<UnaryExprAST>(op, expr, true);
+ExprAST* Parser::parseUnaryExpression() {
+    // Prefix operators apply innermost-first: - ! x is -(!x)
+    llvm::SmallVector<UnaryOp, 4> prefixes;
+    while (isUnaryOperator(peek().type)) {
+        prefixes.push_back(toUnaryOp(advance().type));
     }
     
-    return parseCallExpression();
+    ExprAST* expr = parseCallExpression();
+    for (auto it = prefixes.rbegin(); it != prefixes.rend(); ++it) {
+        expr = ast.create<UnaryExprAST>(*it, expr, true);
+    }
+    expressionTreeDepth += static_cast<int>(prefixes.size());
+    return expr;
 }
 
-std::shared_ptr<ExprAST> Parser::parseCallExpression() {
+ExprAST* Parser::parseCallExpression() {
+    // Each postfix operator adds a level over the operand and whatever its
+    // arguments or index nest
+    int outerNested = nestedExpressionDepth;
+    nestedExpressionDepth = 0;
     auto expr = parsePrimaryExpression();
+    int depth = nestedExpressionDepth + 1;
     
     while (true) {
+        nestedExpressionDepth = 0;
         if (match({TokenType::TOK_LPAREN})) {
             // Function call
-            std::vector<std::shared_ptr<ExprAST>> args;
+            llvm::SmallVector<ExprAST*, 8> args;
             
             if (!check(TokenType::TOK_RPAREN)) {
                 do {
@@ -552,12 +649,12 @@ std::shared_ptr<ExprAST> Parser::parseCallExpression() {
             
             consume(TokenType::TOK_RPAREN, "Expected ')' after arguments");
             
-            if (auto varExpr = std::dynamic_pointer_cast<VariableExprAST>(expr)) {
+            if (auto varExpr = llvm::dyn_cast<VariableExprAST>(expr)) {
                 // Regular function call
-                expr = std::make_shared<CallExprAST>(varExpr->name, args);
-            } else if (auto memberExpr = std::dynamic_pointer_cast<MemberAccessExprAST>(expr)) {
+                expr = ast.create<CallExprAST>(varExpr->name, ast.list(args));
+            } else if (auto memberExpr = llvm::dyn_cast<MemberAccessExprAST>(expr)) {
                 // Method call: object.method()
-                expr = std::make_shared<MethodCallExprAST>(memberExpr->object, memberExpr->member, args);
+                expr = ast.create<MethodCallExprAST>(memberExpr->object, memberExpr->member, ast.list(args));
             } else {
                 // Other complex expression calls not yet implemented
                 throw parseError("Complex function calls not yet implemented");
@@ -569,24 +666,27 @@ std::shared_ptr<ExprAST> Parser::parseCallExpression() {
                 throw parseError("Expected property name after '.'");
             }
             
-            std::string member = advance().value;
-            expr = std::make_shared<MemberAccessExprAST>(expr, member);
+            Identifier member = advanceIdentifier();
+            expr = ast.create<MemberAccessExprAST>(expr, member);
             
         } else if (match({TokenType::TOK_LBRACKET})) {
             // Array/index access
             auto index = parseExpression();
             consume(TokenType::TOK_RBRACKET, "Expected ']' after index");
-            expr = std::make_shared<IndexExprAST>(expr, index);
+            expr = ast.create<IndexExprAST>(expr, index);
             
         } else {
             break;
         }
+        depth = std::max(depth, nestedExpressionDepth) + 1;
     }
     
+    nestedExpressionDepth = outerNested;
+    expressionTreeDepth = depth;
     return expr;
 }
 
-std::shared_ptr<ExprAST> Parser::parsePrimaryExpression() {
+ExprAST* Parser::parsePrimaryExpression() {
     // Numbers (including scientific notation)
     if (check(TokenType::TOK_NUMBER)) {
         return parseNumberLiteral();
@@ -613,14 +713,14 @@ std::shared_ptr<ExprAST> Parser::parsePrimaryExpression() {
     
     // Built-in functions
     if (check(TokenType::TOK_PRINTLN)) {
-        std::string name = advance().value;
-        return std::make_shared<VariableExprAST>(name);
+        Identifier name = advanceIdentifier();
+        return ast.create<VariableExprAST>(name);
     }
     
     // Self keyword
     if (check(TokenType::TOK_SELF)) {
-        std::string name = advance().value;
-        return std::make_shared<VariableExprAST>(name);
+        Identifier name = advanceIdentifier();
+        return ast.create<VariableExprAST>(name);
     }
     
     // New expressions (object instantiation)
@@ -631,10 +731,10 @@ std::shared_ptr<ExprAST> Parser::parsePrimaryExpression() {
             throw parseError("Expected class name after 'new'");
         }
         
-        std::string className = advance().value;
+        Identifier className = advanceIdentifier();
         
         // Parse constructor arguments
-        std::vector<std::shared_ptr<ExprAST>> args;
+        llvm::SmallVector<ExprAST*, 8> args;
         if (match({TokenType::TOK_LPAREN})) {
             if (!check(TokenType::TOK_RPAREN)) {
                 do {
@@ -644,13 +744,13 @@ std::shared_ptr<ExprAST> Parser::parsePrimaryExpression() {
             consume(TokenType::TOK_RPAREN, "Expected ')' after constructor arguments");
         }
         
-        return std::make_shared<NewExprAST>(className, args);
+        return ast.create<NewExprAST>(className, ast.list(args));
     }
     
     // Identifiers
     if (check(TokenType::TOK_IDENTIFIER)) {
-        std::string name = advance().value;
-        return std::make_shared<VariableExprAST>(name);
+        Identifier name = advanceIdentifier();
+        return ast.create<VariableExprAST>(name);
     }
     
     // Parenthesized expressions
@@ -670,38 +770,39 @@ std::shared_ptr<ExprAST> Parser::parsePrimaryExpression() {
 
 // ==================== LITERAL PARSING ====================
 
-std::shared_ptr<ExprAST> Parser::parseNumberLiteral() {
-    Token token = advance();
-    double value = std::stod(token.value);
-    return std::make_shared<NumberExprAST>(value, false, token.value);
+ExprAST* Parser::parseNumberLiteral() {
+    const Token& token = advance();
+    std::string_view text = ast.string(token.value);
+    double value = std::stod(std::string(text));
+    return ast.create<NumberExprAST>(value, false, text);
 }
 
-std::shared_ptr<ExprAST> Parser::parseScientificLiteral() {
-    Token token = advance();
-    double value = std::stod(token.value);
-    return std::make_shared<ScientificExprAST>(value, token.value);
+ExprAST* Parser::parseScientificLiteral() {
+    const Token& token = advance();
+    std::string_view text = ast.string(token.value);
+    double value = std::stod(std::string(text));
+    return ast.create<ScientificExprAST>(value, text);
 }
 
-std::shared_ptr<ExprAST> Parser::parseStringLiteral() {
-    Token token = advance();
-    return std::make_shared<StringExprAST>(token.value);
+ExprAST* Parser::parseStringLiteral() {
+    return ast.create<StringExprAST>(advanceText());
 }
 
-std::shared_ptr<ExprAST> Parser::parseBoolLiteral() {
-    Token token = advance();
+ExprAST* Parser::parseBoolLiteral() {
+    const Token& token = advance();
     bool value = (token.type == TokenType::TOK_TRUE);
-    return std::make_shared<BoolExprAST>(value);
+    return ast.create<BoolExprAST>(value);
 }
 
-std::shared_ptr<ExprAST> Parser::parseNullLiteral() {
+ExprAST* Parser::parseNullLiteral() {
     advance(); // consume null/none token
-    return std::make_shared<NullExprAST>();
+    return ast.create<NullExprAST>();
 }
 
-std::shared_ptr<ExprAST> Parser::parseListExpression() {
+ExprAST* Parser::parseListExpression() {
     consume(TokenType::TOK_LBRACKET, "Expected '['");
     
-    std::vector<std::shared_ptr<ExprAST>> elements;
+    llvm::SmallVector<ExprAST*, 8> elements;
     
     if (!check(TokenType::TOK_RBRACKET)) {
         do {
@@ -711,7 +812,7 @@ std::shared_ptr<ExprAST> Parser::parseListExpression() {
     
     consume(TokenType::TOK_RBRACKET, "Expected ']' after list elements");
     
-    return std::make_shared<ListExprAST>(elements);
+    return ast.create<ListExprAST>(ast.list(elements));
 }
 
 // ==================== UTILITY METHODS ====================
@@ -731,80 +832,80 @@ bool Parser::isAssignmentOperator(TokenType type) {
            type == TokenType::TOK_RIGHT_SHIFT_ASSIGN;
 }
 
-std::shared_ptr<TypeInfo> Parser::parseType() {
+const TypeInfo* Parser::parseType() {
     // Parse primitive types
-    if (match({TokenType::TOK_INT8})) return std::make_shared<TypeInfo>(FlastType::I8);
-    if (match({TokenType::TOK_INT16})) return std::make_shared<TypeInfo>(FlastType::I16);
-    if (match({TokenType::TOK_INT32})) return std::make_shared<TypeInfo>(FlastType::I32);
-    if (match({TokenType::TOK_INT64})) return std::make_shared<TypeInfo>(FlastType::I64);
-    if (match({TokenType::TOK_INT128})) return std::make_shared<TypeInfo>(FlastType::I128);
-    if (match({TokenType::TOK_UINT8})) return std::make_shared<TypeInfo>(FlastType::U8);
-    if (match({TokenType::TOK_UINT16})) return std::make_shared<TypeInfo>(FlastType::U16);
-    if (match({TokenType::TOK_UINT32})) return std::make_shared<TypeInfo>(FlastType::U32);
-    if (match({TokenType::TOK_UINT64})) return std::make_shared<TypeInfo>(FlastType::U64);
-    if (match({TokenType::TOK_UINT128})) return std::make_shared<TypeInfo>(FlastType::U128);
-    if (match({TokenType::TOK_FLOAT32})) return std::make_shared<TypeInfo>(FlastType::F32);
-    if (match({TokenType::TOK_FLOAT64})) return std::make_shared<TypeInfo>(FlastType::F64);
-    if (match({TokenType::TOK_BOOL_TYPE})) return std::make_shared<TypeInfo>(FlastType::BOOL);
-    if (match({TokenType::TOK_STRING_TYPE})) return std::make_shared<TypeInfo>(FlastType::STRING);
-    if (match({TokenType::TOK_CHAR_TYPE})) return std::make_shared<TypeInfo>(FlastType::CHAR);
-    if (match({TokenType::TOK_VOID})) return std::make_shared<TypeInfo>(FlastType::VOID);
-    if (match({TokenType::TOK_POINTER})) return std::make_shared<TypeInfo>(FlastType::REF);
+    if (match({TokenType::TOK_INT8})) return g_typeContext.get(FlastType::I8);
+    if (match({TokenType::TOK_INT16})) return g_typeContext.get(FlastType::I16);
+    if (match({TokenType::TOK_INT32})) return g_typeContext.get(FlastType::I32);
+    if (match({TokenType::TOK_INT64})) return g_typeContext.get(FlastType::I64);
+    if (match({TokenType::TOK_INT128})) return g_typeContext.get(FlastType::I128);
+    if (match({TokenType::TOK_UINT8})) return g_typeContext.get(FlastType::U8);
+    if (match({TokenType::TOK_UINT16})) return g_typeContext.get(FlastType::U16);
+    if (match({TokenType::TOK_UINT32})) return g_typeContext.get(FlastType::U32);
+    if (match({TokenType::TOK_UINT64})) return g_typeContext.get(FlastType::U64);
+    if (match({TokenType::TOK_UINT128})) return g_typeContext.get(FlastType::U128);
+    if (match({TokenType::TOK_FLOAT32})) return g_typeContext.get(FlastType::F32);
+    if (match({TokenType::TOK_FLOAT64})) return g_typeContext.get(FlastType::F64);
+    if (match({TokenType::TOK_BOOL_TYPE})) return g_typeContext.get(FlastType::BOOL);
+    if (match({TokenType::TOK_STRING_TYPE})) return g_typeContext.get(FlastType::STRING);
+    if (match({TokenType::TOK_CHAR_TYPE})) return g_typeContext.get(FlastType::CHAR);
+    if (match({TokenType::TOK_VOID})) return g_typeContext.get(FlastType::VOID);
+    if (match({TokenType::TOK_POINTER})) return g_typeContext.get(FlastType::REF);
     
     // Self type (for struct methods)
-    if (match({TokenType::TOK_SELF_TYPE})) return std::make_shared<TypeInfo>(FlastType::SELF);
+    if (match({TokenType::TOK_SELF_TYPE})) return g_typeContext.get(FlastType::SELF);
     
     // Auto type inference
-    if (match({TokenType::TOK_AUTO})) return std::make_shared<TypeInfo>(FlastType::AUTO);
+    if (match({TokenType::TOK_AUTO})) return g_typeContext.get(FlastType::AUTO);
     
     // Parse complex type expressions (e.g., lib.merk.car, std::vector<int>)
     return parseComplexType();
 }
 
-std::shared_ptr<TypeInfo> Parser::parseComplexType() {
+const TypeInfo* Parser::parseComplexType() {
     // Start with the base identifier
     if (!check(TokenType::TOK_IDENTIFIER)) {
         throw parseError("Expected type identifier");
     }
     
-    std::string baseName = advance().value;
-    auto typeInfo = std::make_shared<TypeInfo>(FlastType::STRUCT, baseName);
+    std::string baseName(advance().value);
     
     // Parse qualified names (e.g., lib.merk.car)
     while (match({TokenType::TOK_DOT})) {
         if (!check(TokenType::TOK_IDENTIFIER)) {
             throw parseError("Expected identifier after '.' in type name");
         }
-        std::string qualifier = advance().value;
-        typeInfo->className += "." + qualifier;
+        baseName += ".";
+        baseName += advance().value;
     }
+    TypeInfo shape(FlastType::STRUCT, Identifier(baseName));
     
     // Parse generic parameters (e.g., vector<int>, map<string, int>)
     if (match({TokenType::TOK_LESS})) {
-        typeInfo->parameters = parseGenericParameters();
+        shape.parameters = parseGenericParameters();
         consume(TokenType::TOK_GREATER, "Expected '>' after generic parameters");
     }
     
     // Parse pointer/reference modifiers
     while (true) {
         if (match({TokenType::TOK_MULTIPLY})) {
-            typeInfo->isPointer = true;
+            shape.isPointer = true;
         } else if (match({TokenType::TOK_REF})) {
-            typeInfo->isReference = true;
+            shape.isReference = true;
         } else if (match({TokenType::TOK_CONSTANT})) {
-            typeInfo->isConst = true;
+            shape.isConst = true;
         } else {
             break;
         }
     }
+    const TypeInfo* typeInfo = g_typeContext.get(shape);
     
     // Parse optional type (e.g., option<int>)
     if (match({TokenType::TOK_OPTION})) {
         consume(TokenType::TOK_LESS, "Expected '<' after 'option'");
         auto innerType = parseType();
         consume(TokenType::TOK_GREATER, "Expected '>' after option type");
-        typeInfo = std::make_shared<TypeInfo>(FlastType::OPTION);
-        typeInfo->parameters.push_back(innerType);
+        typeInfo = g_typeContext.get(FlastType::OPTION, {innerType});
     }
     
     // Parse result type (e.g., result<int, string>)
@@ -814,9 +915,7 @@ std::shared_ptr<TypeInfo> Parser::parseComplexType() {
         consume(TokenType::TOK_COMMA, "Expected ',' between result types");
         auto errType = parseType();
         consume(TokenType::TOK_GREATER, "Expected '>' after result types");
-        typeInfo = std::make_shared<TypeInfo>(FlastType::RESULT);
-        typeInfo->parameters.push_back(okType);
-        typeInfo->parameters.push_back(errType);
+        typeInfo = g_typeContext.get(FlastType::RESULT, {okType, errType});
     }
     
     // Parse array types (e.g., array<int, 10>)
@@ -827,12 +926,10 @@ std::shared_ptr<TypeInfo> Parser::parseComplexType() {
         
         // Parse array size (can be a number or expression)
         if (check(TokenType::TOK_NUMBER)) {
-            std::string sizeStr = advance().value;
+            Identifier sizeStr = advanceIdentifier();
             // For now, we'll store the size as a string in className
             // In a full implementation, you'd want to parse this as an expression
-            typeInfo = std::make_shared<TypeInfo>(FlastType::ARRAY);
-            typeInfo->parameters.push_back(elementType);
-            typeInfo->className = sizeStr;
+            typeInfo = g_typeContext.get(FlastType::ARRAY, {elementType}, sizeStr);
         } else {
             throw parseError("Expected array size");
         }
@@ -842,8 +939,8 @@ std::shared_ptr<TypeInfo> Parser::parseComplexType() {
     return typeInfo;
 }
 
-std::vector<ParameterAST> Parser::parseParameterList() {
-    std::vector<ParameterAST> parameters;
+ASTList<ParameterAST> Parser::parseParameterList() {
+    llvm::SmallVector<ParameterAST, 8> parameters;
     
     if (!check(TokenType::TOK_RPAREN)) {
         do {
@@ -851,7 +948,7 @@ std::vector<ParameterAST> Parser::parseParameterList() {
         } while (match({TokenType::TOK_COMMA}));
     }
     
-    return parameters;
+    return ast.list(parameters);
 }
 
 ParameterAST Parser::parseParameter() {
@@ -859,13 +956,13 @@ ParameterAST Parser::parseParameter() {
         throw parseError("Expected parameter name");
     }
     
-    std::string name = advance().value;
+    Identifier name = advanceIdentifier();
     consume(TokenType::TOK_COLON, "Expected ':' after parameter name");
     
     auto type = parseType();
     
     // Default value
-    std::shared_ptr<ExprAST> defaultValue = nullptr;
+    ExprAST* defaultValue = nullptr;
     if (match({TokenType::TOK_ASSIGN})) {
         defaultValue = parseExpression();
     }
@@ -873,17 +970,17 @@ ParameterAST Parser::parseParameter() {
     return ParameterAST(name, type, defaultValue);
 }
 
-std::vector<std::shared_ptr<TypeInfo>> Parser::parseGenericParameters() {
-    std::vector<std::shared_ptr<TypeInfo>> generics;
+ASTList<const TypeInfo*> Parser::parseGenericParameters() {
+    llvm::SmallVector<const TypeInfo*, 8> generics;
     
     do {
         generics.push_back(parseType());
     } while (match({TokenType::TOK_COMMA}));
     
-    return generics;
+    return ast.list(generics);
 }
 
-void Parser::enterFunction(std::shared_ptr<TypeInfo> returnType) {
+void Parser::enterFunction(const TypeInfo* returnType) {
     inFunction = true;
     currentFunctionReturnType = returnType;
 }
@@ -911,18 +1008,18 @@ void Parser::attachSemanticAnalyzer(std::shared_ptr<SemanticAnalyzer> analyzer)
 
 // ==================== MISSING IMPLEMENTATIONS ====================
 
-std::shared_ptr<TraitDeclAST> Parser::parseTraitDecl() {
+TraitDeclAST* Parser::parseTraitDecl() {
     consume(TokenType::TOK_TRAIT, "Expected 'trait'");
     
     if (!check(TokenType::TOK_IDENTIFIER)) {
         throw parseError("Expected trait name");
     }
     
-    std::string name = advance().value;
+    std::string_view name = advanceText();
     
     consume(TokenType::TOK_LBRACE, "Expected '{' after trait name");
     
-    std::vector<std::shared_ptr<DeclAST>> methods;
+    llvm::SmallVector<DeclAST*, 8> methods;
     
     while (!check(TokenType::TOK_RBRACE) && !isAtEnd()) {
         if (check(TokenType::TOK_FUNC)) {
@@ -934,17 +1031,17 @@ std::shared_ptr<TraitDeclAST> Parser::parseTraitDecl() {
     
     consume(TokenType::TOK_RBRACE, "Expected '}' after trait methods");
     
-    return std::make_shared<TraitDeclAST>(name, methods);
+    return ast.create<TraitDeclAST>(name, ast.list(methods));
 }
 
-std::shared_ptr<ImplDeclAST> Parser::parseImplDecl() {
+ImplDeclAST* Parser::parseImplDecl() {
     consume(TokenType::TOK_IMPL, "Expected 'impl'");
     
     auto targetType = parseType();
     
     consume(TokenType::TOK_LBRACE, "Expected '{' after impl target");
     
-    std::vector<std::shared_ptr<DeclAST>> methods;
+    llvm::SmallVector<DeclAST*, 8> methods;
     
     while (!check(TokenType::TOK_RBRACE) && !isAtEnd()) {
         if (check(TokenType::TOK_FUNC)) {
@@ -956,17 +1053,17 @@ std::shared_ptr<ImplDeclAST> Parser::parseImplDecl() {
     
     consume(TokenType::TOK_RBRACE, "Expected '}' after impl methods");
     
-    return std::make_shared<ImplDeclAST>(targetType, methods);
+    return ast.create<ImplDeclAST>(targetType, ast.list(methods));
 }
 
 
 
-std::shared_ptr<ImportDeclAST> Parser::parseImportDecl() {
+ImportDeclAST* Parser::parseImportDecl() {
     advance(); // consume 'import' or 'use'
     
-    std::vector<std::string> specificImports;
-    std::string alias;
-    std::string moduleName;
+    llvm::SmallVector<std::string_view, 8> specificImports;
+    std::string_view alias;
+    std::string_view moduleName;
     bool isWildcard = false;
     
     // Handle "import { func1, func2 } from 'module'" or "import func from 'module'"
@@ -978,7 +1075,7 @@ std::shared_ptr<ImportDeclAST> Parser::parseImportDecl() {
             if (!check(TokenType::TOK_IDENTIFIER)) {
                 throw parseError("Expected import name");
             }
-            specificImports.push_back(advance().value);
+            specificImports.push_back(advanceText());
         } while (match({TokenType::TOK_COMMA}));
         
         consume(TokenType::TOK_RBRACE, "Expected '}' after import list");
@@ -990,44 +1087,43 @@ std::shared_ptr<ImportDeclAST> Parser::parseImportDecl() {
         
     } else if (check(TokenType::TOK_IDENTIFIER)) {
         // Default import: import name from "module"
-        std::string importName = advance().value;
-        specificImports.push_back(importName);
+        specificImports.push_back(advanceText());
     }
     
     // Handle "from" keyword
     if (match({TokenType::TOK_FROM}) || match({TokenType::TOK_IDENTIFIER})) {
         // Skip if it's "from" or treat as module name if no "from"
         if (previous().value != "from" && check(TokenType::TOK_STRING)) {
-            moduleName = previous().value; // It's actually module name
+            moduleName = ast.string(previous().value); // It's actually module name
         }
     }
     
     // Get module path
     if (check(TokenType::TOK_STRING)) {
-        moduleName = advance().value;
+        moduleName = advanceText();
     } else if (check(TokenType::TOK_IDENTIFIER)) {
-        moduleName = advance().value;
+        moduleName = advanceText();
     } else if (moduleName.empty()) {
         throw parseError("Expected module path");
     }
     
     consume(TokenType::TOK_SEMICOLON, "Expected ';' after import");
     
-    return std::make_shared<ImportDeclAST>(moduleName, alias, specificImports, isWildcard);
+    return ast.create<ImportDeclAST>(moduleName, alias, ast.list(specificImports), isWildcard);
 }
 
-std::shared_ptr<ModuleDeclAST> Parser::parseModuleDecl() {
+ModuleDeclAST* Parser::parseModuleDecl() {
     consume(TokenType::TOK_MOD, "Expected 'mod'");
     
     if (!check(TokenType::TOK_IDENTIFIER)) {
         throw parseError("Expected module name");
     }
     
-    std::string name = advance().value;
+    std::string_view name = advanceText();
     
     consume(TokenType::TOK_LBRACE, "Expected '{' after module name");
     
-    std::vector<std::shared_ptr<DeclAST>> declarations;
+    llvm::SmallVector<DeclAST*, 8> declarations;
     
     while (!check(TokenType::TOK_RBRACE) && !isAtEnd()) {
         if (auto decl = parseDeclaration()) {
@@ -1037,10 +1133,10 @@ std::shared_ptr<ModuleDeclAST> Parser::parseModuleDecl() {
     
     consume(TokenType::TOK_RBRACE, "Expected '}' after module body");
     
-    return std::make_shared<ModuleDeclAST>(name, declarations);
+    return ast.create<ModuleDeclAST>(name, ast.list(declarations));
 }
 
-std::shared_ptr<VarDeclStmtAST> Parser::parseVarDecl() {
+VarDeclStmtAST* Parser::parseVarDecl() {
     bool isConst = match({TokenType::TOK_CONST});
     
     if (!isConst) {
@@ -1051,34 +1147,34 @@ std::shared_ptr<VarDeclStmtAST> Parser::parseVarDecl() {
         throw parseError("Expected variable name");
     }
     
-    std::string name = advance().value;
+    Identifier name = advanceIdentifier();
     
-    std::shared_ptr<TypeInfo> type = nullptr;
+    const TypeInfo* type = nullptr;
     if (match({TokenType::TOK_COLON})) {
         type = parseType();
     }
     
-    std::shared_ptr<ExprAST> initializer = nullptr;
+    ExprAST* initializer = nullptr;
     if (match({TokenType::TOK_ASSIGN})) {
         initializer = parseExpression();
     }
     
     consume(TokenType::TOK_SEMICOLON, "Expected ';' after variable declaration");
     
-    return std::make_shared<VarDeclStmtAST>(name, type, initializer, isConst);
+    return ast.create<VarDeclStmtAST>(name, type, initializer, isConst);
 }
 
-std::shared_ptr<BlockStmtAST> Parser::parseBlock() {
+BlockStmtAST* Parser::parseBlock() {
     consume(TokenType::TOK_LBRACE, "Expected '{'");
     
-    std::vector<std::shared_ptr<StmtAST>> statements;
+    llvm::SmallVector<StmtAST*, 8> statements;
     
     while (!check(TokenType::TOK_RBRACE) && !isAtEnd()) {
         if (check(TokenType::TOK_RETURN)) {
             advance(); // consume 'return'
             auto expr = parseExpression();
             consume(TokenType::TOK_SEMICOLON, "Expected ';' after return");
-            statements.push_back(std::make_shared<ReturnStmtAST>(expr));
+            statements.push_back(ast.create<ReturnStmtAST>(expr));
         } else if (check(TokenType::TOK_LET) || check(TokenType::TOK_CONST)) {
             // Parse variable declaration
             auto varDecl = parseVarDecl();
@@ -1095,16 +1191,16 @@ std::shared_ptr<BlockStmtAST> Parser::parseBlock() {
             // Parse expression statement (like println call)
             auto expr = parseExpression();
             consume(TokenType::TOK_SEMICOLON, "Expected ';' after expression");
-            statements.push_back(std::make_shared<ExprStmtAST>(expr));
+            statements.push_back(ast.create<ExprStmtAST>(expr));
         }
     }
     
     consume(TokenType::TOK_RBRACE, "Expected '}'");
     
-    return std::make_shared<BlockStmtAST>(statements);
+    return ast.create<BlockStmtAST>(ast.list(statements));
 }
 
-std::shared_ptr<WhileStmtAST> Parser::parseWhileStatement() {
+WhileStmtAST* Parser::parseWhileStatement() {
     consume(TokenType::TOK_WHILE, "Expected 'while'");
     
     // Parse condition (without parentheses - Rust style)
@@ -1113,10 +1209,10 @@ std::shared_ptr<WhileStmtAST> Parser::parseWhileStatement() {
     // Parse body
     auto body = parseBlock();
     
-    return std::make_shared<WhileStmtAST>(condition, body);
+    return ast.create<WhileStmtAST>(condition, body);
 }
 
-std::shared_ptr<StmtAST> Parser::parseForStatement() {
+StmtAST* Parser::parseForStatement() {
     consume(TokenType::TOK_FOR, "Expected 'for'");
     
     // Check if this is a for-in loop by looking ahead
@@ -1147,38 +1243,38 @@ std::shared_ptr<StmtAST> Parser::parseForStatement() {
     
     // Parse C-style for loop
     // Parse initialization
-    std::shared_ptr<StmtAST> init = nullptr;
+    StmtAST* init = nullptr;
     if (check(TokenType::TOK_LET) || check(TokenType::TOK_CONST)) {
         init = parseVarDecl();
     } else if (!check(TokenType::TOK_SEMICOLON)) {
         auto expr = parseExpression();
         consume(TokenType::TOK_SEMICOLON, "Expected ';' after for loop init");
-        init = std::make_shared<ExprStmtAST>(expr);
+        init = ast.create<ExprStmtAST>(expr);
     } else {
         advance(); // consume ';' for empty init
     }
     
     // Parse condition
-    std::shared_ptr<ExprAST> condition = nullptr;
+    ExprAST* condition = nullptr;
     if (!check(TokenType::TOK_SEMICOLON)) {
         condition = parseExpression();
     }
     consume(TokenType::TOK_SEMICOLON, "Expected ';' after for loop condition");
     
     // Parse update
-    std::shared_ptr<StmtAST> update = nullptr;
+    StmtAST* update = nullptr;
     if (!check(TokenType::TOK_LBRACE)) {
         auto expr = parseExpression();
-        update = std::make_shared<ExprStmtAST>(expr);
+        update = ast.create<ExprStmtAST>(expr);
     }
     
     // Parse body
     auto body = parseBlock();
     
-    return std::make_shared<ForStmtAST>(init, condition, update, body);
+    return ast.create<ForStmtAST>(init, condition, update, body);
 }
 
-std::shared_ptr<ForInStmtAST> Parser::parseForInStatement() {
+ForInStmtAST* Parser::parseForInStatement() {
     // Already consumed 'for', now parse: let variable: type in iterable { body }
     consume(TokenType::TOK_LET, "Expected 'let' in for-in loop");
     
@@ -1186,7 +1282,7 @@ std::shared_ptr<ForInStmtAST> Parser::parseForInStatement() {
         throw parseError("Expected variable name in for-in loop");
     }
     
-    std::string variable = advance().value;
+    Identifier variable = advanceIdentifier();
     
     // Optional type annotation
     if (match({TokenType::TOK_COLON})) {
@@ -1201,7 +1297,7 @@ std::shared_ptr<ForInStmtAST> Parser::parseForInStatement() {
     // Parse body
     auto body = parseBlock();
     
-    return std::make_shared<ForInStmtAST>(variable, iterable, body);
+    return ast.create<ForInStmtAST>(variable, iterable, body);
 }
 
 void Parser::printErrors() const {
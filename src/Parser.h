@@ -3,6 +3,7 @@
 #include "AST.h"
 #include "SemanticAnalyzer.h"
 #include "ErrorHandler.h"
+#include "TokenStream.h"
 #include <vector>
 #include <memory>
 #include <unordered_map>
@@ -18,27 +19,41 @@ public:
         : std::runtime_error(message), line(line), column(column), errorCode(code) {}
 };
 
-class Parser {
+class Parser : public BodySource {
 private:
     std::vector<Token> tokens;
+    TokenStream* stream = nullptr;  // when set, tokens come from here instead
     size_t current;
     std::string fileName;
+    ASTContext& ast;  // owns every node this parser creates
     std::shared_ptr<SemanticAnalyzer> semanticAnalyzer;
     
     // Parser state
     bool inLoop = false;
     bool inFunction = false;
     int genericDepth = 0;
+    int expressionDepth = 0;
+    static constexpr int kMaxExpressionDepth = 1024;
+    // Chains are parsed in loops, so the trees they build are bounded
+    // separately: the depth of the expression last parsed, and of the
+    // deepest one nested in the operand a postfix chain is building
+    int expressionTreeDepth = 0;
+    int nestedExpressionDepth = 0;
+    bool lazyFunctionBodies = false;
+    size_t deferredBodies = 0;
     
     // Helper methods
+    Token& tokenAt(size_t index);
     Token& peek();
     Token& peekNext();
     Token& previous();
     bool isAtEnd();
     bool check(TokenType type);
     bool match(std::initializer_list<TokenType> types);
-    Token advance();
-    void consume(TokenType type, const std::string& message);
+    const Token& advance();
+    Identifier advanceIdentifier();
+    std::string_view advanceText();  // token text copied into the arena
+    void consume(TokenType type, const char* message);
     
     // Error handling
     void error(const std::string& message);
@@ -46,92 +61,94 @@ private:
     ParseError parseError(const std::string& message);
     
     // Type parsing
-    std::shared_ptr<TypeInfo> parseType();
-    std::shared_ptr<TypeInfo> parseComplexType();
-    std::shared_ptr<TypeInfo> parseGenericType();
-    std::vector<std::shared_ptr<TypeInfo>> parseGenericParameters();
+    const TypeInfo* parseType();
+    const TypeInfo* parseComplexType();
+    const TypeInfo* parseGenericType();
+    ASTList<const TypeInfo*> parseGenericParameters();
     
 public:
-    Parser(const std::vector<Token>& tokens, const std::string& fileName = "");
+    Parser(std::vector<Token>&& tokens, ASTContext& ast, const std::string& fileName = "");
+    // Streaming parser: pulls tokens through a bounded lookahead window
+    Parser(TokenStream& stream, ASTContext& ast, const std::string& fileName = "");
     
     // Main parsing entry point
-    std::shared_ptr<ProgramAST> parseProgram();
+    ProgramAST* parseProgram();
+    
+    // Next top-level declaration, or nullptr at end of input. Nodes go into
+    // the ASTContext given at construction, which the caller may reset
+    // between declarations once it is done with the previous one.
+    DeclAST* parseNextDeclaration();
+    
+    // Skip top-level function bodies by brace matching and keep only their
+    // signatures; the parser must then outlive the AST so that
+    // FunctionDeclAST::ensureBody can parse a body from its token range.
+    void setLazyFunctionBodies(bool lazy) { lazyFunctionBodies = lazy; }
+    size_t getDeferredBodyCount() const { return deferredBodies; }
+    BlockStmtAST* loadBody(FunctionDeclAST& func, const DeferredBody& range) override;
     
     // Declaration parsing (Rust-like)
-    std::shared_ptr<DeclAST> parseDeclaration();
-    std::shared_ptr<FunctionDeclAST> parseFunctionDecl();  // func keyword
-    std::shared_ptr<StructDeclAST> parseStructDecl();     // struct keyword  
-    std::shared_ptr<EnumDeclAST> parseEnumDecl();         // enum keyword
-    std::shared_ptr<TraitDeclAST> parseTraitDecl();       // trait keyword
-    std::shared_ptr<ImplDeclAST> parseImplDecl();         // impl keyword
-    std::shared_ptr<ImportDeclAST> parseImportDecl();     // import/use keywords
-    std::shared_ptr<ModuleDeclAST> parseModuleDecl();     // mod keyword
+    DeclAST* parseDeclaration();
+    FunctionDeclAST* parseFunctionDecl(bool deferBody = false);  // func keyword
+    StructDeclAST* parseStructDecl();     // struct keyword  
+    EnumDeclAST* parseEnumDecl();         // enum keyword
+    TraitDeclAST* parseTraitDecl();       // trait keyword
+    ImplDeclAST* parseImplDecl();         // impl keyword
+    ImportDeclAST* parseImportDecl();     // import/use keywords
+    ModuleDeclAST* parseModuleDecl();     // mod keyword
     
     // Statement parsing
-    std::shared_ptr<StmtAST> parseStatement();
-    std::shared_ptr<VarDeclStmtAST> parseVarDecl();
-    std::shared_ptr<AssignStmtAST> parseAssignment();
-    std::shared_ptr<ExprStmtAST> parseExpressionStatement();
-    std::shared_ptr<BlockStmtAST> parseBlock();
-    std::shared_ptr<IfStmtAST> parseIfStatement();
-    std::shared_ptr<WhileStmtAST> parseWhileStatement();
-    std::shared_ptr<StmtAST> parseForStatement();  // Can return ForStmtAST or ForInStmtAST
-    std::shared_ptr<ForInStmtAST> parseForInStatement();
-    std::shared_ptr<MatchStmtAST> parseMatchStatement();  // Pattern matching
-    std::shared_ptr<ReturnStmtAST> parseReturnStatement();
-    std::shared_ptr<BreakStmtAST> parseBreakStatement();
-    std::shared_ptr<ContinueStmtAST> parseContinueStatement();
-    std::shared_ptr<TryCatchStmtAST> parseTryCatchStatement();
-    std::shared_ptr<ThrowStmtAST> parseThrowStatement();
+    StmtAST* parseStatement();
+    VarDeclStmtAST* parseVarDecl();
+    AssignStmtAST* parseAssignment();
+    ExprStmtAST* parseExpressionStatement();
+    BlockStmtAST* parseBlock();
+    IfStmtAST* parseIfStatement();
+    WhileStmtAST* parseWhileStatement();
+    StmtAST* parseForStatement();  // Can return ForStmtAST or ForInStmtAST
+    ForInStmtAST* parseForInStatement();
+    MatchStmtAST* parseMatchStatement();  // Pattern matching
+    ReturnStmtAST* parseReturnStatement();
+    BreakStmtAST* parseBreakStatement();
+    ContinueStmtAST* parseContinueStatement();
+    TryCatchStmtAST* parseTryCatchStatement();
+    ThrowStmtAST* parseThrowStatement();
     
     // Expression parsing with proper precedence
-    std::shared_ptr<ExprAST> parseExpression();
-    std::shared_ptr<ExprAST> parseAssignmentExpression();
-    std::shared_ptr<ExprAST> parseTernaryExpression();
-    std::shared_ptr<ExprAST> parseLogicalOrExpression();
-    std::shared_ptr<ExprAST> parseLogicalAndExpression();
-    std::shared_ptr<ExprAST> parseBitwiseOrExpression();
-    std::shared_ptr<ExprAST> parseBitwiseXorExpression();
-    std::shared_ptr<ExprAST> parseBitwiseAndExpression();
-    std::shared_ptr<ExprAST> parseEqualityExpression();
-    std::shared_ptr<ExprAST> parseComparisonExpression();
-    std::shared_ptr<ExprAST> parseShiftExpression();
-    std::shared_ptr<ExprAST> parseTermExpression();      // + -
-    std::shared_ptr<ExprAST> parseFactorExpression();    // * / %
-    std::shared_ptr<ExprAST> parsePowerExpression();     // **
-    std::shared_ptr<ExprAST> parseUnaryExpression();
-    std::shared_ptr<ExprAST> parseCallExpression();
-    std::shared_ptr<ExprAST> parsePrimaryExpression();
+    ExprAST* parseExpression();          // assignment chains
+    ExprAST* parseTernaryExpression();   // ?:
+    ExprAST* parseUnaryExpression();
+    ExprAST* parseCallExpression();
+    ExprAST* parsePrimaryExpression();
     
     // Advanced expression parsing
-    std::shared_ptr<ExprAST> parseBinaryExpression(std::shared_ptr<ExprAST> left, Precedence minPrec);
-    std::shared_ptr<ExprAST> parsePostfixExpression(std::shared_ptr<ExprAST> expr);
-    std::shared_ptr<ExprAST> parseLambdaExpression();
-    std::shared_ptr<ExprAST> parseListExpression();
-    std::shared_ptr<ExprAST> parseMapExpression();
-    std::shared_ptr<ExprAST> parseTupleExpression();
-    std::shared_ptr<ExprAST> parseStructInitExpression();
-    std::shared_ptr<ExprAST> parseEnumVariantExpression();
+    ExprAST* parseBinaryExpression(ExprAST* left, Precedence minPrec);  // || through **
+    ExprAST* parsePostfixExpression(ExprAST* expr);
+    ExprAST* parseLambdaExpression();
+    ExprAST* parseListExpression();
+    ExprAST* parseMapExpression();
+    ExprAST* parseTupleExpression();
+    ExprAST* parseStructInitExpression();
+    ExprAST* parseEnumVariantExpression();
     
     // Literal parsing with scientific notation support
-    std::shared_ptr<ExprAST> parseNumberLiteral();
-    std::shared_ptr<ExprAST> parseScientificLiteral();
-    std::shared_ptr<ExprAST> parseStringLiteral();
-    std::shared_ptr<ExprAST> parseCharLiteral();
-    std::shared_ptr<ExprAST> parseBoolLiteral();
-    std::shared_ptr<ExprAST> parseNullLiteral();
+    ExprAST* parseNumberLiteral();
+    ExprAST* parseScientificLiteral();
+    ExprAST* parseStringLiteral();
+    ExprAST* parseCharLiteral();
+    ExprAST* parseBoolLiteral();
+    ExprAST* parseNullLiteral();
     
     // Pattern parsing (for match expressions)
-    std::shared_ptr<ExprAST> parsePattern();
-    std::shared_ptr<ExprAST> parseStructPattern();
-    std::shared_ptr<ExprAST> parseEnumPattern();
-    std::shared_ptr<ExprAST> parseWildcardPattern();
-    std::shared_ptr<ExprAST> parseGuardPattern();
+    ExprAST* parsePattern();
+    ExprAST* parseStructPattern();
+    ExprAST* parseEnumPattern();
+    ExprAST* parseWildcardPattern();
+    ExprAST* parseGuardPattern();
     
     // Parameter and generic parsing
-    std::vector<ParameterAST> parseParameterList();
+    ASTList<ParameterAST> parseParameterList();
     ParameterAST parseParameter();
-    std::vector<std::shared_ptr<TypeInfo>> parseGenericConstraints();
+    ASTList<const TypeInfo*> parseGenericConstraints();
     
     // Import/module parsing (TypeScript-like)
     std::vector<std::string> parseImportSpecifiers();
@@ -150,7 +167,7 @@ public:
     
     // Built-in method recognition
     bool isBuiltinMethod(const std::string& methodName);
-    std::shared_ptr<ExprAST> parseBuiltinMethodCall(std::shared_ptr<ExprAST> object, const std::string& methodName);
+    ExprAST* parseBuiltinMethodCall(ExprAST* object, const std::string& methodName);
     
     // Error recovery
     void skipToNextStatement();
@@ -158,9 +175,9 @@ public:
     void skipToMatchingParen();
     
     // Validation helpers
-    bool validateGenericConstraints(const std::vector<std::shared_ptr<TypeInfo>>& constraints);
-    bool validateParameterList(const std::vector<ParameterAST>& parameters);
-    bool validateReturnType(std::shared_ptr<TypeInfo> returnType);
+    bool validateGenericConstraints(const ASTList<const TypeInfo*>& constraints);
+    bool validateParameterList(const ASTList<ParameterAST>& parameters);
+    bool validateReturnType(const TypeInfo* returnType);
     
     // Debug and analysis integration
     void attachSemanticAnalyzer(std::shared_ptr<SemanticAnalyzer> analyzer);
@@ -172,31 +189,31 @@ private:
     std::vector<ParseError> errors;
     
     // Helper methods for complex parsing
-    std::shared_ptr<ExprAST> parseComplexAssignment(std::shared_ptr<ExprAST> target);
-    std::shared_ptr<ExprAST> parseMethodChain(std::shared_ptr<ExprAST> object);
-    std::shared_ptr<ExprAST> parseGenericCall(const std::string& functionName);
+    ExprAST* parseComplexAssignment(ExprAST* target);
+    ExprAST* parseMethodChain(ExprAST* object);
+    ExprAST* parseGenericCall(const std::string& functionName);
     
     // Type system integration
-    std::shared_ptr<TypeInfo> inferExpressionType(std::shared_ptr<ExprAST> expr);
+    const TypeInfo* inferExpressionType(ExprAST* expr);
     bool isValidTypeConversion(const TypeInfo& from, const TypeInfo& to);
     
     // Advanced parsing features
-    std::shared_ptr<ExprAST> parseAsyncExpression();
-    std::shared_ptr<ExprAST> parseAwaitExpression();
-    std::shared_ptr<ExprAST> parseUnsafeExpression();
-    std::shared_ptr<ExprAST> parseBoxExpression();
-    std::shared_ptr<ExprAST> parseRefExpression();
-    std::shared_ptr<ExprAST> parseDerefExpression();
+    ExprAST* parseAsyncExpression();
+    ExprAST* parseAwaitExpression();
+    ExprAST* parseUnsafeExpression();
+    ExprAST* parseBoxExpression();
+    ExprAST* parseRefExpression();
+    ExprAST* parseDerefExpression();
     
     // Context tracking
-    void enterFunction(std::shared_ptr<TypeInfo> returnType);
+    void enterFunction(const TypeInfo* returnType);
     void exitFunction();
     void enterLoop();
     void exitLoop();
     void enterGeneric();
     void exitGeneric();
     
-    std::shared_ptr<TypeInfo> currentFunctionReturnType;
+    const TypeInfo* currentFunctionReturnType;
     std::vector<bool> loopStack;
-    std::vector<std::shared_ptr<TypeInfo>> genericStack;
+    std::vector<const TypeInfo*> genericStack;
 }; 
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "Repl.h"
+#include "ErrorHandler.h"
+#include "KeywordTable.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SourceBuffer.h"
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+// Whether `text` opens with a keyword that starts a top-level declaration
+bool startsDeclaration(const std::string& text) {
+    const KeywordEntry* keyword = lookupKeyword(std::string_view(text).substr(0, text.find_first_of(" \t\r\n")));
+    if (!keyword) return false;
+    switch (keyword->type) {
+        case TokenType::TOK_FUNC:
+        case TokenType::TOK_STRUCT:
+        case TokenType::TOK_IMPORT:
+        case TokenType::TOK_USE:
+        case TokenType::TOK_PUB:
+        case TokenType::TOK_PUBLIC:
+        case TokenType::TOK_EXTERN:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// How many brackets `line` leaves open; input continues while any are
+int openBrackets(const std::string& line) {
+    int depth = 0;
+    bool inString = false;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (inString) {
+            if (c == '\\') i++;
+            else if (c == '"') inString = false;
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '/' && i + 1 < line.size() && line[i + 1] == '/') {
+            break;
+        } else if (c == '{' || c == '(' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ')' || c == ']') {
+            depth--;
+        }
+    }
+    return depth;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+void printHelp() {
+    std::cout << "  func ... { }    define a function (struct and import work too)\n";
+    std::cout << "  <expression>    evaluate and print it; end with ';' to discard the value\n";
+    std::cout << "  <statements>    run them once (their variables do not persist)\n";
+    std::cout << "  :help           show this\n";
+    std::cout << "  :quit           leave (so does end of input)\n";
+}
+
+} // namespace
+
+Repl::Repl(const CodeGenerator::BuildOptions& options, const std::string& directory)
+    : session(options, false) {
+    QuietConsole quiet(true);
+    codegen.setBuildOptions(options);
+    codegen.setJITMode(true);
+    codegen.beginModule((std::filesystem::path(directory) / "repl.fls").string());
+}
+
+void Repl::run(std::istream& in, bool interactive) {
+    if (interactive) {
+        std::cout << "FLAST REPL v1.0 - :help for help, :quit to leave" << std::endl;
+    }
+
+    std::string pending;
+    int depth = 0;
+    std::string line;
+    while (true) {
+        if (interactive) {
+            std::cout << (pending.empty() ? "flast> " : "  ...> ") << std::flush;
+        }
+        if (!std::getline(in, line)) break;
+
+        if (pending.empty()) {
+            std::string command = trim(line);
+            if (command == ":quit" || command == ":q" || command == ":exit") {
+                return;
+            } else if (command == ":help") {
+                printHelp();
+                continue;
+            } else if (!command.empty() && command[0] == ':') {
+                std::cout << "Unknown command " << command << " (:help lists them)" << std::endl;
+                continue;
+            }
+        }
+
+        pending += line + "\n";
+        depth += openBrackets(line);
+        if (depth > 0) continue;
+
+        evaluate(pending);
+        pending.clear();
+        depth = 0;
+    }
+    if (!trim(pending).empty()) {
+        evaluate(pending);
+    }
+}
+
+bool Repl::evaluate(const std::string& input) {
+    bool ok = false;
+    try {
+        ok = lower(input);
+    } catch (const std::exception& e) {
+        codegen.discardUnit();
+        if (!g_errorHandler.hasCompilationErrors()) {
+            std::cerr << "error: " << e.what() << std::endl;
+        }
+    }
+    if (g_errorHandler.hasCompilationErrors() || g_errorHandler.hasCompilationWarnings()) {
+        g_errorHandler.printAllIssues();
+        g_errorHandler.clearAll();
+    }
+    declarations.reset();
+    return ok;
+}
+
+bool Repl::lower(const std::string& input) {
+    std::string text = trim(input);
+    if (text.empty()) return true;
+
+    if (startsDeclaration(text)) {
+        auto source = SourceBuffer::fromString(text, "<repl>");
+        Lexer lexer(*source);
+        Parser parser(lexer.tokenize(), declarations, "<repl>");
+        std::vector<std::string> names;
+        {
+            QuietConsole quiet(true);
+            while (DeclAST* decl = parser.parseNextDeclaration()) {
+                if (auto* funcDecl = llvm::dyn_cast<FunctionDeclAST>(decl)) {
+                    std::string name = funcDecl->name.str();
+                    if (definitions.count(name)) {
+                        throw std::runtime_error(name + " is already defined in this session");
+                    }
+                    names.push_back(name);
+                }
+                codegen.generateDeclaration(decl);
+            }
+        }
+        if (g_errorHandler.hasCompilationErrors()) {
+            codegen.discardUnit();
+            return false;
+        }
+
+        for (auto& module : codegen.takeImportedModules()) {
+            session.addModule(std::move(module));
+        }
+        session.addModule(codegen.takeUnit());
+        session.compile(names);  // pay for the definition when it is entered
+        definitions.insert(names.begin(), names.end());
+        return true;
+    }
+
+    // Everything else becomes the body of a function that runs once. A
+    // trailing ';' or '}' marks statements; otherwise the single expression
+    // is printed unless it calls something that returns nothing.
+    bool showValue = text.back() != ';' && text.back() != '}';
+    std::string name = "__flast_repl_" + std::to_string(units++);
+    auto source = SourceBuffer::fromString("func " + name + "() {\n" + text + (showValue ? ";" : "") + "\n}\n", "<repl>");
+    Lexer lexer(*source);
+    Parser parser(lexer.tokenize(), declarations, "<repl>");
+    auto* unit = llvm::dyn_cast_or_null<FunctionDeclAST>(parser.parseDeclaration());
+    if (!unit || g_errorHandler.hasCompilationErrors()) {
+        return false;
+    }
+
+    if (showValue && unit->body && unit->body->statements.size() == 1) {
+        if (auto* stmt = llvm::dyn_cast<ExprStmtAST>(unit->body->statements[0])) {
+            static const Identifier println("println");
+            static const Identifier print("print");
+            auto* call = llvm::dyn_cast<CallExprAST>(stmt->expression);
+            bool returnsNothing = call && (call->callee == println || call->callee == print ||
+                                           codegen.isVoidFunction(call->callee));
+            if (!returnsNothing) {
+                std::vector<ExprAST*> args = {stmt->expression};
+                stmt->expression = declarations.create<CallExprAST>(println, declarations.list(args));
+            }
+        }
+    }
+
+    {
+        QuietConsole quiet(true);
+        codegen.generateDeclaration(unit);
+    }
+    for (auto& module : codegen.takeImportedModules()) {
+        session.addModule(std::move(module));
+    }
+    session.runOnce(codegen.takeUnit(), name);
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "ASTContext.h"
+#include "CodeGen.h"
+#include "JIT.h"
+#include <istream>
+#include <string>
+#include <unordered_set>
+
+// `flast repl`: one JIT session for the whole conversation.
+//
+// Each input is lowered on its own into a small module (a unit) and added
+// to the session. Declarations (func, struct, import) stay defined, and
+// later units call them through declarations resolved by the JIT's symbol
+// table, so nothing already compiled is lowered again. Anything else is
+// the body of a throwaway function that runs once; a lone expression
+// without a trailing ';' has its value printed.
+class Repl {
+public:
+    // `directory` plays the part of the project root: imports resolve
+    // against it and its .build/cache holds their interfaces
+    Repl(const CodeGenerator::BuildOptions& options, const std::string& directory);
+
+    // Reads inputs until end of input or :quit, prompting when `interactive`
+    void run(std::istream& in, bool interactive);
+
+    // One complete input. Errors are printed; returns false after one.
+    bool evaluate(const std::string& input);
+
+    size_t definitionCount() const { return definitions.size(); }
+
+private:
+    bool lower(const std::string& input);
+
+    JITSession session;
+    CodeGenerator codegen;
+    ASTContext declarations;  // the current unit's AST, reset after each one
+    std::unordered_set<std::string> definitions;
+    size_t units = 0;
+};
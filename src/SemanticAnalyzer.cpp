@@ -1,2 +1,10 @@
 #include "SemanticAnalyzer.h"
-#include "ErrorHandler.h" 
\ No newline at end of file
+
+SemanticAnalyzer::SemanticAnalyzer(const std::string& file)
+    : currentFile(file), sourceFile(g_sourceManager.findFile(file)),
+      hasReturnStatement(false), loopDepth(0) {}
+
+std::string SemanticAnalyzer::getCodeSnippet(int line) const {
+    if (sourceFile == 0) return "";
+    return std::string(g_sourceManager.getLineText(sourceFile, line));
+}
@@ -9,6 +9,7 @@
 #include <sstream>
 #include <iomanip>
 #include "ErrorHandler.h"
+#include "SourceManager.h"
 
 // Enhanced error types for better diagnostics
 // (enum class ErrorLevel dan ErrorCode dihapus, gunakan dari ErrorHandler.h)
@@ -69,8 +70,8 @@ struct DiagnosticMessage {
 
 // Symbol table for scope management
 struct Symbol {
-    std::string name;
-    std::shared_ptr<TypeInfo> type;
+    Identifier name;
+    const TypeInfo* type;
     bool isMutable;
     bool isInitialized;
     int declarationLine;
@@ -78,7 +79,7 @@ struct Symbol {
     
     Symbol() = default;
     
-    Symbol(const std::string& name, std::shared_ptr<TypeInfo> type, bool isMutable = false,
+    Symbol(Identifier name, const TypeInfo* type, bool isMutable = false,
            bool isInitialized = true, int line = 0, int column = 0)
         : name(name), type(type), isMutable(isMutable), isInitialized(isInitialized),
           declarationLine(line), declarationColumn(column) {}
@@ -86,7 +87,7 @@ struct Symbol {
 
 class SymbolTable {
 private:
-    std::vector<std::unordered_map<std::string, Symbol>> scopes;
+    std::vector<std::unordered_map<Identifier, Symbol>> scopes;
     
 public:
     void pushScope() {
@@ -111,7 +112,7 @@ public:
         return true;
     }
     
-    Symbol* lookup(const std::string& name) {
+    Symbol* lookup(Identifier name) {
         for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
             auto found = it->find(name);
             if (found != it->end()) {
@@ -121,7 +122,7 @@ public:
         return nullptr;
     }
     
-    Symbol* lookupCurrentScope(const std::string& name) {
+    Symbol* lookupCurrentScope(Identifier name) {
         if (scopes.empty()) return nullptr;
         
         auto& currentScope = scopes.back();
@@ -129,7 +130,7 @@ public:
         return found != currentScope.end() ? &found->second : nullptr;
     }
     
-    bool updateSymbol(const std::string& name, const Symbol& newSymbol) {
+    bool updateSymbol(Identifier name, const Symbol& newSymbol) {
         Symbol* existing = lookup(name);
         if (existing) {
             *existing = newSymbol;
@@ -144,34 +145,34 @@ public:
 // Type registry for user-defined types
 class TypeRegistry {
 private:
-    std::unordered_map<std::string, std::shared_ptr<StructDeclAST>> structs;
-    std::unordered_map<std::string, std::shared_ptr<EnumDeclAST>> enums;
-    std::unordered_map<std::string, std::shared_ptr<TraitDeclAST>> traits;
+    std::unordered_map<std::string, StructDeclAST*> structs;
+    std::unordered_map<std::string, EnumDeclAST*> enums;
+    std::unordered_map<std::string, TraitDeclAST*> traits;
     
 public:
-    void registerStruct(const std::string& name, std::shared_ptr<StructDeclAST> structDecl) {
+    void registerStruct(const std::string& name, StructDeclAST* structDecl) {
         structs[name] = structDecl;
     }
     
-    void registerEnum(const std::string& name, std::shared_ptr<EnumDeclAST> enumDecl) {
+    void registerEnum(const std::string& name, EnumDeclAST* enumDecl) {
         enums[name] = enumDecl;
     }
     
-    void registerTrait(const std::string& name, std::shared_ptr<TraitDeclAST> traitDecl) {
+    void registerTrait(const std::string& name, TraitDeclAST* traitDecl) {
         traits[name] = traitDecl;
     }
     
-    std::shared_ptr<StructDeclAST> getStruct(const std::string& name) {
+    StructDeclAST* getStruct(const std::string& name) {
         auto it = structs.find(name);
         return it != structs.end() ? it->second : nullptr;
     }
     
-    std::shared_ptr<EnumDeclAST> getEnum(const std::string& name) {
+    EnumDeclAST* getEnum(const std::string& name) {
         auto it = enums.find(name);
         return it != enums.end() ? it->second : nullptr;
     }
     
-    std::shared_ptr<TraitDeclAST> getTrait(const std::string& name) {
+    TraitDeclAST* getTrait(const std::string& name) {
         auto it = traits.find(name);
         return it != traits.end() ? it->second : nullptr;
     }
@@ -191,10 +192,10 @@ private:
     SymbolTable symbolTable;
     TypeRegistry typeRegistry;
     std::string currentFile;
-    std::vector<std::string> sourceLines;
+    FileId sourceFile;  // snippets are read through g_sourceManager
     
     // Function analysis state
-    std::shared_ptr<TypeInfo> currentFunctionReturnType;
+    const TypeInfo* currentFunctionReturnType;
     bool hasReturnStatement;
     int loopDepth;
     
@@ -214,7 +215,7 @@ private:
     
     // Type checking
     bool isAssignable(const TypeInfo& from, const TypeInfo& to);
-    std::shared_ptr<TypeInfo> inferType(std::shared_ptr<ExprAST> expr);
+    const TypeInfo* inferType(ExprAST* expr);
     bool checkTypeCompatibility(const TypeInfo& expected, const TypeInfo& actual);
     
     // Built-in type checking
@@ -224,50 +225,50 @@ private:
     bool isBuiltinType(FlastType type);
     
     // Pattern matching validation
-    bool isExhaustiveMatch(std::shared_ptr<MatchStmtAST> matchStmt);
-    bool isReachablePattern(std::shared_ptr<ExprAST> pattern,
-                           const std::vector<std::shared_ptr<ExprAST>>& previousPatterns);
+    bool isExhaustiveMatch(MatchStmtAST* matchStmt);
+    bool isReachablePattern(ExprAST* pattern,
+                           const ASTList<ExprAST*>& previousPatterns);
     
     // Control flow analysis
-    void analyzeControlFlow(std::shared_ptr<StmtAST> stmt);
-    bool hasUnreachableCode(const std::vector<std::shared_ptr<StmtAST>>& statements);
+    void analyzeControlFlow(StmtAST* stmt);
+    bool hasUnreachableCode(const ASTList<StmtAST*>& statements);
     
     // Ownership and borrowing analysis (Rust-like)
-    void analyzeOwnership(std::shared_ptr<ExprAST> expr);
+    void analyzeOwnership(ExprAST* expr);
     bool isMovedValue(const std::string& varName);
     void markAsMoved(const std::string& varName);
     
 public:
-    SemanticAnalyzer(const std::string& file, const std::vector<std::string>& sourceLines);
+    explicit SemanticAnalyzer(const std::string& file);
     
     // Main analysis entry points
-    bool analyze(std::shared_ptr<ProgramAST> program);
-    bool analyzeDeclaration(std::shared_ptr<DeclAST> decl);
-    bool analyzeStatement(std::shared_ptr<StmtAST> stmt);
-    bool analyzeExpression(std::shared_ptr<ExprAST> expr);
+    bool analyze(ProgramAST* program);
+    bool analyzeDeclaration(DeclAST* decl);
+    bool analyzeStatement(StmtAST* stmt);
+    bool analyzeExpression(ExprAST* expr);
     
     // Specific analyzers
-    bool analyzeFunctionDecl(std::shared_ptr<FunctionDeclAST> funcDecl);
-    bool analyzeStructDecl(std::shared_ptr<StructDeclAST> structDecl);
-    bool analyzeEnumDecl(std::shared_ptr<EnumDeclAST> enumDecl);
-    bool analyzeTraitDecl(std::shared_ptr<TraitDeclAST> traitDecl);
-    bool analyzeImplDecl(std::shared_ptr<ImplDeclAST> implDecl);
+    bool analyzeFunctionDecl(FunctionDeclAST* funcDecl);
+    bool analyzeStructDecl(StructDeclAST* structDecl);
+    bool analyzeEnumDecl(EnumDeclAST* enumDecl);
+    bool analyzeTraitDecl(TraitDeclAST* traitDecl);
+    bool analyzeImplDecl(ImplDeclAST* implDecl);
 
-    bool analyzeImportDecl(std::shared_ptr<ImportDeclAST> importDecl);
-    
-    bool analyzeVarDecl(std::shared_ptr<VarDeclStmtAST> varDecl);
-    bool analyzeAssignment(std::shared_ptr<AssignStmtAST> assignment);
-    bool analyzeIfStmt(std::shared_ptr<IfStmtAST> ifStmt);
-    bool analyzeWhileStmt(std::shared_ptr<WhileStmtAST> whileStmt);
-    bool analyzeForStmt(std::shared_ptr<ForStmtAST> forStmt);
-    bool analyzeMatchStmt(std::shared_ptr<MatchStmtAST> matchStmt);
-    bool analyzeReturnStmt(std::shared_ptr<ReturnStmtAST> returnStmt);
-    
-    bool analyzeBinaryExpr(std::shared_ptr<BinaryExprAST> binaryExpr);
-    bool analyzeUnaryExpr(std::shared_ptr<UnaryExprAST> unaryExpr);
-    bool analyzeCallExpr(std::shared_ptr<CallExprAST> callExpr);
-    bool analyzeMemberAccess(std::shared_ptr<MemberAccessExprAST> memberAccess);
-    bool analyzeVariableExpr(std::shared_ptr<VariableExprAST> varExpr);
+    bool analyzeImportDecl(ImportDeclAST* importDecl);
+    
+    bool analyzeVarDecl(VarDeclStmtAST* varDecl);
+    bool analyzeAssignment(AssignStmtAST* assignment);
+    bool analyzeIfStmt(IfStmtAST* ifStmt);
+    bool analyzeWhileStmt(WhileStmtAST* whileStmt);
+    bool analyzeForStmt(ForStmtAST* forStmt);
+    bool analyzeMatchStmt(MatchStmtAST* matchStmt);
+    bool analyzeReturnStmt(ReturnStmtAST* returnStmt);
+    
+    bool analyzeBinaryExpr(BinaryExprAST* binaryExpr);
+    bool analyzeUnaryExpr(UnaryExprAST* unaryExpr);
+    bool analyzeCallExpr(CallExprAST* callExpr);
+    bool analyzeMemberAccess(MemberAccessExprAST* memberAccess);
+    bool analyzeVariableExpr(VariableExprAST* varExpr);
     
     // Utility methods
     bool hasErrors() const;
@@ -0,0 +1,78 @@
+#include "SourceBuffer.h"
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+SourceBuffer::~SourceBuffer() {
+#ifndef _WIN32
+    if (mappedSize != 0) {
+        munmap(const_cast<char*>(data), mappedSize);
+    }
+#endif
+}
+
+std::unique_ptr<SourceBuffer> SourceBuffer::fromFile(const std::string& path) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Could not stat file: " + path);
+    }
+    
+    std::unique_ptr<SourceBuffer> buffer(new SourceBuffer());
+    buffer->name = path;
+    
+    // mmap rejects zero-length mappings; an empty file is just an empty buffer
+    if (st.st_size > 0) {
+        void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Could not map file: " + path);
+        }
+        madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+        buffer->data = static_cast<const char*>(mapping);
+        buffer->size = st.st_size;
+        buffer->mappedSize = st.st_size;
+    } else {
+        buffer->data = buffer->ownedText.data();
+    }
+    
+    close(fd);
+    return buffer;
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return fromString(contents.str(), path);
+#endif
+}
+
+std::unique_ptr<SourceBuffer> SourceBuffer::fromString(std::string text, const std::string& name) {
+    std::unique_ptr<SourceBuffer> buffer(new SourceBuffer());
+    buffer->name = name;
+    buffer->ownedText = std::move(text);
+    buffer->data = buffer->ownedText.data();
+    buffer->size = buffer->ownedText.size();
+    return buffer;
+}
+
+std::string_view SourceBuffer::storeDecoded(std::string text) {
+    std::lock_guard<std::mutex> lock(decodedMutex);
+    decodedText.push_back(std::move(text));
+    return decodedText.back();
+}
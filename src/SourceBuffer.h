@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+// Immutable contents of one source file. Files are memory-mapped once; tokens
+// and diagnostics refer back into the mapping instead of copying the text.
+class SourceBuffer {
+private:
+    std::string name;
+    const char* data = nullptr;
+    size_t size = 0;
+    size_t mappedSize = 0;        // non-zero when `data` is an mmap region
+    std::string ownedText;        // backing storage for in-memory buffers
+    
+    // Text that does not appear verbatim in the file (string literals with
+    // escape sequences, numbers with '_' separators). A deque keeps element
+    // addresses stable so views handed out stay valid.
+    std::deque<std::string> decodedText;
+    std::mutex decodedMutex;
+    
+    SourceBuffer() = default;
+    
+public:
+    ~SourceBuffer();
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+    
+    static std::unique_ptr<SourceBuffer> fromFile(const std::string& path);
+    static std::unique_ptr<SourceBuffer> fromString(std::string text, const std::string& name = "<memory>");
+    
+    std::string_view text() const { return std::string_view(data, size); }
+    const std::string& getName() const { return name; }
+    size_t getSize() const { return size; }
+    bool isMapped() const { return mappedSize != 0; }
+    
+    // Keeps `text` alive for the lifetime of the buffer and returns a view of it.
+    std::string_view storeDecoded(std::string text);
+};
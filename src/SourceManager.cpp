@@ -0,0 +1,99 @@
+#include "SourceManager.h"
+#include "LexerScan.h"
+#include <algorithm>
+#include <stdexcept>
+
+SourceManager g_sourceManager;
+
+FileId SourceManager::loadFile(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = idsByName.find(path);
+        if (it != idsByName.end()) {
+            return it->second;
+        }
+    }
+    return addBuffer(SourceBuffer::fromFile(path));
+}
+
+FileId SourceManager::addBuffer(std::unique_ptr<SourceBuffer> buffer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    files.emplace_back();
+    FileEntry& file = files.back();
+    file.buffer = std::move(buffer);
+
+    FileId id = static_cast<FileId>(files.size());
+    idsByName[file.buffer->getName()] = id;
+    idsByBuffer[file.buffer.get()] = id;
+    return id;
+}
+
+SourceManager::FileEntry& SourceManager::entry(FileId id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (id == 0 || id > files.size()) {
+        throw std::runtime_error("Invalid source file id: " + std::to_string(id));
+    }
+    return files[id - 1];
+}
+
+const SourceManager::FileEntry& SourceManager::lineTable(FileId id) {
+    FileEntry& file = entry(id);
+    std::call_once(file.lineTableBuilt, [&file]() {
+        std::string_view text = file.buffer->text();
+        const char* begin = text.data();
+        const char* end = begin + text.size();
+        const auto& scan = LexerScan::active();
+
+        file.lineStarts.reserve(scan.countNewlines(begin, end) + 1);
+        file.lineStarts.push_back(0);
+        for (const char* p = scan.findByte(begin, end, '\n'); p < end; p = scan.findByte(p + 1, end, '\n')) {
+            file.lineStarts.push_back(static_cast<uint32_t>(p + 1 - begin));
+        }
+    });
+    return file;
+}
+
+SourceBuffer& SourceManager::getBuffer(FileId id) {
+    return *entry(id).buffer;
+}
+
+FileId SourceManager::findFile(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = idsByName.find(name);
+    return it != idsByName.end() ? it->second : 0;
+}
+
+FileId SourceManager::findFile(const SourceBuffer& buffer) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = idsByBuffer.find(&buffer);
+    return it != idsByBuffer.end() ? it->second : 0;
+}
+
+SourceLocation SourceManager::getLocation(FileId id, size_t offset) {
+    const FileEntry& file = lineTable(id);
+    offset = std::min(offset, file.buffer->getSize());
+
+    // Last line starting at or before `offset`
+    auto it = std::upper_bound(file.lineStarts.begin(), file.lineStarts.end(), offset) - 1;
+    SourceLocation location;
+    location.line = static_cast<int>(it - file.lineStarts.begin()) + 1;
+    location.column = static_cast<int>(offset - *it) + 1;
+    return location;
+}
+
+std::string_view SourceManager::getLineText(FileId id, int line) {
+    const FileEntry& file = lineTable(id);
+    if (line < 1 || static_cast<size_t>(line) > file.lineStarts.size()) {
+        return std::string_view();
+    }
+
+    std::string_view text = file.buffer->text();
+    size_t start = file.lineStarts[line - 1];
+    size_t end = static_cast<size_t>(line) < file.lineStarts.size() ? file.lineStarts[line] - 1 : text.size();
+    if (end > start && text[end - 1] == '\r') end--;
+    return text.substr(start, end - start);
+}
+
+size_t SourceManager::getLineCount(FileId id) {
+    return lineTable(id).lineStarts.size();
+}
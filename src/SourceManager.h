@@ -0,0 +1,58 @@
+#pragma once
+#include "SourceBuffer.h"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Index of a file registered with the SourceManager. 0 means "no file".
+using FileId = uint32_t;
+
+struct SourceLocation {
+    int line = 0;    // 1-based
+    int column = 0;  // 1-based
+};
+
+// Owns every source buffer the compiler reads and answers location queries
+// for diagnostics. Each file gets a table of line-start offsets (built on the
+// first query with the vectorised newline scan), so offset -> line/column is
+// a binary search and fetching a line's text is two array reads.
+class SourceManager {
+private:
+    struct FileEntry {
+        std::unique_ptr<SourceBuffer> buffer;
+        std::vector<uint32_t> lineStarts;     // offset of the first byte of each line
+        std::once_flag lineTableBuilt;
+    };
+
+    // Entries never move once added; ids index into this deque (offset by one)
+    std::deque<FileEntry> files;
+    std::unordered_map<std::string, FileId> idsByName;
+    std::unordered_map<const SourceBuffer*, FileId> idsByBuffer;
+    mutable std::mutex mutex;
+
+    FileEntry& entry(FileId id);
+    const FileEntry& lineTable(FileId id);
+
+public:
+    // Map `path` and take ownership of it. Loading the same path twice
+    // returns the existing id.
+    FileId loadFile(const std::string& path);
+    FileId addBuffer(std::unique_ptr<SourceBuffer> buffer);
+
+    SourceBuffer& getBuffer(FileId id);
+    // 0 when no buffer with that name (or address) was registered
+    FileId findFile(const std::string& name) const;
+    FileId findFile(const SourceBuffer& buffer) const;
+
+    SourceLocation getLocation(FileId id, size_t offset);
+    // Text of a 1-based line without its terminator; empty when out of range
+    std::string_view getLineText(FileId id, int line);
+    size_t getLineCount(FileId id);
+};
+
+// Global source manager instance
+extern SourceManager g_sourceManager;
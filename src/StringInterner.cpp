@@ -0,0 +1,68 @@
+#include "StringInterner.h"
+#include <iostream>
+#include <stdexcept>
+
+StringInterner& StringInterner::global() {
+    static StringInterner interner;
+    return interner;
+}
+
+SymbolId StringInterner::intern(std::string_view text) {
+    if (text.empty()) return 0;
+    
+    totalIdentifiers.fetch_add(1, std::memory_order_relaxed);
+    totalBytes.fetch_add(text.size(), std::memory_order_relaxed);
+    
+    size_t hash = std::hash<std::string_view>()(text);
+    unsigned shardIndex = static_cast<unsigned>(hash >> 7) & (kShardCount - 1);
+    Shard& shard = shards[shardIndex];
+    
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.ids.find(text);
+    if (it != shard.ids.end()) {
+        return it->second;
+    }
+    
+    // Ids are (index + 1) << kShardBits | shard, which keeps 0 free for the
+    // empty name and lets lookup() find the shard without hashing
+    size_t index = shard.names.size();
+    if (index + 1 >= (size_t(1) << (32 - kShardBits))) {
+        throw std::runtime_error("Identifier table overflow");
+    }
+    shard.names.emplace_back(text);
+    shard.bytes += text.size();
+    SymbolId id = static_cast<SymbolId>(((index + 1) << kShardBits) | shardIndex);
+    shard.ids.emplace(shard.names.back(), id);
+    return id;
+}
+
+const std::string& StringInterner::lookup(SymbolId id) const {
+    static const std::string empty;
+    if (id == 0) return empty;
+    
+    const Shard& shard = shards[id & (kShardCount - 1)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.names[(id >> kShardBits) - 1];
+}
+
+StringInterner::Stats StringInterner::getStats() const {
+    Stats stats;
+    for (const Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.uniqueIdentifiers += shard.names.size();
+        stats.uniqueBytes += shard.bytes;
+    }
+    stats.totalIdentifiers = totalIdentifiers.load(std::memory_order_relaxed);
+    stats.totalBytes = totalBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void StringInterner::printStats(std::ostream& out) const {
+    Stats stats = getStats();
+    out << "📊 Identifiers: " << stats.uniqueIdentifiers << " unique / "
+        << stats.totalIdentifiers << " total, " << stats.bytesSaved() << " bytes saved by interning\n";
+}
+
+std::ostream& operator<<(std::ostream& out, Identifier name) {
+    return out << name.str();
+}
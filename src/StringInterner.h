@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Compiler-wide identifier ids. Id 0 is the empty name.
+using SymbolId = uint32_t;
+
+// Global string interner. Every distinct identifier is stored once and named
+// by a 32-bit SymbolId, so later phases compare and hash names as integers.
+// Interning is thread-safe (the table is sharded by hash so parallel lexer
+// chunks rarely contend); stored strings never move.
+class StringInterner {
+public:
+    struct Stats {
+        size_t uniqueIdentifiers = 0;
+        size_t totalIdentifiers = 0;   // intern() calls, i.e. identifier occurrences
+        size_t uniqueBytes = 0;
+        size_t totalBytes = 0;
+        
+        // Bytes that would have been copied into per-occurrence std::strings
+        size_t bytesSaved() const { return totalBytes - uniqueBytes; }
+    };
+    
+    static StringInterner& global();
+    
+    SymbolId intern(std::string_view text);
+    const std::string& lookup(SymbolId id) const;
+    
+    Stats getStats() const;
+    void printStats(std::ostream& out) const;
+    
+private:
+    static constexpr unsigned kShardBits = 4;
+    static constexpr unsigned kShardCount = 1u << kShardBits;
+    
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string_view, SymbolId> ids;  // views into `names`
+        std::deque<std::string> names;
+        size_t bytes = 0;
+    };
+    
+    Shard shards[kShardCount];
+    std::atomic<size_t> totalIdentifiers{0};
+    std::atomic<size_t> totalBytes{0};
+    
+    StringInterner() = default;
+};
+
+// An interned name. Constructing one from text interns it; comparing and
+// hashing only touch the id.
+class Identifier {
+private:
+    SymbolId id = 0;
+    
+public:
+    Identifier() = default;
+    explicit Identifier(SymbolId id) : id(id) {}
+    Identifier(std::string_view text) : id(StringInterner::global().intern(text)) {}
+    Identifier(const std::string& text) : Identifier(std::string_view(text)) {}
+    Identifier(const char* text) : Identifier(std::string_view(text)) {}
+    
+    SymbolId getId() const { return id; }
+    const std::string& str() const { return StringInterner::global().lookup(id); }
+    bool empty() const { return id == 0; }
+    
+    bool operator==(Identifier other) const { return id == other.id; }
+    bool operator!=(Identifier other) const { return id != other.id; }
+};
+
+inline std::string operator+(const std::string& lhs, Identifier rhs) { return lhs + rhs.str(); }
+inline std::string operator+(const char* lhs, Identifier rhs) { return lhs + rhs.str(); }
+inline std::string operator+(Identifier lhs, const std::string& rhs) { return lhs.str() + rhs; }
+inline std::string operator+(Identifier lhs, const char* rhs) { return lhs.str() + rhs; }
+std::ostream& operator<<(std::ostream& out, Identifier name);
+
+namespace std {
+template<> struct hash<Identifier> {
+    size_t operator()(Identifier name) const noexcept { return name.getId(); }
+};
+}
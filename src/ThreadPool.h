@@ -0,0 +1,48 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads fed from a FIFO queue. Tasks are
+// submitted as callables and their results (or exceptions) come back
+// through std::future. The destructor drains the queue and joins.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queueMutex;
+    std::condition_variable available;
+    bool stopping = false;
+    
+    void workerLoop();
+    
+public:
+    // `threads` == 0 uses the number of hardware threads
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+    
+    static unsigned hardwareThreads();
+    
+    template<typename F>
+    auto submit(F&& task) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            tasks.emplace([packaged] { (*packaged)(); });
+        }
+        available.notify_one();
+        return result;
+    }
+};
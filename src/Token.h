@@ -1,6 +1,8 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <iostream>
+#include "StringInterner.h"
 
 enum class TokenType {
     // Literals
@@ -322,14 +324,25 @@ enum class TokenType {
     TOK_NONE = -573,
 };
 
+// Tokens do not own their text: `value` points into the SourceBuffer the
+// token was lexed from (or into literal storage owned by that buffer), so the
+// buffer must outlive every token. Tokens are move-only to keep the token
+// vector from being deep-copied between the lexer and the parser.
+// Identifiers are interned by the lexer; `symbol` is 0 for other tokens.
 struct Token {
     TokenType type;
-    std::string value;
+    std::string_view value;
     int line;
     int column;
+    SymbolId symbol = 0;
     
-    Token(TokenType t, const std::string& v, int l = 0, int c = 0) 
+    Token(TokenType t, std::string_view v, int l = 0, int c = 0) 
         : type(t), value(v), line(l), column(c) {}
+    
+    Token(Token&&) = default;
+    Token& operator=(Token&&) = default;
+    Token(const Token&) = delete;
+    Token& operator=(const Token&) = delete;
 };
 
 // Operator precedence for proper mathematical evaluation
@@ -385,8 +398,9 @@ inline Precedence getOperatorPrecedence(TokenType type) {
         case TokenType::TOK_AND:
             return Precedence::LOGICAL_AND;
             
-        // Bitwise OR
+        // Bitwise OR (`|` lexes as PIPE)
         case TokenType::TOK_BIT_OR:
+        case TokenType::TOK_PIPE:
             return Precedence::BITWISE_OR;
             
         // Bitwise XOR
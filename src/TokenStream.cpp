@@ -0,0 +1,32 @@
+#include "TokenStream.h"
+#include "Lexer.h"
+#include <stdexcept>
+#include <string>
+
+TokenStream::TokenStream(Lexer& lexer) : lexer(lexer) {
+    static_assert((kCapacity & (kCapacity - 1)) == 0, "ring capacity must be a power of two");
+    ring.reserve(kCapacity);
+    for (size_t i = 0; i < kCapacity; i++) {
+        ring.emplace_back(TokenType::TOK_EOF, "");
+    }
+}
+
+Token& TokenStream::slowAt(size_t index) {
+    // Callers only ever look back a few tokens (previous(), the for-in
+    // lookahead), so a token that has been overwritten is a parser bug
+    if (index < lexed) {
+        throw std::logic_error("Token " + std::to_string(index) + " has left the lookahead window");
+    }
+
+    while (!finished && lexed <= index) {
+        Token token = lexer.nextToken();
+        if (token.type == TokenType::TOK_LINE_COMMENT || token.type == TokenType::TOK_BLOCK_COMMENT) {
+            continue;
+        }
+        finished = token.type == TokenType::TOK_EOF;
+        ring[lexed & (kCapacity - 1)] = std::move(token);
+        lexed++;
+    }
+    // Past the end every index reads as the EOF token
+    return ring[(index < lexed ? index : lexed - 1) & (kCapacity - 1)];
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "Token.h"
+#include <cstddef>
+#include <vector>
+
+class Lexer;
+
+// Bounded lookahead between the Lexer and the Parser. Tokens are lexed on
+// demand into a ring of kCapacity slots, so only a window of the token
+// stream is ever resident no matter how large the file is. The parser keeps
+// addressing tokens by absolute index; an index that has already left the
+// window (more than kCapacity tokens behind the lexer) is a logic error.
+class TokenStream {
+public:
+    static constexpr size_t kCapacity = 256;  // power of two
+
+private:
+    Lexer& lexer;
+    std::vector<Token> ring;
+    size_t lexed = 0;       // tokens produced so far; the next one gets this index
+    bool finished = false;  // the EOF token has been produced
+
+    Token& slowAt(size_t index);
+
+public:
+    explicit TokenStream(Lexer& lexer);
+    TokenStream(const TokenStream&) = delete;
+    TokenStream& operator=(const TokenStream&) = delete;
+
+    // Token at absolute position `index`; past the end this is the EOF token
+    Token& at(size_t index) {
+        if (index < lexed && index + kCapacity >= lexed) return ring[index & (kCapacity - 1)];
+        return slowAt(index);
+    }
+
+    size_t getLexedCount() const { return lexed; }
+};
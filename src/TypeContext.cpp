@@ -0,0 +1,71 @@
+#include "TypeContext.h"
+#include <llvm/ADT/Hashing.h>
+#include <ostream>
+
+TypeContext g_typeContext;
+
+TypeContext::TypeContext() {
+    // The shared builtin annotations are the canonical plain types
+    for (int i = 0; i <= static_cast<int>(FlastType::UNKNOWN); i++) {
+        insert(TypeInfo::builtin(static_cast<FlastType>(i)));
+    }
+    insert(TypeInfo::optionalUnknown());
+}
+
+size_t TypeContext::hash(const TypeInfo& shape) {
+    unsigned modifiers = shape.isPointer | shape.isReference << 1 | shape.isConst << 2 | shape.isOptional << 3;
+    return llvm::hash_combine(static_cast<int>(shape.type), shape.className.getId(), modifiers,
+                              llvm::hash_combine_range(shape.parameters.begin(), shape.parameters.end()));
+}
+
+bool TypeContext::sameShape(const TypeInfo& a, const TypeInfo& b) {
+    if (a.type != b.type || a.className != b.className ||
+        a.isPointer != b.isPointer || a.isReference != b.isReference ||
+        a.isConst != b.isConst || a.isOptional != b.isOptional ||
+        a.parameters.size() != b.parameters.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.parameters.size(); i++) {
+        if (a.parameters[i] != b.parameters[i]) return false;
+    }
+    return true;
+}
+
+void TypeContext::insert(const TypeInfo* canonical) {
+    buckets[hash(*canonical)].push_back(canonical);
+    stats.uniqueTypes++;
+}
+
+const TypeInfo* TypeContext::get(const TypeInfo& shape) {
+    size_t key = hash(shape);
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.lookups++;
+
+    auto& bucket = buckets[key];
+    for (const TypeInfo* candidate : bucket) {
+        if (sameShape(*candidate, shape)) return candidate;
+    }
+
+    TypeInfo* canonical = storage.create<TypeInfo>(shape);
+    canonical->parameters = storage.list(llvm::ArrayRef<const TypeInfo*>(shape.parameters.begin(), shape.parameters.size()));
+    bucket.push_back(canonical);
+    stats.uniqueTypes++;
+    return canonical;
+}
+
+const TypeInfo* TypeContext::get(FlastType type, llvm::ArrayRef<const TypeInfo*> parameters,
+                                 Identifier className) {
+    TypeInfo shape(type, className);
+    shape.parameters = ASTList<const TypeInfo*>(const_cast<const TypeInfo**>(parameters.data()), parameters.size());
+    return get(shape);
+}
+
+TypeContext::Stats TypeContext::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void TypeContext::printStats(std::ostream& out) const {
+    Stats current = getStats();
+    out << "📊 Types: " << current.uniqueTypes << " unique / " << current.lookups << " lookups\n";
+}
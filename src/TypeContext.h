@@ -0,0 +1,49 @@
+#pragma once
+#include "AST.h"
+#include "ASTContext.h"
+#include <llvm/ADT/ArrayRef.h>
+#include <iosfwd>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Uniques TypeInfo annotations: structurally equal types (kind, class name,
+// parameter list and modifiers) map to one immutable instance, so type
+// equality is a pointer comparison and per-type facts (such as the lowered
+// LLVM type) can be memoised by address. Parameters are canonical before
+// their owner is, so parameterised types are compared shallowly.
+class TypeContext {
+public:
+    struct Stats {
+        size_t lookups = 0;
+        size_t uniqueTypes = 0;
+    };
+
+private:
+    ASTContext storage;  // canonical instances and their parameter lists
+    std::unordered_map<size_t, std::vector<const TypeInfo*>> buckets;
+    Stats stats;
+    mutable std::mutex mutex;
+
+    static size_t hash(const TypeInfo& shape);
+    static bool sameShape(const TypeInfo& a, const TypeInfo& b);
+    void insert(const TypeInfo* canonical);
+
+public:
+    TypeContext();
+    TypeContext(const TypeContext&) = delete;
+    TypeContext& operator=(const TypeContext&) = delete;
+
+    // Canonical instance equal to `shape`; its parameters must already be
+    // canonical. The shape itself is copied, never retained.
+    const TypeInfo* get(const TypeInfo& shape);
+    const TypeInfo* get(FlastType type) { return TypeInfo::builtin(type); }
+    const TypeInfo* get(FlastType type, llvm::ArrayRef<const TypeInfo*> parameters,
+                        Identifier className = Identifier());
+
+    Stats getStats() const;
+    void printStats(std::ostream& out) const;
+};
+
+// Global type context instance
+extern TypeContext g_typeContext;
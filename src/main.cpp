@@ -3,46 +3,104 @@
 #include <string>
 #include <stdexcept>
 #include <filesystem>
+#include <optional>
+#include <algorithm>
 #include "Lexer.h"
 #include "Parser.h"
 #include "CodeGen.h"
+#include "JIT.h"
+#include "Interpreter.h"
+#include "Repl.h"
 #include "ErrorHandler.h"
+#include "SourceManager.h"
+#include "TypeContext.h"
+#include "TokenStream.h"
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
 
-std::string readFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file) {
-        throw std::runtime_error("Could not open file: " + filename);
+// Peak resident set size in KB, or 0 where the platform cannot tell
+static long peakResidentKB() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return usage.ru_maxrss;
     }
-    
-    std::string content;
-    std::string line;
-    while (std::getline(file, line)) {
-        content += line + "\n";
+#endif
+    return 0;
+}
+
+// More lexer threads than this only adds scheduling overhead
+static constexpr unsigned kMaxLexThreads = 256;
+
+// Parses a --lex-threads count: decimal digits only, clamped to
+// kMaxLexThreads. False for anything else (signs, junk, empty).
+static bool parseLexThreads(const std::string& text, unsigned& threads) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    // Long digit strings are simply large; no need to convert them
+    threads = text.size() > 9 ? kMaxLexThreads
+                              : std::min<unsigned>(static_cast<unsigned>(std::stoul(text)), kMaxLexThreads);
+    return true;
+}
+
+// Whether input comes from someone typing, so the REPL should prompt
+static bool stdinIsTerminal() {
+#ifndef _WIN32
+    return isatty(STDIN_FILENO);
+#else
+    return true;
+#endif
+}
+
+static void printMemoryReport(const CodeGenerator::StreamStats* stream) {
+    std::cout << "📊 Peak memory: " << peakResidentKB() / 1024 << " MB resident" << std::endl;
+    if (stream) {
+        std::cout << "📊 Streamed " << stream->declarations << " declarations through a "
+                  << TokenStream::kCapacity << "-token window; largest declaration "
+                  << stream->largestDeclarationBytes / 1024 << " KB of AST, "
+                  << stream->objectChunks << " object chunks flushed" << std::endl;
     }
-    
-    return content;
 }
 
 void printUsage(const char* programName) {
     std::cout << "FLAST PROFESSIONAL COMPILER v1.0\n";
-    std::cout << "Usage: " << programName << " <input.fls> [options]\n\n";
+    std::cout << "Usage: " << programName << " <input.fls> [options]\n";
+    std::cout << "       " << programName << " run <input.fls> [options] [-- args...]\n";
+    std::cout << "       " << programName << " repl [options]\n\n";
     std::cout << "Options:\n";
     std::cout << "  -o <output>    Set output name (default: auto-generated)\n";
-    std::cout << "  --release      Release build (optimized, no debug)\n";
+    std::cout << "  --release      Release build (-O2, no debug)\n";
     std::cout << "  --debug        Debug build (default, with debug info)\n";
-    std::cout << "  --clean        Clean cache only (build dir auto-cleaned)\n";
+    std::cout << "  --opt-level <n>  Optimisation level: 0 (default), 1, 2, 3, s or z\n";
+    std::cout << "  --clean        Clean the cache before building\n";
     std::cout << "  --ir           Print LLVM IR instead of compiling\n";
     std::cout << "  --tokens       Print tokens instead of compiling\n";
     std::cout << "  --ast          Print AST instead of compiling\n";
     std::cout << "  --warnings-as-errors  Treat warnings as errors\n";
     std::cout << "  --no-colors    Disable colored output\n";
     std::cout << "  --verbose      Show detailed error information\n";
+    std::cout << "  --lex-threads <n>  Lex large files on n threads (0 = all cores)\n";
+    std::cout << "  --stats        Print identifier interning, AST arena and type statistics\n";
+    std::cout << "  --stream       Lex, parse and lower one declaration at a time (bounded memory)\n";
+    std::cout << "  --max-memory   Report peak memory use after compiling\n";
+    std::cout << "  --explain-cache  Say why each imported module's cache entries hit or missed\n";
+    std::cout << "  --target-cpu=<cpu>  CPU to generate code for (default: generic; native = this host)\n";
+    std::cout << "  --target-features=<list>  e.g. +avx2,-fma, or native (default: the CPU's own)\n";
+    std::cout << "  --lto=<mode>   thin or full: optimise across the program and its modules at link time\n";
+    std::cout << "  --profile-generate[=<file>]  Instrument the program to write a profile (default: <name>.profraw)\n";
+    std::cout << "  --profile-use=<file>  Optimise with a .profraw or .profdata profile from a build at the same --opt-level\n";
+    std::cout << "  --lazy         With run: compile each function when it is first called\n";
+    std::cout << "  --interp       With run: interpret bytecode instead of compiling (fastest start; --ir shows it)\n";
+    std::cout << "  --linker=<name>  auto (default), lld, ld, ld.gold, mold, cc, or a path\n";
     std::cout << "  -v, --version  Show version information\n";
     std::cout << "  -h, --help     Show this help message\n\n";
     std::cout << "Output Structure:\n";
     std::cout << "  .build/bin/    - Executable files (platform-specific extension)\n";
     std::cout << "  .build/cache/  - Temporary files (.o, etc)\n";
-    std::cout << "  Note: .build/ directory is automatically cleaned on each compilation\n\n";
+    std::cout << "  Note: .build/cache/ is reused across builds; --clean empties it\n\n";
     std::cout << "Platform Support:\n";
     std::cout << "  Linux:   No extension (e.g., 'program')\n";
     std::cout << "  Windows: .exe extension (e.g., 'program.exe')\n";
@@ -51,10 +109,17 @@ void printUsage(const char* programName) {
     std::cout << "  " << programName << " program.fls                 # Debug build\n";
     std::cout << "  " << programName << " program.fls --release       # Optimized build\n";
     std::cout << "  " << programName << " program.fls -o myapp        # Custom name\n";
+    std::cout << "  " << programName << " run program.fls -- a b      # Compile in memory and run\n";
+    std::cout << "  " << programName << " repl                        # Interactive session\n";
 }
 
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
+    // `flast run <file>` compiles in memory with the JIT and runs main;
+    // `flast repl` keeps one JIT session open and takes no file
+    bool runMode = argc >= 2 && std::string(argv[1]) == "run";
+    bool replMode = argc >= 2 && std::string(argv[1]) == "repl";
+    int inputIndex = runMode ? 2 : 1;
+    if (argc <= inputIndex && !replMode) {
         printUsage(argv[0]);
         return 1;
     }
@@ -66,17 +131,17 @@ int main(int argc, char* argv[]) {
             return 0;
         } else if (arg == "-v" || arg == "--version") {
             std::cout << "===== FLASTC =====" << std::endl;
-            std::cout << "Version: 1.0.0" << std::endl;
+            std::cout << "Version: " << FLAST_VERSION << std::endl;
             std::cout << "Author: flastdev team" << std::endl;
             std::cout << "Contact: officialbangezz@gmail.com" << std::endl;
             return 0;
         }
     }
     
-    std::string inputFile = argv[1];
+    std::string inputFile = replMode ? "" : argv[inputIndex];
     std::string outputName = "";
     bool debugMode = true;
-    bool optimized = false;
+    CodeGenerator::OptLevel optLevel = CodeGenerator::OptLevel::O0;
     bool cleanCache = false;
     bool printIR = false;
     bool printTokens = false;
@@ -84,9 +149,23 @@ int main(int argc, char* argv[]) {
     bool warningsAsErrors = false;
     bool noColors = false;
     bool verbose = false;
+    unsigned lexThreads = 1;
+    bool printStats = false;
+    bool streamMode = false;
+    bool maxMemory = false;
+    bool explainCache = false;
+    std::string linker = "auto";
+    std::string targetCPU = runMode || replMode ? "native" : "generic";
+    std::string targetFeatures;
+    CodeGenerator::LTOMode lto = CodeGenerator::LTOMode::None;
+    std::string profileGenerate;
+    std::string profileUse;
+    bool lazyJIT = false;
+    bool interpret = false;
+    std::vector<std::string> programArgs;
     
     // Parse command line arguments
-    for (int i = 2; i < argc; ++i) {
+    for (int i = inputIndex + 1; i < argc; ++i) {
         std::string arg = argv[i];
         
         if (arg == "-h" || arg == "--help") {
@@ -96,10 +175,15 @@ int main(int argc, char* argv[]) {
             outputName = argv[++i];
         } else if (arg == "--release") {
             debugMode = false;
-            optimized = true;
+            optLevel = CodeGenerator::OptLevel::O2;
         } else if (arg == "--debug") {
             debugMode = true;
-            optimized = false;
+            optLevel = CodeGenerator::OptLevel::O0;
+        } else if (arg == "--opt-level" && i + 1 < argc) {
+            if (!CodeGenerator::parseOptLevel(argv[++i], optLevel)) {
+                std::cerr << "Invalid --opt-level '" << argv[i] << "' (expected 0, 1, 2, 3, s or z)" << std::endl;
+                return 1;
+            }
         } else if (arg == "--clean") {
             cleanCache = true;
         } else if (arg == "--ir") {
@@ -114,26 +198,130 @@ int main(int argc, char* argv[]) {
             noColors = true;
         } else if (arg == "--verbose") {
             verbose = true;
+        } else if (arg == "--lex-threads" && i + 1 < argc) {
+            if (!parseLexThreads(argv[++i], lexThreads)) {
+                std::cerr << "Invalid --lex-threads '" << argv[i] << "' (expected a thread count, 0 for all cores)"
+                          << std::endl;
+                return 1;
+            }
+        } else if (arg == "--stats") {
+            printStats = true;
+        } else if (arg == "--stream") {
+            streamMode = true;
+        } else if (arg == "--max-memory") {
+            maxMemory = true;
+        } else if (arg == "--explain-cache") {
+            explainCache = true;
+        } else if (arg.rfind("--linker=", 0) == 0) {
+            linker = arg.substr(9);
+        } else if (arg.rfind("--target-cpu=", 0) == 0) {
+            targetCPU = arg.substr(13);
+        } else if (arg.rfind("--target-features=", 0) == 0) {
+            targetFeatures = arg.substr(18);
+        } else if (arg == "--lto=thin" || arg == "--lto") {
+            lto = CodeGenerator::LTOMode::Thin;
+        } else if (arg == "--lto=full") {
+            lto = CodeGenerator::LTOMode::Full;
+        } else if (arg == "--lto=none") {
+            lto = CodeGenerator::LTOMode::None;
+        } else if (arg == "--profile-generate") {
+            profileGenerate = std::filesystem::path(inputFile).stem().string() + ".profraw";
+        } else if (arg.rfind("--profile-generate=", 0) == 0) {
+            profileGenerate = arg.substr(19);
+        } else if (arg.rfind("--profile-use=", 0) == 0) {
+            profileUse = arg.substr(14);
+        } else if (arg == "--lazy") {
+            lazyJIT = true;
+        } else if (arg == "--interp") {
+            interpret = true;
+        } else if (arg == "--" && runMode) {
+            programArgs.assign(argv + i + 1, argv + argc);
+            break;
         } else {
             debugMode = false;
-            optimized = true;
+            optLevel = CodeGenerator::OptLevel::O2;
         }
     }
     
     try {
         g_errorHandler.setWarningsAsErrors(warningsAsErrors);
         g_errorHandler.setUseColors(!noColors);
+        CodeGenerator::BuildOptions buildOptions;
+        buildOptions.debugMode = debugMode;
+        buildOptions.optLevel = optLevel;
+        CodeGenerator::resolveTarget(targetCPU, targetFeatures);
+        buildOptions.targetCPU = targetCPU;
+        buildOptions.targetFeatures = targetFeatures;
+        buildOptions.lto = lto;
+        if (!profileGenerate.empty() && !profileUse.empty()) {
+            throw std::runtime_error("--profile-generate and --profile-use cannot be combined");
+        }
+        buildOptions.profileGenerate = profileGenerate;
+        if (!profileGenerate.empty()) {
+            CodeGenerator::findProfileRuntime();  // before compiling, not at link time
+        }
+        if (!profileUse.empty()) {
+            // Merged into the cache of the project being built (the REPL's is
+            // the working directory)
+            std::filesystem::path projectRoot = replMode ? std::filesystem::current_path()
+                                                         : std::filesystem::absolute(inputFile).parent_path();
+            buildOptions.profileDigest = CodeGenerator::loadProfile(profileUse, projectRoot);
+            buildOptions.profileUse = profileUse;
+        }
+        if ((runMode || replMode) && (lto != CodeGenerator::LTOMode::None || !profileGenerate.empty())) {
+            throw std::runtime_error("--lto and --profile-generate build executables; run and repl compile in memory");
+        }
+        
+        if (replMode) {
+            Repl repl(buildOptions, std::filesystem::current_path().string());
+            repl.run(std::cin, stdinIsTerminal());
+            return 0;
+        }
         
         if (!std::filesystem::exists(inputFile)) {
             throw std::runtime_error("Input file does not exist: " + inputFile);
         }
         
-        // Read source file
-        std::string source = readFile(inputFile);
+        // Map source file (tokens borrow from this buffer)
+        SourceBuffer& source = g_sourceManager.getBuffer(g_sourceManager.loadFile(inputFile));
+        
+        // Dumps need the whole token stream or tree, so they never stream
+        if (streamMode && !runMode && !printTokens && !printAST && !printIR) {
+            Lexer lexer(source);
+            TokenStream stream(lexer);
+            ASTContext declarationContext;
+            Parser parser(stream, declarationContext, inputFile);
+            
+            CodeGenerator codegen;
+            codegen.setBuildOptions(buildOptions);
+            codegen.setExplainCache(explainCache);
+            codegen.setCleanCache(cleanCache);
+            codegen.setLinker(linker);
+            codegen.generateCode(parser, declarationContext, inputFile);
+            
+            if (printStats) {
+                StringInterner::global().printStats(std::cout);
+                g_typeContext.printStats(std::cout);
+            }
+            
+            std::string exePath = codegen.writeExecutable(inputFile, debugMode, optLevel != CodeGenerator::OptLevel::O0);
+            std::cout << "\n=== BUILD COMPLETE ===" << std::endl;
+            std::cout << "✓ Executable: " << exePath << std::endl;
+            std::cout << "✓ Build type: " << (debugMode ? "Debug" : "Release") << " (streamed)" << std::endl;
+            if (maxMemory) {
+                printMemoryReport(&codegen.getStreamStats());
+            }
+            std::cout << "\nRun with: " << exePath << std::endl;
+            return 0;
+        }
         
         // Lexical analysis
         Lexer lexer(source);
-        auto tokens = lexer.tokenize();
+        auto tokens = lexThreads == 1 ? lexer.tokenize() : lexer.tokenizeParallel(lexThreads);
+        
+        if (printStats) {
+            StringInterner::global().printStats(std::cout);
+        }
         
         if (printTokens) {
             std::cout << "=== TOKENS ===" << std::endl;
@@ -145,25 +333,85 @@ int main(int argc, char* argv[]) {
         }
         
         // Syntax analysis
-        Parser parser(std::move(tokens));
-        auto ast = parser.parseProgram();
+        ASTContext astContext;
+        Parser parser(std::move(tokens), astContext, inputFile);
+        // An incremental build only parses the bodies it has to lower again
+        parser.setLazyFunctionBodies(!printAST && !printIR && !runMode);
+        ProgramAST* ast = parser.parseProgram();
+        
+        if (printStats) {
+            astContext.printStats(std::cout);
+            g_typeContext.printStats(std::cout);
+        }
         
         if (printAST) {
             std::cout << "=== AST ===" << std::endl;
             std::cout << ast->toString() << std::endl;
+            // The declarations the parser recovered from are not shown
+            if (g_errorHandler.hasCompilationErrors()) {
+                g_errorHandler.printAllIssues();
+                return 1;
+            }
             return 0;
         }
         
+        // Programs outside what the bytecode covers still run, on the JIT
+        if (runMode && interpret) {
+            std::optional<bytecode::Program> program;
+            try {
+                program = bytecode::compile(ast);
+            } catch (const std::exception& e) {
+                std::cerr << "note: " << e.what() << "; running with the JIT instead" << std::endl;
+            }
+            if (program && printIR) {
+                std::cout << "=== BYTECODE ===" << std::endl;
+                std::cout << program->disassemble();
+                return 0;
+            }
+            if (program) {
+                try {
+                    return Interpreter(*program).runMain();
+                } catch (const std::runtime_error& e) {
+                    std::cerr << "\nRuntime error: " << e.what() << std::endl;
+                    return 1;
+                }
+            }
+        }
+        
+        if (runMode && !printIR) {
+            JITSession session(buildOptions, lazyJIT);
+            {
+                QuietConsole quiet(!verbose);
+                CodeGenerator codegen;
+                codegen.setBuildOptions(buildOptions);
+                codegen.setExplainCache(explainCache);
+                codegen.setCleanCache(cleanCache);
+                codegen.setJITMode(true);
+                codegen.generateCode(ast, inputFile);
+                for (auto& module : codegen.takeImportedModules()) {
+                    session.addModule(std::move(module));
+                }
+                session.addModule(codegen.takeModule());
+            }
+            return session.runMain(inputFile, programArgs);
+        }
+        
         // Code generation
         CodeGenerator codegen;
+        codegen.setBuildOptions(buildOptions);
+        codegen.setExplainCache(explainCache);
         
         // Clean cache if requested
-        if (cleanCache) {
-            codegen.cleanupCache();
-        }
+        codegen.setCleanCache(cleanCache);
+        codegen.setLinker(linker);
         
-        // Generate code with source file path
-        codegen.generateCode(ast.get(), inputFile);
+        // Generate code with source file path; an executable reuses every
+        // cached partition whose functions are unchanged
+        if (printIR) {
+            codegen.generateCode(ast, inputFile);
+        } else {
+            codegen.generateCodeIncremental(ast, inputFile);
+        }
         
         if (printIR) {
             std::cout << "=== LLVM IR ===" << std::endl;
@@ -172,7 +420,7 @@ int main(int argc, char* argv[]) {
         }
         
         // Compile to executable with professional output
-        std::string exePath = codegen.writeExecutable(inputFile, debugMode, optimized);
+        std::string exePath = codegen.writeExecutable(inputFile, debugMode, optLevel != CodeGenerator::OptLevel::O0);
         
         // Show final result
         std::cout << "\n=== BUILD COMPLETE ===" << std::endl;
@@ -182,8 +430,15 @@ int main(int argc, char* argv[]) {
         if (debugMode) {
             std::cout << "✓ Debug symbols: Enabled" << std::endl;
         }
-        if (optimized) {
-            std::cout << "✓ Optimization: Enabled" << std::endl;
+        if (optLevel != CodeGenerator::OptLevel::O0) {
+            std::cout << "✓ Optimization: -" << CodeGenerator::optLevelName(optLevel) << std::endl;
+        }
+        if (!profileGenerate.empty()) {
+            std::cout << "✓ Profiling: writes " << profileGenerate << " on exit; rebuild with --profile-use="
+                      << profileGenerate << std::endl;
+        }
+        if (maxMemory) {
+            printMemoryReport(nullptr);
         }
         
         std::cout << "\nRun with: " << exePath << std::endl;
@@ -0,0 +1,122 @@
+/* Profile runtime linked into programs built with --profile-generate.
+ *
+ * LLVM's IR instrumentation keeps one data record, one run of counters and
+ * one compressed name per function in the __llvm_prf_data, __llvm_prf_cnts
+ * and __llvm_prf_names sections. At exit this writes them out unchanged
+ * behind a raw-profile header, which is all compiler-rt's runtime does for
+ * a program without value profiling. Both sides take the layout from
+ * InstrProfData.inc, so the file is whatever this LLVM's readers expect.
+ *
+ * The output goes to $LLVM_PROFILE_FILE when set, else the name the
+ * compiler stored in __llvm_profile_filename, else default.profraw.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef intptr_t IntPtrT;
+
+/* Once on its own for the shared macros, then once per X-macro table */
+#include "llvm/ProfileData/InstrProfData.inc"
+
+enum ValueKind {
+#define VALUE_PROF_KIND(Enumerator, Value, Descr) Enumerator = Value,
+#include "llvm/ProfileData/InstrProfData.inc"
+};
+
+typedef struct __attribute__((aligned(INSTR_PROF_DATA_ALIGNMENT))) ProfileData {
+#define INSTR_PROF_DATA(Type, LLVMType, Name, Initializer) Type Name;
+#include "llvm/ProfileData/InstrProfData.inc"
+} ProfileData;
+
+typedef struct ProfileHeader {
+#define INSTR_PROF_RAW_HEADER(Type, Name, Initializer) Type Name;
+#include "llvm/ProfileData/InstrProfData.inc"
+} ProfileHeader;
+
+#define HIDDEN_WEAK __attribute__((visibility("hidden"), weak))
+
+/* Section bounds, provided by the linker */
+extern const ProfileData INSTR_PROF_SECT_START(INSTR_PROF_DATA_COMMON) HIDDEN_WEAK;
+extern const ProfileData INSTR_PROF_SECT_STOP(INSTR_PROF_DATA_COMMON) HIDDEN_WEAK;
+extern uint64_t INSTR_PROF_SECT_START(INSTR_PROF_CNTS_COMMON) HIDDEN_WEAK;
+extern uint64_t INSTR_PROF_SECT_STOP(INSTR_PROF_CNTS_COMMON) HIDDEN_WEAK;
+extern const char INSTR_PROF_SECT_START(INSTR_PROF_NAME_COMMON) HIDDEN_WEAK;
+extern const char INSTR_PROF_SECT_STOP(INSTR_PROF_NAME_COMMON) HIDDEN_WEAK;
+
+/* Emitted by the instrumentation: format variant and default file name */
+extern uint64_t INSTR_PROF_RAW_VERSION_VAR HIDDEN_WEAK;
+extern const char INSTR_PROF_PROFILE_NAME_VAR[] HIDDEN_WEAK;
+
+/* Instrumented code may refer to the runtime through this */
+int INSTR_PROF_PROFILE_RUNTIME_VAR;
+
+/* Intentionally no-ops. Value profiling (indirect call targets, memop
+ * sizes) is not collected: the raw profile is written with no value data,
+ * which readers accept, and --profile-use only needs block counts. The
+ * instrumentation still emits calls to these for indirect calls, so they
+ * must exist for the program to link. */
+void INSTR_PROF_VALUE_PROF_FUNC(uint64_t TargetValue, void *Data, uint32_t CounterIndex) {
+    (void)TargetValue;
+    (void)Data;
+    (void)CounterIndex;
+}
+
+void INSTR_PROF_VALUE_PROF_MEMOP_FUNC(uint64_t TargetValue, void *Data, uint32_t CounterIndex) {
+    (void)TargetValue;
+    (void)Data;
+    (void)CounterIndex;
+}
+
+static const char zeroes[8];
+
+static uint64_t paddingTo8(uint64_t size) {
+    return (8 - size % 8) % 8;
+}
+
+static void writeProfile(void) {
+    const ProfileData* dataBegin = &INSTR_PROF_SECT_START(INSTR_PROF_DATA_COMMON);
+    const ProfileData* dataEnd = &INSTR_PROF_SECT_STOP(INSTR_PROF_DATA_COMMON);
+    const uint64_t* countersBegin = &INSTR_PROF_SECT_START(INSTR_PROF_CNTS_COMMON);
+    const uint64_t* countersEnd = &INSTR_PROF_SECT_STOP(INSTR_PROF_CNTS_COMMON);
+    const char* namesBegin = &INSTR_PROF_SECT_START(INSTR_PROF_NAME_COMMON);
+    const char* namesEnd = &INSTR_PROF_SECT_STOP(INSTR_PROF_NAME_COMMON);
+    if (!dataBegin || dataBegin == dataEnd) return;
+
+    const char* path = getenv("LLVM_PROFILE_FILE");
+    if (!path || !*path) {
+        path = INSTR_PROF_PROFILE_NAME_VAR && *INSTR_PROF_PROFILE_NAME_VAR
+            ? INSTR_PROF_PROFILE_NAME_VAR : "default.profraw";
+    }
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "profile: cannot write %s\n", path);
+        return;
+    }
+
+    uint64_t namesSize = (uint64_t)(namesEnd - namesBegin);
+    ProfileHeader header = {0};
+    header.Magic = INSTR_PROF_RAW_MAGIC_64;
+    header.Version = &INSTR_PROF_RAW_VERSION_VAR ? INSTR_PROF_RAW_VERSION_VAR : INSTR_PROF_RAW_VERSION;
+    header.BinaryIdsSize = 0;
+    header.DataSize = (uint64_t)(dataEnd - dataBegin);
+    header.PaddingBytesBeforeCounters = 0;  /* records are 8-aligned */
+    header.CountersSize = (uint64_t)(countersEnd - countersBegin);
+    header.PaddingBytesAfterCounters = 0;
+    header.NamesSize = namesSize;
+    header.CountersDelta = (uint64_t)((uintptr_t)countersBegin - (uintptr_t)dataBegin);
+    header.NamesDelta = (uint64_t)(uintptr_t)namesBegin;
+    header.ValueKindLast = IPVK_Last;
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(dataBegin, sizeof(ProfileData), (size_t)header.DataSize, file);
+    fwrite(countersBegin, sizeof(uint64_t), (size_t)header.CountersSize, file);
+    fwrite(namesBegin, 1, (size_t)namesSize, file);
+    fwrite(zeroes, 1, (size_t)paddingTo8(namesSize), file);
+    fclose(file);
+}
+
+__attribute__((constructor)) static void registerProfileWriter(void) {
+    atexit(writeProfile);
+}
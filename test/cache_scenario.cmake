@@ -0,0 +1,81 @@
+# Incremental-build scenarios: builds a scratch copy of cache/, edits or
+# damages it, and builds again. Run by ctest as
+#   cmake -DFLAST=<flast> -DSOURCE=<this directory> -DWORK=<scratch directory>
+#         -DSCENARIO=<name> -P cache_scenario.cmake
+
+file(REMOVE_RECURSE ${WORK})
+file(COPY ${SOURCE}/cache/ DESTINATION ${WORK})
+set(modules ${WORK}/.build/cache/modules)
+
+# Builds app.fls; the output must match `expected` and the exit status must
+# be zero, or nonzero when `status` is FAIL
+function(build expected)
+    execute_process(COMMAND ${FLAST} app.fls WORKING_DIRECTORY ${WORK}
+                    OUTPUT_VARIABLE out ERROR_VARIABLE out RESULT_VARIABLE status)
+    if(ARGV1 STREQUAL "FAIL")
+        if(status EQUAL 0)
+            message(FATAL_ERROR "flast should have failed:\n${out}")
+        endif()
+    elseif(NOT status EQUAL 0)
+        message(FATAL_ERROR "flast failed (${status}):\n${out}")
+    endif()
+    if(NOT out MATCHES "${expected}")
+        message(FATAL_ERROR "flast output does not match '${expected}':\n${out}")
+    endif()
+endfunction()
+
+function(run expected)
+    execute_process(COMMAND ${WORK}/.build/bin/app OUTPUT_VARIABLE out RESULT_VARIABLE status)
+    if(NOT status EQUAL 0 OR NOT out STREQUAL "${expected}")
+        message(FATAL_ERROR "app exited ${status} printing '${out}', expected '${expected}'")
+    endif()
+endfunction()
+
+function(edit file pattern replacement)
+    file(READ ${WORK}/${file} text)
+    string(REGEX REPLACE "${pattern}" "${replacement}" text "${text}")
+    file(WRITE ${WORK}/${file} "${text}")
+endfunction()
+
+if(NOT SCENARIO STREQUAL "syntax_error")
+    build("Reused 0 of 1 partitions")
+    run("42\n")
+endif()
+
+if(SCENARIO STREQUAL "corrupt_entries")
+    # Cut-short objects and ASTs are misses, rebuilt rather than linked or loaded
+    file(GLOB damaged ${modules}/util_*.o ${modules}/util_*.ast ${WORK}/.build/cache/functions/app/*.o)
+    list(LENGTH damaged count)
+    if(NOT count EQUAL 3)
+        message(FATAL_ERROR "expected a module object, a module AST and a partition, found: ${damaged}")
+    endif()
+    foreach(entry ${damaged})
+        file(WRITE ${entry} "truncated")
+    endforeach()
+    build("Generating module object.*Loading module: \"util.fls\".*Reused 0 of 1 partitions")
+    run("42\n")
+elseif(SCENARIO STREQUAL "private_body_edit")
+    edit(util.fls "return 2;" "return 3;")
+    build("Generating module object.*Reused 1 of 1 partitions")
+    run("63\n")
+elseif(SCENARIO STREQUAL "signature_edit")
+    edit(util.fls "twice\\(a: i32\\)" "twice(n: i32)")
+    edit(util.fls "return a \\*" "return n *")
+    build("Generating module object.*Reused 0 of 1 partitions")
+    run("42\n")
+elseif(SCENARIO STREQUAL "syntax_error")
+    # Fails every time, with nothing cached from the recovered AST
+    edit(util.fls "return 2;" "return 2 +;")
+    foreach(attempt 1 2)
+        build("Expected expression" FAIL)
+        file(GLOB cached ${modules}/util_*.ast ${modules}/util_*.flsi ${modules}/util_*.o)
+        if(NOT cached STREQUAL "")
+            message(FATAL_ERROR "a module with syntax errors was cached: ${cached}")
+        endif()
+    endforeach()
+    edit(util.fls "return 2 \\+;" "return 3;")
+    build("Reused 0 of 1 partitions")
+    run("63\n")
+else()
+    message(FATAL_ERROR "unknown scenario ${SCENARIO}")
+endif()